@@ -0,0 +1,256 @@
+extern "C" {
+#include "keepkey/board/common.h"
+#include "keepkey/board/keepkey_board.h"
+#include "keepkey/board/keepkey_flash.h"
+#include "keepkey/emulator/setup.h"
+#include "keepkey/firmware/fsm.h"
+#include "keepkey/firmware/storage.h"
+}
+
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    Function func;
+    int64_t arg0, arg1;
+};
+
+std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+std::string jsonEscape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;
+    double bytes_per_second;
+    std::map<std::string, double> counters;
+    std::string error;
+};
+
+/// Runs b with growing iteration counts until one run takes at least
+/// min_time seconds, and reports that run.
+Result run(const Benchmark &b, double min_time) {
+    Result r;
+    r.name = b.name;
+
+    uint64_t iterations = 1;
+    for (;;) {
+        State state(iterations, b.arg0, b.arg1);
+        b.func(state);
+
+        r.iterations = state.iterations();
+        r.ns_per_op = state.elapsedNs() / state.iterations();
+        r.bytes_per_second = state.bytes_per_iteration
+            ? state.bytes_per_iteration * 1e9 / r.ns_per_op : 0;
+        r.counters = state.counters;
+        r.error = state.errorMessage();
+
+        if (state.failed())
+            return r;
+
+        double elapsed = state.elapsedNs() / 1e9;
+        if (elapsed >= min_time || iterations >= 1000000000)
+            return r;
+
+        // Aim 40% past the target so that the next run is usually the last.
+        double scale = elapsed > 0 ? min_time * 1.4 / elapsed : 10;
+        uint64_t next = (uint64_t)std::ceil(iterations * std::min(scale, 10.0));
+        iterations = std::max(next, iterations + 1);
+    }
+}
+
+void writeJson(std::ostream &out, const std::vector<Result> &results,
+               double min_time) {
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"firmware_version\": \""
+        << VERSION_STR(MAJOR_VERSION) "." VERSION_STR(MINOR_VERSION) "."
+           VERSION_STR(PATCH_VERSION) << "\",\n"
+        << "    \"min_time_s\": " << min_time << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        out << (i ? ",\n" : "\n")
+            << "    {\n"
+            << "      \"name\": \"" << jsonEscape(r.name) << "\",\n";
+        if (!r.error.empty()) {
+            out << "      \"error\": \"" << jsonEscape(r.error) << "\"\n"
+                << "    }";
+            continue;
+        }
+        out << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"ns_per_op\": " << std::fixed << r.ns_per_op;
+        if (r.bytes_per_second)
+            out << ",\n      \"bytes_per_second\": " << r.bytes_per_second;
+        for (const auto &c : r.counters)
+            out << ",\n      \"" << jsonEscape(c.first) << "\": " << c.second;
+        out.unsetf(std::ios::floatfield);
+        out << "\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+void usage(const char *argv0) {
+    std::cerr << "Usage: " << argv0 << " [--filter=SUBSTRING] [--min-time=SECONDS]"
+                 " [--out=FILE] [--list]\n";
+}
+
+} // namespace
+
+State::State(uint64_t iterations, int64_t arg0, int64_t arg1)
+    : bytes_per_iteration(0), max_iterations(iterations), done(0), arg0(arg0),
+      arg1(arg1), running(false), elapsed_ns(0) {}
+
+bool State::keepRunning() {
+    if (done == 0 && !running) {
+        if (failed())
+            return false;
+        resumeTiming();
+    }
+
+    if (done++ < max_iterations && !failed())
+        return true;
+
+    if (running)
+        pauseTiming();
+    return false;
+}
+
+void State::pauseTiming() {
+    elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    running = false;
+}
+
+void State::resumeTiming() {
+    running = true;
+    start = Clock::now();
+}
+
+void State::skipWithError(const std::string &msg) {
+    if (error.empty())
+        error = msg;
+}
+
+Registration::Registration(const char *name, Function func, int64_t arg0, int64_t arg1) {
+    registry().push_back(Benchmark{ name, func, arg0, arg1 });
+}
+
+} // namespace bench
+
+// Usage: firmware-bench [--filter=SUBSTRING] [--min-time=SECONDS] [--out=FILE]
+//
+// Times the firmware hot paths on the host and writes the results as JSON,
+// to stdout unless --out is given. Progress goes to stderr.
+int main(int argc, char *argv[]) {
+    std::string filter, out_path;
+    double min_time = 0.5;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg.compare(0, 11, "--min-time=") == 0) {
+            min_time = atof(arg.c_str() + 11);
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out_path = arg.substr(6);
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            bench::usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (list) {
+        for (const auto &b : bench::registry())
+            std::cout << b.name << "\n";
+        return 0;
+    }
+
+    // Same bring-up as the emulator, minus the socket.
+    setup();
+    flash_collectHWEntropy(false);
+    kk_board_init();
+    drbg_init();
+    storage_init();
+    fsm_init();
+
+    std::vector<bench::Result> results;
+    bool ok = true;
+    for (const auto &b : bench::registry()) {
+        if (b.name.find(filter) == std::string::npos)
+            continue;
+
+        std::cerr << b.name << "... " << std::flush;
+        results.push_back(bench::run(b, min_time));
+
+        const bench::Result &r = results.back();
+        if (!r.error.empty()) {
+            std::cerr << "ERROR: " << r.error << "\n";
+            ok = false;
+        } else {
+            std::cerr << (uint64_t)r.ns_per_op << " ns/op (" << r.iterations
+                      << " iterations)\n";
+        }
+    }
+
+    if (out_path.empty()) {
+        bench::writeJson(std::cout, results, min_time);
+    } else {
+        std::ofstream out(out_path);
+        if (!out) {
+            std::cerr << "cannot open " << out_path << "\n";
+            return 1;
+        }
+        bench::writeJson(out, results, min_time);
+    }
+
+    return ok ? 0 : 2;
+}
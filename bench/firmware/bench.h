@@ -0,0 +1,79 @@
+#ifndef KEEPKEY_BENCH_H
+#define KEEPKEY_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace bench {
+
+/// Per-run state handed to a benchmark body.
+///
+/// The body does its setup, then loops on keepRunning(). Only the time
+/// spent inside the loop is reported, less any pauseTiming() sections.
+class State {
+public:
+    State(uint64_t iterations, int64_t arg0, int64_t arg1);
+
+    /// \returns true while there are iterations left to run.
+    bool keepRunning();
+
+    /// Exclude per-iteration setup from the measurement.
+    void pauseTiming();
+    void resumeTiming();
+
+    /// Payload handled per iteration, reported as bytes_per_second.
+    void setBytesPerIteration(uint64_t bytes) { bytes_per_iteration = bytes; }
+
+    /// Extra value reported alongside the timing, e.g. messages exchanged.
+    void setCounter(const std::string &name, double value) { counters[name] = value; }
+
+    /// Abandon the benchmark, e.g. when the firmware rejected the input.
+    void skipWithError(const std::string &msg);
+
+    int64_t arg(int i) const { return i == 0 ? arg0 : arg1; }
+
+    uint64_t iterations() const { return max_iterations; }
+    double elapsedNs() const { return elapsed_ns; }
+    bool failed() const { return !error.empty(); }
+    const std::string &errorMessage() const { return error; }
+
+    uint64_t bytes_per_iteration;
+    std::map<std::string, double> counters;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    uint64_t max_iterations;
+    uint64_t done;
+    int64_t arg0, arg1;
+    bool running;
+    Clock::time_point start;
+    double elapsed_ns;
+    std::string error;
+};
+
+typedef void (*Function)(State &state);
+
+/// Adds a benchmark to the suite. Use the BENCHMARK macros instead.
+struct Registration {
+    Registration(const char *name, Function func, int64_t arg0 = 0, int64_t arg1 = 0);
+};
+
+} // namespace bench
+
+#define BENCH_CONCAT_(A, B) A##B
+#define BENCH_CONCAT(A, B) BENCH_CONCAT_(A, B)
+
+/// Registers FUNC as a benchmark named after it.
+#define BENCHMARK(FUNC) \
+    static const bench::Registration BENCH_CONCAT(FUNC##_reg_, __LINE__)(#FUNC, FUNC)
+
+/// Registers FUNC as a benchmark named "FUNC/A/B", with A and B available
+/// through State::arg().
+#define BENCHMARK_ARGS(FUNC, A, B) \
+    static const bench::Registration BENCH_CONCAT(FUNC##_reg_, __LINE__)( \
+        #FUNC "/" #A "/" #B, FUNC, A, B)
+
+#endif
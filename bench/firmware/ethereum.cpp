@@ -0,0 +1,83 @@
+extern "C" {
+#include "keepkey/firmware/ethereum.h"
+#include "trezor/crypto/bip32.h"
+#include "trezor/crypto/curves.h"
+}
+
+#include "bench.h"
+#include "host.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// Signs a contract call carrying arg(0) bytes of data, streamed in the
+/// chunk size the firmware asks for.
+void ethereum_signing(bench::State &state) {
+    const uint32_t data_length = state.arg(0);
+
+    uint8_t seed[64];
+    memset(seed, 0x5a, sizeof(seed));
+    HDNode node;
+    hdnode_from_seed(seed, sizeof(seed), SECP256K1_NAME, &node);
+    hdnode_fill_public_key(&node);
+
+    static EthereumSignTx msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.has_nonce = true;
+    msg.nonce.size = 1;
+    msg.nonce.bytes[0] = 7;
+    msg.has_gas_price = true;
+    msg.gas_price.size = 5;
+    memcpy(msg.gas_price.bytes, "\x04\xa8\x17\xc8\x00", 5);
+    msg.has_gas_limit = true;
+    msg.gas_limit.size = 3;
+    memcpy(msg.gas_limit.bytes, "\x0f\x42\x40", 3);
+    msg.has_to = true;
+    msg.to.size = 20;
+    memset(msg.to.bytes, 0x3e, 20);
+    msg.has_chain_id = true;
+    msg.chain_id = 1;
+    msg.has_data_length = true;
+    msg.data_length = data_length;
+    msg.has_data_initial_chunk = true;
+    msg.data_initial_chunk.size =
+        std::min<uint32_t>(data_length, sizeof(msg.data_initial_chunk.bytes));
+    memset(msg.data_initial_chunk.bytes, 0x42, msg.data_initial_chunk.size);
+
+    static EthereumTxAck ack;
+    memset(&ack, 0, sizeof(ack));
+    ack.has_data_chunk = true;
+    memset(ack.data_chunk.bytes, 0x42, sizeof(ack.data_chunk.bytes));
+
+    uint64_t chunks = 0;
+    while (state.keepRunning()) {
+        host::reset();
+        ethereum_signing_init(&msg, &node, false);
+
+        chunks = 0;
+        while (host::last_msg_id == MessageType_MessageType_EthereumTxRequest &&
+               !host::ethereum_tx_request.has_signature_r) {
+            ack.data_chunk.size = std::min<uint32_t>(
+                host::ethereum_tx_request.data_length, sizeof(ack.data_chunk.bytes));
+            ethereum_signing_txack(&ack);
+            chunks++;
+        }
+
+        if (host::last_msg_id != MessageType_MessageType_EthereumTxRequest) {
+            ethereum_signing_abort();
+            state.skipWithError(std::string("signing failed: ") + host::failure.message);
+            break;
+        }
+    }
+
+    state.setBytesPerIteration(data_length);
+    state.setCounter("chunks", chunks);
+}
+
+} // namespace
+
+BENCHMARK_ARGS(ethereum_signing, 1024, 0);
+BENCHMARK_ARGS(ethereum_signing, 65536, 0);
+BENCHMARK_ARGS(ethereum_signing, 1048576, 0);
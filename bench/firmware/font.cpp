@@ -0,0 +1,103 @@
+extern "C" {
+#include "keepkey/board/draw.h"
+#include "keepkey/board/font.h"
+}
+
+#include "bench.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The body of layoutEthereumData: three 8-byte hex rows and a summary.
+const std::string Title = "CONFIRM DATA";
+const std::string Body = "a9059cbb000000000000000000000000\n"
+                         "5aeda56215b167893e80b4fe645ba6d5...     1024 bytes";
+
+/// The glyph lookups of one confirm screen, through the list of
+/// (code, image) pairs fonts used to be searched with. Each glyph is
+/// looked up three times: calc_str_line, calc_str_width (for centering)
+/// and draw_string.
+void font_lookup_linear(bench::State &state) {
+    const Font *title_font = get_title_font();
+    const Font *body_font = get_body_font();
+
+    struct Character { int code; const CharacterImage *image; };
+    std::vector<Character> title_chars, body_chars;
+    for (int c = 0; c < FONT_GLYPHS; ++c) {
+        if (title_font->glyphs[c])
+            title_chars.push_back(Character{ c, title_font->glyphs[c] });
+        if (body_font->glyphs[c])
+            body_chars.push_back(Character{ c, body_font->glyphs[c] });
+    }
+    auto linear = [](const std::vector<Character> &chars, char c) {
+        for (const Character &ch : chars)
+            if (ch.code == c)
+                return ch.image;
+        return (const CharacterImage *)nullptr;
+    };
+
+    uint32_t sum = 0;
+    while (state.keepRunning()) {
+        for (int pass = 0; pass < 3; ++pass) {
+            for (char c : Title)
+                sum += linear(title_chars, c)->width;
+            for (char c : Body)
+                if (const CharacterImage *img = linear(body_chars, c))
+                    sum += img->width;
+        }
+    }
+
+    state.setCounter("width", sum);
+}
+
+/// The same lookups through the direct-indexed glyph table.
+void font_get_char(bench::State &state) {
+    const Font *title_font = get_title_font();
+    const Font *body_font = get_body_font();
+
+    uint32_t sum = 0;
+    while (state.keepRunning()) {
+        for (int pass = 0; pass < 3; ++pass) {
+            for (char c : Title)
+                sum += ::font_get_char(title_font, c)->width;
+            for (char c : Body)
+                if (body_font->glyphs[(unsigned char)c])
+                    sum += ::font_get_char(body_font, c)->width;
+        }
+    }
+
+    state.setCounter("width", sum);
+}
+
+/// A full render of the same screen into a canvas, for reference.
+void draw_string(bench::State &state) {
+    const Font *title_font = get_title_font();
+    const Font *body_font = get_body_font();
+
+    std::vector<uint8_t> pixels(64 * 256, 0);
+    Canvas canvas;
+    memset(&canvas, 0, sizeof(canvas));
+    canvas.buffer = pixels.data();
+    canvas.width = 256;
+    canvas.height = 64;
+
+    while (state.keepRunning()) {
+        DrawableParams sp = { 0xff, 68, 11 };
+        calc_str_line(body_font, Body.c_str(), 181);
+        ::draw_string(&canvas, title_font, Title.c_str(), &sp, 181,
+                      font_height(title_font));
+        sp.x = 68;
+        sp.y += font_height(body_font) + 3;
+        ::draw_string(&canvas, body_font, Body.c_str(), &sp, 181,
+                      font_height(body_font) + 3);
+    }
+}
+
+} // namespace
+
+BENCHMARK(font_lookup_linear);
+BENCHMARK(font_get_char);
+BENCHMARK(draw_string);
@@ -0,0 +1,133 @@
+extern "C" {
+#include "keepkey/board/confirm_sm.h"
+#include "keepkey/board/messages.h"
+#include "pb_encode.h"
+}
+
+#include "host.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace host {
+
+MessageType last_msg_id;
+uint64_t msgs_sent;
+TxRequest tx_request;
+EthereumTxRequest ethereum_tx_request;
+Failure failure;
+std::vector<std::vector<uint8_t> > reports;
+size_t next_report;
+
+void reset() {
+    last_msg_id = (MessageType)0;
+    msgs_sent = 0;
+    memset(&tx_request, 0, sizeof(tx_request));
+    memset(&ethereum_tx_request, 0, sizeof(ethereum_tx_request));
+    memset(&failure, 0, sizeof(failure));
+    reports.clear();
+    next_report = 0;
+}
+
+bool send_report() {
+    if (next_report >= reports.size())
+        return false;
+
+    const std::vector<uint8_t> &report = reports[next_report++];
+    handle_usb_rx(report.data(), report.size());
+    return true;
+}
+
+size_t queue_message(MessageType id, const pb_field_t *fields, const void *msg) {
+    size_t size = 0;
+    pb_get_encoded_size(&size, fields, msg);
+
+    std::vector<uint8_t> payload(size + 8);
+    payload[0] = '#';
+    payload[1] = '#';
+    payload[2] = (id >> 8) & 0xff;
+    payload[3] = id & 0xff;
+    payload[4] = (size >> 24) & 0xff;
+    payload[5] = (size >> 16) & 0xff;
+    payload[6] = (size >> 8) & 0xff;
+    payload[7] = size & 0xff;
+
+    pb_ostream_t os = pb_ostream_from_buffer(&payload[8], size);
+    pb_encode(&os, fields, msg);
+
+    size_t count = 0;
+    for (size_t pos = 0; pos < payload.size(); pos += 63, count++) {
+        std::vector<uint8_t> report(64, 0);
+        report[0] = '?';
+        std::copy(payload.begin() + pos,
+                  payload.begin() + std::min(pos + 63, payload.size()),
+                  report.begin() + 1);
+        reports.push_back(report);
+    }
+
+    return count;
+}
+
+} // namespace host
+
+extern "C" {
+
+bool __wrap_msg_write(MessageType msg_id, const void *msg) {
+    host::last_msg_id = msg_id;
+    host::msgs_sent++;
+
+    switch (msg_id) {
+    case MessageType_MessageType_TxRequest:
+        memcpy(&host::tx_request, msg, sizeof(host::tx_request));
+        break;
+    case MessageType_MessageType_EthereumTxRequest:
+        memcpy(&host::ethereum_tx_request, msg, sizeof(host::ethereum_tx_request));
+        break;
+    case MessageType_MessageType_Failure:
+        memcpy(&host::failure, msg, sizeof(host::failure));
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+void __wrap_usbPoll(void) {
+    host::send_report();
+}
+
+bool __wrap_confirm(ButtonRequestType type, const char *request_title,
+                    const char *request_body, ...) {
+    return true;
+}
+
+bool __wrap_confirm_with_custom_button_request(ButtonRequest *button_request,
+                                               const char *request_title,
+                                               const char *request_body, ...) {
+    return true;
+}
+
+bool __wrap_confirm_with_custom_layout(layout_notification_t layout_notification_func,
+                                       ButtonRequestType type,
+                                       const char *request_title,
+                                       const char *request_body, ...) {
+    return true;
+}
+
+bool __wrap_confirm_without_button_request(const char *request_title,
+                                           const char *request_body, ...) {
+    return true;
+}
+
+bool __wrap_review(ButtonRequestType type, const char *request_title,
+                   const char *request_body, ...) {
+    return true;
+}
+
+bool __wrap_review_without_button_request(const char *request_title,
+                                          const char *request_body, ...) {
+    return true;
+}
+
+}
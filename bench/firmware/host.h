@@ -0,0 +1,46 @@
+#ifndef KEEPKEY_BENCH_HOST_H
+#define KEEPKEY_BENCH_HOST_H
+
+extern "C" {
+#include "keepkey/board/messages.h"
+}
+
+#include <cstdint>
+#include <vector>
+
+/// Stand-in for the host side of the wire.
+///
+/// firmware-bench is linked with -Wl,--wrap for msg_write, usbPoll and the
+/// confirm_sm entry points, so that handlers run start to finish without a
+/// socket or a button press. Replies are captured here instead of being
+/// encoded, and confirmations always succeed.
+namespace host {
+
+/// Id of the last message the firmware sent, and how many it has sent.
+extern MessageType last_msg_id;
+extern uint64_t msgs_sent;
+
+/// Copies of the last replies of interest.
+extern TxRequest tx_request;
+extern EthereumTxRequest ethereum_tx_request;
+extern Failure failure;
+
+/// Reports the host has to send, and the index of the next one.
+extern std::vector<std::vector<uint8_t> > reports;
+extern size_t next_report;
+
+/// Clears the captured replies and the queued reports.
+void reset();
+
+/// Hands the next report to handle_usb_rx(). usbPoll() calls this, so
+/// handlers that poll for more data are fed from reports too.
+/// \returns false once all reports have been sent.
+bool send_report();
+
+/// Splits an encoded message into 64 byte HID reports and queues them.
+/// \returns the number of reports queued.
+size_t queue_message(MessageType id, const pb_field_t *fields, const void *msg);
+
+} // namespace host
+
+#endif
@@ -0,0 +1,63 @@
+extern "C" {
+#include "keepkey/board/keepkey_display.h"
+#include "keepkey/board/layout.h"
+#include "keepkey/firmware/app_layout.h"
+}
+
+#include "bench.h"
+
+namespace {
+
+const char *const Address = "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2";
+const char *const OtherAddress = "3J98t1WpEZ73CNmQviecrnyiWrnqRhWNLy";
+
+/// A two line confirm screen, drawn and pushed to the display.
+void layout_standard_notification(bench::State &state) {
+    while (state.keepRunning()) {
+        ::layout_standard_notification(
+            "Send", "Send 0.00123456 BTC to\n1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2",
+            NOTIFICATION_REQUEST_NO_ANIMATION);
+        display_refresh();
+    }
+}
+
+/// The address screen of GetAddress with show_display, QR code included.
+void layout_address(bench::State &state) {
+    QRSize size = state.arg(0) ? QR_LARGE : QR_SMALL;
+
+    while (state.keepRunning()) {
+        layout_address_notification("Bitcoin Address", Address,
+                                    NOTIFICATION_REQUEST_NO_ANIMATION);
+        ::layout_address(Address, size);
+        display_refresh();
+    }
+}
+
+/// Just the QR code, with the address changing every iteration so that
+/// each one is encoded rather than served from the cache.
+void layout_address_uncached(bench::State &state) {
+    QRSize size = state.arg(0) ? QR_LARGE : QR_SMALL;
+
+    uint64_t iterations = 0;
+    while (state.keepRunning())
+        ::layout_address(iterations++ % 2 ? Address : OtherAddress, size);
+}
+
+/// The progress bar redrawn while signing.
+void layoutProgress(bench::State &state) {
+    int permil = 0;
+    while (state.keepRunning()) {
+        ::layoutProgress("Signing transaction", permil);
+        display_refresh();
+        permil = (permil + 7) % 1000;
+    }
+}
+
+} // namespace
+
+BENCHMARK(layout_standard_notification);
+BENCHMARK_ARGS(layout_address, 0, 0);
+BENCHMARK_ARGS(layout_address, 1, 0);
+BENCHMARK_ARGS(layout_address_uncached, 0, 0);
+BENCHMARK_ARGS(layout_address_uncached, 1, 0);
+BENCHMARK(layoutProgress);
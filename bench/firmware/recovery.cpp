@@ -0,0 +1,41 @@
+extern "C" {
+#include "keepkey/firmware/recovery_cipher.h"
+#include "trezor/crypto/bip39_english.h"
+}
+
+#include "bench.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Completes the first arg(0) letters of every BIP39 word, once per
+/// iteration. Four letters always identify a word; three are often ambiguous.
+void attempt_auto_complete(bench::State &state) {
+    const size_t prefix_len = state.arg(0);
+
+    std::vector<std::string> prefixes;
+    for (int i = 0; wordlist[i]; i++)
+        prefixes.push_back(std::string(wordlist[i]).substr(0, prefix_len));
+
+    char partial_word[12];
+    uint64_t completed = 0;
+    while (state.keepRunning()) {
+        completed = 0;
+        for (const std::string &prefix : prefixes) {
+            memset(partial_word, 0, sizeof(partial_word));
+            memcpy(partial_word, prefix.c_str(), prefix.size());
+            completed += ::attempt_auto_complete(partial_word);
+        }
+    }
+
+    state.setCounter("words", prefixes.size());
+    state.setCounter("completed", completed);
+}
+
+} // namespace
+
+BENCHMARK_ARGS(attempt_auto_complete, 3, 0);
+BENCHMARK_ARGS(attempt_auto_complete, 4, 0);
@@ -0,0 +1,99 @@
+extern "C" {
+#include "keepkey/board/pubkeys.h"
+#include "keepkey/board/signatures.h"
+#include "trezor/crypto/ecdsa.h"
+#include "trezor/crypto/secp256k1.h"
+#include "trezor/crypto/sha2.h"
+}
+
+#include "bench.h"
+#include "verify.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/// Three signatures over one digest, made with throwaway keys.
+struct Signed {
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    uint8_t pub[SIGNATURES][PUBKEY_LENGTH];
+    uint8_t sig[SIGNATURES][64];
+    const uint8_t *keys[SIGNATURES];
+    const uint8_t *sigs[SIGNATURES];
+
+    Signed() {
+        sha256_Raw((const uint8_t *)"firmware", 8, digest);
+        for (int i = 0; i < SIGNATURES; i++) {
+            uint8_t priv[32];
+            memset(priv, 0x11 * (i + 1), sizeof(priv));
+            ecdsa_get_public_key65(&secp256k1, priv, pub[i]);
+            ecdsa_sign_digest(&secp256k1, priv, digest, sig[i], nullptr, nullptr);
+            keys[i] = pub[i];
+            sigs[i] = sig[i];
+        }
+    }
+};
+
+/// What signatures_ok() used to do: one ecdsa_verify_digest() per signature.
+void signatures_sequential(bench::State &state) {
+    Signed s;
+    int failed = 0;
+    while (state.keepRunning()) {
+        failed = 0;
+        for (int i = 0; i < SIGNATURES; i++)
+            failed |= ecdsa_verify_digest(&secp256k1, s.keys[i], s.sigs[i], s.digest);
+    }
+
+    if (failed)
+        state.skipWithError("signature did not verify");
+}
+
+void signatures_verify_batch(bench::State &state) {
+    Signed s;
+    uint32_t failed = 0;
+    while (state.keepRunning())
+        failed = ::signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES);
+
+    if (failed)
+        state.skipWithError("signature did not verify");
+}
+
+/// A release run through firmware-verify: 16 images of 256 KiB on arg(0)
+/// threads. The release keys are offline, so the signatures are in range
+/// but don't verify; signatures_check() does the same work either way.
+void verify_images(bench::State &state) {
+    const size_t count = 16, code_len = 256 * 1024;
+
+    std::vector<std::vector<uint8_t> > images(count);
+    for (size_t n = 0; n < count; n++) {
+        std::vector<uint8_t> &image = images[n];
+        image.resize(FLASH_META_DESC_LEN + code_len);
+        for (size_t i = 0; i < image.size(); i++)
+            image[i] = (uint8_t)(i * 31 + n);
+
+        app_meta_td *meta = (app_meta_td *)image.data();
+        memcpy(meta->magic, META_MAGIC_STR, META_MAGIC_SIZE);
+        meta->code_len = code_len;
+        meta->sig_index1 = 1;
+        meta->sig_index2 = 2;
+        meta->sig_index3 = 3;
+        for (uint8_t *sig : { meta->sig1, meta->sig2, meta->sig3 }) {
+            sig[0] = 0x7f;   // r, s < n
+            sig[32] = 0x7f;
+        }
+    }
+
+    while (state.keepRunning())
+        fwverify::verify_images(images, (unsigned)state.arg(0));
+
+    state.setBytesPerIteration(count * code_len);
+    state.setCounter("images", count);
+}
+
+} // namespace
+
+BENCHMARK(signatures_sequential);
+BENCHMARK(signatures_verify_batch);
+BENCHMARK_ARGS(verify_images, 1, 0);
+BENCHMARK_ARGS(verify_images, 4, 0);
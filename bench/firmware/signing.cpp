@@ -0,0 +1,245 @@
+extern "C" {
+#include "keepkey/firmware/coins.h"
+#include "keepkey/firmware/signing.h"
+#include "keepkey/firmware/transaction.h"
+#include "trezor/crypto/bip32.h"
+#include "trezor/crypto/curves.h"
+#include "trezor/crypto/ecdsa.h"
+}
+
+#include "bench.h"
+#include "host.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint64_t InputAmount = 100000;
+const uint64_t Fee = 10000;
+const char *const Destination = "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2";
+
+/// An N-input, M-output legacy Bitcoin spend. Input i spends output 0 of
+/// a one-in, one-out previous transaction paying m/44'/0'/0'/0/i, or with
+/// shared set, output i of a single one-in, N-out previous transaction.
+struct SyntheticTx {
+    const CoinType *coin;
+    HDNode root;
+    size_t inputs, outputs;
+    bool shared;
+    std::vector<std::vector<uint8_t> > prev_hashes;
+    std::vector<TxOutputBinType> prev_outputs;
+
+    SyntheticTx(size_t inputs, size_t outputs, bool shared = false);
+
+    size_t prevOutputs() const { return shared ? inputs : 1; }
+
+    void prevInput(size_t i, TxInputType *in) const;
+    void input(size_t i, TxInputType *in) const;
+    void output(size_t i, TxOutputType *out) const;
+    int prevIndex(const TxRequestDetailsType &details) const;
+};
+
+SyntheticTx::SyntheticTx(size_t inputs, size_t outputs, bool shared)
+    : coin(coinByName("Bitcoin")), inputs(inputs), outputs(outputs), shared(shared) {
+    uint8_t seed[64];
+    memset(seed, 0x5a, sizeof(seed));
+    hdnode_from_seed(seed, sizeof(seed), SECP256K1_NAME, &root);
+
+    const curve_info *curve = get_curve_by_name(coin->curve_name);
+    TxStruct t;
+    for (size_t i = 0; i < inputs; i++) {
+        if (!shared || i == 0) {
+            tx_init(&t, 1, prevOutputs(), 1, 0, 0, 0, curve->hasher_sign, false, 0);
+
+            TxInputType in;
+            prevInput(i, &in);
+            tx_serialize_input_hash(&t, &in);
+        }
+
+        HDNode node = root;
+        uint32_t path[] = { 0x80000000 | 44, 0x80000000, 0x80000000, 0, (uint32_t)i };
+        for (uint32_t index : path)
+            hdnode_private_ckd(&node, index);
+        hdnode_fill_public_key(&node);
+
+        TxOutputBinType out;
+        memset(&out, 0, sizeof(out));
+        out.amount = InputAmount;
+        out.script_pubkey.size = 25;
+        out.script_pubkey.bytes[0] = 0x76; // OP_DUP
+        out.script_pubkey.bytes[1] = 0xA9; // OP_HASH_160
+        out.script_pubkey.bytes[2] = 0x14; // pushing 20 bytes
+        ecdsa_get_pubkeyhash(node.public_key, curve->hasher_pubkey,
+                             out.script_pubkey.bytes + 3);
+        out.script_pubkey.bytes[23] = 0x88; // OP_EQUALVERIFY
+        out.script_pubkey.bytes[24] = 0xAC; // OP_CHECKSIG
+        tx_serialize_output_hash(&t, &out);
+        prev_outputs.push_back(out);
+
+        if (!shared || i == inputs - 1) {
+            std::vector<uint8_t> hash(32);
+            tx_hash_final(&t, hash.data(), true);
+            prev_hashes.push_back(hash);
+        }
+    }
+}
+
+void SyntheticTx::prevInput(size_t i, TxInputType *in) const {
+    memset(in, 0, sizeof(*in));
+    in->prev_hash.size = 32;
+    memset(in->prev_hash.bytes, 0xc0, 32);
+    in->prev_hash.bytes[0] = i & 0xff;
+    in->prev_hash.bytes[1] = (i >> 8) & 0xff;
+    in->prev_index = 1;
+    // Typical size of a p2pkh scriptSig.
+    in->has_script_sig = true;
+    in->script_sig.size = 107;
+    memset(in->script_sig.bytes, 0x47, in->script_sig.size);
+    in->has_sequence = true;
+    in->sequence = 0xffffffff;
+}
+
+void SyntheticTx::input(size_t i, TxInputType *in) const {
+    memset(in, 0, sizeof(*in));
+    in->address_n_count = 5;
+    in->address_n[0] = 0x80000000 | 44;
+    in->address_n[1] = 0x80000000;
+    in->address_n[2] = 0x80000000;
+    in->address_n[3] = 0;
+    in->address_n[4] = i;
+    in->prev_hash.size = 32;
+    memcpy(in->prev_hash.bytes, prev_hashes[shared ? 0 : i].data(), 32);
+    in->prev_index = shared ? i : 0;
+    in->has_sequence = true;
+    in->sequence = 0xffffffff;
+    in->has_script_type = true;
+    in->script_type = InputScriptType_SPENDADDRESS;
+}
+
+void SyntheticTx::output(size_t i, TxOutputType *out) const {
+    memset(out, 0, sizeof(*out));
+    out->has_address = true;
+    snprintf(out->address, sizeof(out->address), "%s", Destination);
+    out->amount = (inputs * InputAmount - Fee) / outputs;
+    out->script_type = OutputScriptType_PAYTOADDRESS;
+}
+
+int SyntheticTx::prevIndex(const TxRequestDetailsType &details) const {
+    for (size_t i = 0; i < prev_hashes.size(); i++)
+        if (memcmp(details.tx_hash.bytes, prev_hashes[i].data(), 32) == 0)
+            return (int)i;
+    return -1;
+}
+
+/// Answers TxRequests until the firmware reports TXFINISHED.
+/// \returns false and sets error if signing stopped early.
+bool runHost(const SyntheticTx &stx, std::string &error) {
+    static TransactionType tx;
+
+    for (;;) {
+        if (host::last_msg_id == MessageType_MessageType_Failure) {
+            error = std::string("signing failed: ") + host::failure.message;
+            return false;
+        }
+
+        const TxRequest &req = host::tx_request;
+        if (req.request_type == RequestType_TXFINISHED)
+            return true;
+
+        memset(&tx, 0, sizeof(tx));
+        int prev = req.details.has_tx_hash ? stx.prevIndex(req.details) : 0;
+        if (prev < 0) {
+            error = "unknown previous transaction requested";
+            return false;
+        }
+
+        size_t idx = req.details.request_index;
+        switch (req.request_type) {
+        case RequestType_TXMETA:
+            tx.has_version = true;
+            tx.version = 1;
+            tx.has_lock_time = true;
+            tx.lock_time = 0;
+            tx.has_inputs_cnt = true;
+            tx.inputs_cnt = 1;
+            tx.has_outputs_cnt = true;
+            tx.outputs_cnt = stx.prevOutputs();
+            break;
+        case RequestType_TXINPUT:
+            tx.inputs_count = 1;
+            if (req.details.has_tx_hash)
+                stx.prevInput(prev, &tx.inputs[0]);
+            else
+                stx.input(idx, &tx.inputs[0]);
+            break;
+        case RequestType_TXOUTPUT:
+            if (req.details.has_tx_hash) {
+                tx.bin_outputs_count = 1;
+                tx.bin_outputs[0] = stx.prev_outputs[stx.shared ? idx : prev];
+            } else {
+                tx.outputs_count = 1;
+                stx.output(idx, &tx.outputs[0]);
+            }
+            break;
+        default:
+            error = "unexpected request type";
+            return false;
+        }
+
+        uint64_t sent = host::msgs_sent;
+        ::signing_txack(&tx);
+        if (host::msgs_sent == sent) {
+            error = "no reply to TxAck";
+            return false;
+        }
+    }
+}
+
+void run(bench::State &state, const SyntheticTx &stx) {
+    SignTx msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.inputs_count = stx.inputs;
+    msg.outputs_count = stx.outputs;
+    msg.has_version = true;
+    msg.version = 1;
+    msg.has_lock_time = true;
+    msg.lock_time = 0;
+
+    uint64_t msgs = 0;
+    while (state.keepRunning()) {
+        host::reset();
+        signing_init(&msg, stx.coin, &stx.root);
+
+        std::string error;
+        if (!runHost(stx, error)) {
+            signing_abort();
+            state.skipWithError(error);
+            break;
+        }
+        msgs = host::msgs_sent;
+    }
+
+    state.setCounter("inputs", stx.inputs);
+    state.setCounter("outputs", stx.outputs);
+    state.setCounter("tx_requests", msgs);
+}
+
+void signing_txack(bench::State &state) {
+    run(state, SyntheticTx(state.arg(0), state.arg(1)));
+}
+
+/// A consolidation: every input spends an output of the same transaction.
+void signing_txack_consolidate(bench::State &state) {
+    run(state, SyntheticTx(state.arg(0), state.arg(1), true));
+}
+
+} // namespace
+
+BENCHMARK_ARGS(signing_txack, 1, 1);
+BENCHMARK_ARGS(signing_txack, 5, 2);
+BENCHMARK_ARGS(signing_txack, 20, 4);
+BENCHMARK_ARGS(signing_txack_consolidate, 5, 1);
+BENCHMARK_ARGS(signing_txack_consolidate, 16, 1);
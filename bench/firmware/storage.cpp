@@ -0,0 +1,127 @@
+extern "C" {
+#include "keepkey/board/common.h"
+#include "keepkey/board/layout.h"
+#include "keepkey/firmware/storage.h"
+#include "storage.h"
+#include "trezor/crypto/bip39.h"
+#include "trezor/crypto/pbkdf2.h"
+}
+
+#include "bench.h"
+
+#include <cstring>
+
+namespace {
+
+/// Writes the config sector back to (emulated) flash. The label changes
+/// every iteration so that each commit has something to write.
+void storage_commit(bench::State &state) {
+    uint32_t written = storage_getCommitsWritten();
+    uint64_t iterations = 0;
+
+    while (state.keepRunning()) {
+        ::storage_setLabel(iterations++ % 2 ? "firmware-bench" : "firmware-bench2");
+        ::storage_commit();
+    }
+
+    if (storage_getCommitsWritten() - written != iterations)
+        state.skipWithError("commit was skipped");
+}
+
+/// Commits with nothing changed, as happens at the end of most sessions.
+void storage_commit_unchanged(bench::State &state) {
+    ::storage_setLabel("firmware-bench");
+    ::storage_commit();
+
+    uint32_t written = storage_getCommitsWritten();
+    while (state.keepRunning())
+        ::storage_commit();
+
+    if (storage_getCommitsWritten() != written)
+        state.skipWithError("unchanged commit reached flash");
+}
+
+/// Full PIN check: wrapping key stretch, unwrap and fingerprint compare.
+void storage_isPinCorrect(bench::State &state) {
+    bool sca_hardened = true;
+
+    uint8_t random_salt[RANDOM_SALT_LEN];
+    memset(random_salt, 0, sizeof(random_salt));
+
+    uint8_t wrapping_key[64];
+    storage_deriveWrappingKey("1234", wrapping_key, sca_hardened, random_salt, "");
+
+    const uint8_t storage_key[64] = "Quick blue fox";
+    uint8_t wrapped_key[64];
+    storage_wrapStorageKey(wrapping_key, storage_key, wrapped_key);
+
+    uint8_t fingerprint[32];
+    storage_keyFingerprint(storage_key, fingerprint);
+
+    uint8_t key_out[64];
+    while (state.keepRunning()) {
+        if (storage_isPinCorrect_impl("1234", wrapped_key, fingerprint, &sca_hardened,
+                                      key_out, random_salt) != PIN_GOOD) {
+            state.skipWithError("PIN rejected");
+        }
+    }
+}
+
+/// The PIN stretch alone, as a baseline for storage_deriveWrappingKey.
+void pin_stretch(bench::State &state) {
+    uint8_t salt[HW_ENTROPY_LEN + RANDOM_SALT_LEN];
+    memset(salt, 0, sizeof(salt));
+
+    uint8_t key[64];
+    while (state.keepRunning())
+        pbkdf2_hmac_sha256((const uint8_t *)"1234", 4, salt, sizeof(salt),
+                           PIN_ITER_COUNT, key, sizeof(key));
+}
+
+/// Stretching with the progress bar drawn, which should cost little more
+/// than pin_stretch.
+void storage_deriveWrappingKey(bench::State &state) {
+    uint8_t random_salt[RANDOM_SALT_LEN];
+    memset(random_salt, 0, sizeof(random_salt));
+
+    uint8_t key[64];
+    while (state.keepRunning())
+        ::storage_deriveWrappingKey("1234", key, true, random_salt, "Verifying PIN");
+}
+
+const char *const Mnemonic =
+    "legal winner thank year wave sausage worth useful "
+    "legal winner thank year wave sausage worth title";
+
+void seed_progress(uint32_t iter, uint32_t total) {
+    ::animating_progress_handler("Waking up", 1000 * iter / total);
+}
+
+/// BIP-0039 seed through trezor-crypto, redrawing on every callback.
+void mnemonic_to_seed(bench::State &state) {
+    uint8_t seed[64];
+    while (state.keepRunning())
+        ::mnemonic_to_seed(Mnemonic, "TREZOR", seed, seed_progress);
+}
+
+/// BIP-0039 seed as storage_getSeed() derives it.
+void storage_mnemonicToSeed(bench::State &state) {
+    uint8_t seed[64], expected[64];
+    ::mnemonic_to_seed(Mnemonic, "TREZOR", expected, nullptr);
+
+    while (state.keepRunning())
+        ::storage_mnemonicToSeed(Mnemonic, "TREZOR", seed, "Waking up");
+
+    if (memcmp(seed, expected, sizeof(seed)) != 0)
+        state.skipWithError("seed mismatch");
+}
+
+} // namespace
+
+BENCHMARK(storage_commit);
+BENCHMARK(storage_commit_unchanged);
+BENCHMARK(storage_isPinCorrect);
+BENCHMARK(pin_stretch);
+BENCHMARK(storage_deriveWrappingKey);
+BENCHMARK(mnemonic_to_seed);
+BENCHMARK(storage_mnemonicToSeed);
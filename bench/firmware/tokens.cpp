@@ -0,0 +1,61 @@
+extern "C" {
+#include "keepkey/firmware/ethereum_tokens.h"
+}
+
+#include "bench.h"
+#include "synthetic_tokens.h"
+
+namespace {
+
+/// The scan tokenByChainAddress did before the table was indexed.
+void token_lookup_linear(bench::State &state) {
+    SyntheticTokens tokens(state.arg(0));
+
+    uint64_t n = 0, misses = 0;
+    while (state.keepRunning()) {
+        const TokenType &want = tokens.pick(n++);
+        misses += tokens.linearByChainAddress(want) != &want;
+    }
+
+    if (misses)
+        state.skipWithError("token not found");
+}
+
+void tokenSearchByChainAddress(bench::State &state) {
+    SyntheticTokens tokens(state.arg(0));
+
+    uint64_t n = 0, misses = 0;
+    while (state.keepRunning()) {
+        const TokenType &want = tokens.pick(n++);
+        misses += ::tokenSearchByChainAddress(
+            tokens.table.data(), tokens.by_address.data(), tokens.table.size(),
+            want.chain_id, (const uint8_t *)want.address) != &want;
+    }
+
+    if (misses)
+        state.skipWithError("token not found");
+}
+
+void tokenSearchByTicker(bench::State &state) {
+    SyntheticTokens tokens(state.arg(0));
+
+    uint64_t n = 0, misses = 0;
+    while (state.keepRunning()) {
+        const TokenType &want = tokens.pick(n++);
+        const TokenType *token;
+        misses += ::tokenSearchByTicker(tokens.table.data(),
+                                        tokens.by_ticker.data(),
+                                        tokens.table.size(), want.chain_id,
+                                        want.ticker + 1, &token) != 1 ||
+                  token != &want;
+    }
+
+    if (misses)
+        state.skipWithError("token not found");
+}
+
+} // namespace
+
+BENCHMARK_ARGS(token_lookup_linear, 10000, 0);
+BENCHMARK_ARGS(tokenSearchByChainAddress, 10000, 0);
+BENCHMARK_ARGS(tokenSearchByTicker, 10000, 0);
@@ -0,0 +1,99 @@
+extern "C" {
+#include "keepkey/board/messages.h"
+#include "keepkey/firmware/fsm.h"
+}
+
+#include "bench.h"
+#include "host.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+uint64_t handled, failed;
+
+void count_handled(void *msg) {
+    (void)msg;
+    handled++;
+}
+
+void count_failed(FailureType code, const char *text) {
+    (void)code;
+    (void)text;
+    failed++;
+}
+
+/// Sends one message over HID reports and decodes it into a handler that
+/// does nothing, so that only the receive path is timed.
+void run(bench::State &state, MessageType id, const pb_field_t *fields, const void *msg) {
+    host::reset();
+    size_t reports = host::queue_message(id, fields, msg);
+
+    // Only the message under test is in the map.
+    std::vector<MessagesMap_t> map(id + 1);
+    for (size_t i = 0; i < map.size(); i++)
+        map[i].msg_id = (MessageType)0xffff;
+    map[id].msg_id = id;
+    map[id].type = NORMAL_MSG;
+    map[id].dir = IN_MSG;
+    map[id].fields = fields;
+    map[id].dispatch = PARSABLE;
+    map[id].process_func = &count_handled;
+
+    msg_map_init(map.data(), map.size());
+    set_msg_failure_handler(&count_failed);
+
+    handled = failed = 0;
+    uint64_t iterations = 0;
+    while (state.keepRunning()) {
+        host::next_report = 0;
+        host::send_report();
+        iterations++;
+    }
+
+    fsm_init();
+
+    if (failed || handled != iterations)
+        state.skipWithError("message was not decoded");
+
+    state.setBytesPerIteration(reports * 64);
+    state.setCounter("reports", reports);
+}
+
+void usb_rx_EthereumTxAck(bench::State &state) {
+    static EthereumTxAck msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.has_data_chunk = true;
+    msg.data_chunk.size = sizeof(msg.data_chunk.bytes);
+    memset(msg.data_chunk.bytes, 0x42, msg.data_chunk.size);
+
+    run(state, MessageType_MessageType_EthereumTxAck, EthereumTxAck_fields, &msg);
+}
+
+void usb_rx_TxAck(bench::State &state) {
+    static TxAck msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.has_tx = true;
+    msg.tx.inputs_count = 1;
+    TxInputType &in = msg.tx.inputs[0];
+    in.address_n_count = 5;
+    in.address_n[0] = 0x80000000 | 44;
+    in.address_n[1] = 0x80000000;
+    in.address_n[2] = 0x80000000;
+    in.prev_hash.size = 32;
+    memset(in.prev_hash.bytes, 0xc0, 32);
+    in.has_sequence = true;
+    in.sequence = 0xffffffff;
+    in.has_script_type = true;
+    in.script_type = InputScriptType_SPENDADDRESS;
+    in.has_amount = true;
+    in.amount = 100000;
+
+    run(state, MessageType_MessageType_TxAck, TxAck_fields, &msg);
+}
+
+} // namespace
+
+BENCHMARK(usb_rx_EthereumTxAck);
+BENCHMARK(usb_rx_TxAck);
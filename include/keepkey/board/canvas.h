@@ -31,6 +31,13 @@ typedef struct
 	uint16_t 	height;
 	uint16_t 	width;
 	bool 		dirty;
+
+	/* Bounding box of pixels changed since the last refresh, valid when
+	 * dirty is set. The x1/y1 bounds are exclusive. */
+	uint16_t 	dirty_x0;
+	uint16_t 	dirty_y0;
+	uint16_t 	dirty_x1;
+	uint16_t 	dirty_y1;
 } Canvas;
 
 #endif
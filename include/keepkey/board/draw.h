@@ -57,6 +57,10 @@ void draw_char_simple(Canvas *canvas, const Font *font, char c, uint8_t color, u
 void draw_box(Canvas *canvas, BoxDrawableParams  *params);
 void draw_box_simple(Canvas *canvas, uint8_t color, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 bool draw_bitmap_mono_rle(Canvas *canvas, const AnimationFrame *frame, bool erase);
+bool draw_bitmap_mono_scaled(Canvas *canvas, const uint8_t *bits, uint16_t stride,
+                             uint16_t width, uint16_t height, uint16_t x, uint16_t y,
+                             uint8_t scale, uint8_t border, uint8_t set_color,
+                             uint8_t clear_color);
 
 #endif
 
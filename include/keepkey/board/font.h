@@ -33,20 +33,16 @@ typedef struct
 } CharacterImage;
 
 
-/* Character information. */
-typedef struct
-{
-    long int                code;
-    const CharacterImage   *image;
-} Character;
+/* Number of entries in a font's glyph table, one per 7-bit ascii code. */
+#define FONT_GLYPHS 128
 
 
-/* A complete font package. */
+/* A complete font package. Glyphs are indexed directly by character code,
+ * with NULL entries for characters the font does not have. */
 typedef struct
 {
-    int                 length;
-    int                 size;
-    const Character    *characters;
+    int                         size;
+    const CharacterImage *const *glyphs;
 } Font;
 
 
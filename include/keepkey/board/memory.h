@@ -254,6 +254,35 @@ void memory_unlock(void);
 /// \param cached  Whether a cached value is acceptable.
 int memory_bootloader_hash(uint8_t *hash, bool cached);
 
+/// Digests of a firmware image, taken in a single pass over it.
+typedef struct _FirmwareMeasurement
+{
+    uint32_t code_len;
+    /// sha256 of the application, which the metadata signatures cover.
+    uint8_t fingerprint[SHA256_DIGEST_LENGTH];
+    /// sha256 of the metadata and application, as reported in Features.
+    uint8_t firmware_hash[SHA256_DIGEST_LENGTH];
+} FirmwareMeasurement;
+
+/// Hash a firmware image, reading it only once.
+///
+/// \param meta      FLASH_META_DESC_LEN bytes of metadata. The magic is not
+///                  read, since it is only written once the image checks out.
+/// \param app       The application, code_len bytes long.
+/// \param code_len  Length of the application.
+/// \param m         Filled with both digests.
+void memory_measure(const uint8_t *meta, const uint8_t *app, uint32_t code_len,
+                    FirmwareMeasurement *m);
+
+/// Measurement of the firmware in flash. Taken on first use and kept in RAM
+/// until the application sectors are erased or written.
+///
+/// \returns NULL if the metadata code length doesn't fit in flash.
+const FirmwareMeasurement *memory_firmware_measurement(void);
+
+/// Forget the cached firmware measurement.
+void memory_firmware_invalidate(void);
+
 int memory_firmware_hash(uint8_t *hash);
 int memory_storage_hash(uint8_t *hash, Allocation storage_location);
 bool find_active_storage(Allocation *storage_location);
@@ -75,6 +75,8 @@
 typedef void (*msg_handler_t)(void *ptr);
 typedef void (*msg_failure_t)(FailureType, const char *);
 typedef bool (*usb_tx_handler_t)(uint8_t *, uint32_t);
+typedef void (*msg_stream_poll_t)(void);
+typedef uint32_t (*msg_stream_clock_t)(void);
 
 #if DEBUG_LINK
 typedef void (*msg_debug_link_get_state_t)(DebugLinkGetState *);
@@ -131,12 +133,26 @@ const pb_field_t *message_fields(MessageMapType type, MessageType msg_id,
 
 bool msg_write(MessageType msg_id, const void *msg);
 
+/// Sends one 64-byte HID report of an outgoing message.
+/// \param iface 0 for the main interface, 1 for debug link.
+typedef void (*msg_report_sink_t)(int iface, const uint8_t *report, size_t len);
+
+/// Encodes a message into HID reports, handing each one to sink as it fills.
+/// Unknown and oversized messages are refused before any report is sent. If
+/// encoding fails part way through, the frame is padded out to the length
+/// its header announced and followed by a Failure on the same interface.
+/// \returns false when the message is unknown, too large or fails to encode.
+bool msg_write_impl(msg_report_sink_t sink, int iface, MessageMapType type,
+                    MessageType msg_id, const void *msg);
+
 #if DEBUG_LINK
 bool msg_debug_write(MessageType msg_id, const void *msg);
 #endif
 
 void msg_map_init(const void *map, const size_t size);
 void set_msg_failure_handler(msg_failure_t failure_func);
+void set_msg_stream_poll_handler(msg_stream_poll_t poll_func,
+                                 msg_stream_clock_t clock_func);
 void call_msg_failure_handler(FailureType code, const char *text);
 
 #if DEBUG_LINK
@@ -20,6 +20,35 @@
 #ifndef SIGNATURES_H
 #define SIGNATURES_H
 
+#include "keepkey/board/memory.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Verifies up to SIGNATURES secp256k1 signatures over the same digest.
+///
+/// Gives the same answer as calling ecdsa_verify_digest() once per
+/// signature, but reads the digest once and shares one modular inversion
+/// between all of the signatures.
+///
+///  \param digest   The signed digest.
+///  \param pubkeys  65 byte uncompressed public keys, one per signature.
+///  \param sigs     64 byte r || s signatures.
+///  \param count    Number of signatures, at most SIGNATURES.
+///  \returns a mask with bit i set if sigs[i] failed, 0 if all verified.
+uint32_t signatures_verify_batch(const uint8_t digest[32],
+                                 const uint8_t *const pubkeys[],
+                                 const uint8_t *const sigs[], size_t count);
+
+/// Checks the signatures in a metadata header against a firmware fingerprint
+///
+///  \param meta         Metadata header of the image.
+///  \param fingerprint  SHA-256 of the application that follows it.
+///  \returns SIG_OK if signatures are correct
+///  \returns KEY_EXPIRED if an expired signature was detected
+///  \returns SIG_FAIL for unrecognized signature
+int signatures_check(const app_meta_td *meta, const uint8_t fingerprint[32]);
+
 /// Checks firmware signatures
 ///
 ///  \returns SIG_OK if signatures are correct
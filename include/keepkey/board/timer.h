@@ -27,7 +27,7 @@
 
 #define ONE_SEC         1100    /* Count for 1 second  */
 #define HALF_SEC        500     /* Count for 0.5 second */
-#define MAX_RUNNABLES   3       /* Max number of queue for task manager */
+#define MAX_RUNNABLES   8       /* Max number of tasks for task manager */
 
 
 typedef void (*callback_func_t)(void);
@@ -36,20 +36,15 @@ typedef struct RunnableNode RunnableNode;
 
 struct RunnableNode
 {
-    uint32_t    remaining;
+    uint32_t    expires;        /* timer_ms() tick to run on */
     Runnable    runnable;
     void        *context;
     uint32_t    period;
     bool        repeating;
     RunnableNode *next;
+    RunnableNode **pprev;       /* link pointing here, NULL when not scheduled */
 };
 
-typedef struct
-{
-    RunnableNode   *head;
-    int             size;
-} RunnableQueue;
-
 
 void timerisr_usr(void);
 
@@ -65,6 +60,9 @@ void kk_timer_init(void);
 
 void timer_init(void);
 void delay_ms(uint32_t ms);
+
+/// \returns milliseconds since timer_init(). Compare with subtraction, as it wraps.
+uint32_t timer_ms(void);
 void delay_us(uint32_t us);
 
 /// Defense against Fault Injection: random delay of a few miliseconds
@@ -61,5 +61,26 @@ const TokenType *tokenByChainAddress(uint8_t chain_id, const uint8_t *address);
 /// \returns true iff the token can be uniquely found in the list of known tokens.
 bool tokenByTicker(uint8_t chain_id, const char *ticker, const TokenType **token);
 
+/// Binary search for a token by (chain_id, address).
+///
+/// \param table  Token table to search.
+/// \param index  Positions into table, sorted by (chain_id, address).
+/// \param count  Number of entries in table and index.
+/// \returns the first matching token in table order, or NULL if there is none.
+const TokenType *tokenSearchByChainAddress(const TokenType *table,
+                                           const uint16_t *index, int count,
+                                           uint8_t chain_id,
+                                           const uint8_t *address);
+
+/// Binary search for a token by (chain_id, ticker), where ticker excludes the
+/// leading space stored in TokenType::ticker.
+///
+/// \param index  Positions into table, sorted by (chain_id, ticker).
+/// \param[out] token The first matching token in table order, or NULL.
+/// \returns 0 if no token matched, 1 if exactly one did, and 2 if several did.
+int tokenSearchByTicker(const TokenType *table, const uint16_t *index,
+                        int count, uint8_t chain_id, const char *ticker,
+                        const TokenType **token);
+
 void coinFromToken(CoinType *coin, const TokenType *token);
 #endif
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the KeepKey project.
+ *
+ * Copyright (C) 2019 ShapeShift
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPKEY_FIRMWARE_NODECACHE_H
+#define KEEPKEY_FIRMWARE_NODECACHE_H
+
+#include "trezor/crypto/bip32.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Maximum path depth of a cached intermediate node.
+#define NODE_CACHE_MAXDEPTH 8
+
+/// Number of intermediate nodes kept in the LRU cache.
+#define NODE_CACHE_SIZE 4
+
+/// \brief Derive a private child node, reusing cached intermediate nodes.
+///
+/// Drop-in replacement for hdnode_private_ckd_cached(). Entries are keyed on
+/// the curve, a digest of the root node, and the path prefix, so a changed
+/// seed or passphrase can never hit a stale entry. Both the account-level
+/// node (depth 3) and the parent of the requested node are cached, so that
+/// scanning m/44'/c'/a'/0/0..N costs one child derivation per address.
+///
+/// \param[in,out] inout       Root node on input, derived node on output.
+/// \param[in]     address_n   Path to derive, relative to the root.
+/// \param[in]     count       Number of elements in address_n.
+/// \param[out]    fingerprint Fingerprint of the parent node, may be NULL.
+/// \returns 1 on success, 0 on failure.
+int node_cache_derive(HDNode *inout, const uint32_t *address_n, size_t count,
+                      uint32_t *fingerprint);
+
+/// \brief Wipe all cached nodes.
+void node_cache_clear(void);
+
+#endif
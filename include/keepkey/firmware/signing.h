@@ -30,4 +30,8 @@ void signing_abort(void);
 void signing_txack(TransactionType *tx);
 void send_fsm_co_error_message(int co_error);
 
+/// Whether the outputs of prev_hash are held from an earlier input, so that
+/// later inputs spending it skip streaming it again.
+bool signing_prevtx_cached(const uint8_t *prev_hash);
+
 #endif
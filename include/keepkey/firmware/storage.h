@@ -48,9 +48,15 @@ void storage_wipe(void);
 void session_clear(bool clear_pin);
 
 /// \brief Write content of configuration in shadow memory to storage partion
-///        in flash.
+///        in flash. Does nothing if the active sector already matches.
 void storage_commit(void);
 
+/// \brief Number of storage_commit() calls that erased and wrote flash.
+uint32_t storage_getCommitsWritten(void);
+
+/// \brief Number of storage_commit() calls skipped because nothing changed.
+uint32_t storage_getCommitsSkipped(void);
+
 /// \brief Load configuration data from usb message to shadow memory
 typedef struct _LoadDevice LoadDevice;
 void storage_loadDevice(LoadDevice *msg);
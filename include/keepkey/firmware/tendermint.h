@@ -2,13 +2,25 @@
 #define KEEPKEY_FIRMWARE_TENDERMINT_H
 
 #include "trezor/crypto/bip32.h"
+#include "trezor/crypto/sha2.h"
 
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 
 typedef struct _CoinType CoinType;
-typedef struct _SHA256_CTX SHA256_CTX;
+
+/**
+ * Streams a canonical JSON sign doc into SHA-256.
+ *
+ * Output is collected in a block sized buffer, so the hash only ever sees
+ * whole 64 byte blocks until tendermint_jsonFinal().
+ */
+typedef struct _TendermintJson {
+    SHA256_CTX ctx;
+    uint8_t buf[SHA256_BLOCK_LENGTH];
+    size_t len;
+} TendermintJson;
 
 /**
  * \returns false iff the provided bip32 derivation path matches the given coin.
@@ -28,9 +40,23 @@ bool tendermint_pathMismatched(const CoinType *coin,
  */
 bool tendermint_getAddress(const HDNode *node, const char *prefix, char *address);
 
-void tendermint_sha256UpdateEscaped(SHA256_CTX *ctx, const char *s, size_t len);
+void tendermint_jsonInit(TendermintJson *json);
+
+/// Appends \p s verbatim.
+void tendermint_jsonRaw(TendermintJson *json, const char *s, size_t len);
+
+/// Appends \p s with '"' and '\\' escaped.
+void tendermint_jsonEscaped(TendermintJson *json, const char *s, size_t len);
+
+/**
+ * Appends formatted text. Each call may produce at most 64 characters.
+ *
+ * \returns false if the output was truncated.
+ */
+bool tendermint_jsonPrintf(TendermintJson *json, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
 
-bool tendermint_snprintf(SHA256_CTX *ctx, char *temp, size_t len,
-                         const char *format, ...) __attribute__((format(printf, 4, 5)));
+/// Hashes what is left in the buffer and wipes the writer.
+void tendermint_jsonFinal(TendermintJson *json, uint8_t hash[SHA256_DIGEST_LENGTH]);
 
 #endif
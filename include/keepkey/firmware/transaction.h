@@ -87,8 +87,24 @@ uint32_t tx_serialize_extra_data_hash(TxStruct *tx, const uint8_t *data, uint32_
 uint32_t tx_serialize_decred_witness_hash(TxStruct *tx, const TxInputType *input);
 void tx_hash_final(TxStruct *t, uint8_t *hash, bool reverse);
 
+/* Transaction weights, as used for the fee check while signing. The *_for
+ * variants take script types rather than full inputs and outputs, so that a
+ * transaction can be sized before it is signed. multisig_n == 0 means a
+ * single signature input. */
+uint32_t tx_base_weight(const CoinType *coin, uint32_t inputs_count, uint32_t outputs_count);
+uint32_t tx_segwit_overhead_weight(uint32_t inputs_count);
 uint32_t tx_input_weight(const CoinType *coin, const TxInputType *txinput);
+uint32_t tx_input_weight_for(const CoinType *coin, InputScriptType script_type,
+                             uint32_t multisig_m, uint32_t multisig_n);
 uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const TxOutputType *txoutput);
+uint32_t tx_output_weight_for(const CoinType *coin, const curve_info *curve,
+                              OutputScriptType script_type, bool change, bool multisig,
+                              uint32_t op_return_size, const char *address);
 uint32_t tx_decred_witness_weight(const TxInputType *txinput);
+uint32_t tx_decred_witness_weight_for(uint32_t multisig_m, uint32_t multisig_n);
+
+/* The largest fee signing accepts without the FeeOverThreshold confirmation */
+uint64_t tx_fee_threshold(const CoinType *coin, uint32_t weight);
+bool tx_fee_over_threshold(const CoinType *coin, uint64_t fee, uint32_t weight);
 
 #endif
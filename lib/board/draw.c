@@ -23,13 +23,101 @@
 #include "keepkey/board/resources.h"
 #include "keepkey/firmware/fsm.h"
 
-#include <assert.h>
+#include <stdint.h>
 #include <stddef.h>
 #include <string.h>
 
 #pragma GCC push_options
 #pragma GCC optimize("-O3")
 
+/*
+ * draw_mark_dirty() - Extend the canvas dirty rectangle to cover a region
+ *
+ * INPUT
+ *     - canvas: canvas
+ *     - x: left edge of region
+ *     - y: top edge of region
+ *     - width: width of region
+ *     - height: height of region
+ * OUTPUT
+ *     none
+ */
+static void draw_mark_dirty(Canvas *canvas, int x, int y, int width, int height)
+{
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + width > canvas->width ? canvas->width : x + width;
+    int y1 = y + height > canvas->height ? canvas->height : y + height;
+
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    if (!canvas->dirty) {
+        canvas->dirty_x0 = x0;
+        canvas->dirty_y0 = y0;
+        canvas->dirty_x1 = x1;
+        canvas->dirty_y1 = y1;
+        canvas->dirty = true;
+        return;
+    }
+
+    if (x0 < canvas->dirty_x0) canvas->dirty_x0 = x0;
+    if (y0 < canvas->dirty_y0) canvas->dirty_y0 = y0;
+    if (x1 > canvas->dirty_x1) canvas->dirty_x1 = x1;
+    if (y1 > canvas->dirty_y1) canvas->dirty_y1 = y1;
+}
+
+/*
+ * draw_glyph_row() - Blit one row of a character image onto the canvas
+ *
+ *     Image pixels equal to 0x00 are ink and take the color, all others leave
+ *     the canvas untouched. After the leading bytes, the canvas is written a
+ *     whole aligned 32-bit word at a time. The caller is responsible for
+ *     clipping.
+ *
+ * INPUT
+ *     - dst: first canvas pixel of the row
+ *     - src: first image pixel of the row
+ *     - color: ink color
+ *     - width: number of pixels in the row
+ * OUTPUT
+ *     none
+ */
+static void draw_glyph_row(uint8_t *dst, const uint8_t *src, uint8_t color, int width)
+{
+    const uint32_t color_word = color * 0x01010101u;
+    int x = 0;
+
+    for (; x < width && ((uintptr_t)&dst[x] & 3); x++) {
+        if (src[x] == 0x00) {
+            dst[x] = color;
+        }
+    }
+
+    for (; x + 4 <= width; x += 4) {
+        uint32_t ink, pixels;
+        memcpy(&ink, &src[x], sizeof(ink));
+
+        /* 0xff in every byte lane where the image pixel is 0x00 */
+        ink = ~(((ink & 0x7f7f7f7fu) + 0x7f7f7f7fu) | ink) & 0x80808080u;
+        if (!ink) {
+            continue;
+        }
+        ink = (ink >> 7) * 0xffu;
+
+        memcpy(&pixels, &dst[x], sizeof(pixels));
+        pixels = (pixels & ~ink) | (color_word & ink);
+        memcpy(&dst[x], &pixels, sizeof(pixels));
+    }
+
+    for (; x < width; x++) {
+        if (src[x] == 0x00) {
+            dst[x] = color;
+        }
+    }
+}
+
 /*
  * draw_char_with_shift() - Draw image on display with left/top margins
  *
@@ -52,8 +140,6 @@ bool draw_char_with_shift(Canvas *canvas, DrawableParams *p,
     if (start_index >= (KEEPKEY_DISPLAY_HEIGHT * KEEPKEY_DISPLAY_WIDTH)){
         return false;
     }
-    uint8_t *canvas_pixel = &canvas->buffer[ start_index ];
-    uint8_t *canvas_end = &canvas->buffer[canvas->width * canvas->height];
 
     /* Check that this was a character that we have in the font */
     if(img != NULL)
@@ -62,25 +148,17 @@ bool draw_char_with_shift(Canvas *canvas, DrawableParams *p,
         if(((img->width + p->x) <= canvas->width) &&
                 ((img->height + p->y) <= canvas->height))
         {
-            const uint8_t *img_pixel = &img->data[ 0 ];
+            uint8_t *canvas_row = &canvas->buffer[ start_index ];
+            const uint8_t *img_row = &img->data[ 0 ];
 
-            int y;
+            draw_mark_dirty(canvas, p->x, p->y, img->width, img->height);
 
-            for(y = 0; y < img->height; y++)
+            /* Clipped once above, so rows need no per-pixel checks */
+            for(int y = 0; y < img->height; y++)
             {
-                int x;
-
-                for(x = 0; x < img->width; x++)
-                {
-                    if (canvas_pixel >= canvas_end){
-                        return false; // defensive bounds check
-                    }
-                    *canvas_pixel = (*img_pixel == 0x00) ? p->color : *canvas_pixel;
-                    canvas_pixel++;
-                    img_pixel++;
-                }
-
-                canvas_pixel += (canvas->width - img->width);
+                draw_glyph_row(canvas_row, img_row, p->color, img->width);
+                canvas_row += canvas->width;
+                img_row += img->width;
             }
 
             if(x_shift != NULL)
@@ -97,8 +175,6 @@ bool draw_char_with_shift(Canvas *canvas, DrawableParams *p,
         }
     }
 
-    canvas->dirty = true;
-
     return(ret_stat);
 }
 
@@ -174,8 +250,6 @@ void draw_string(Canvas *canvas, const Font *font, const char *str_write,
         have_space = draw_char_with_shift(canvas, &char_params, &x_offset, NULL, img);
         str_write++;
     }
-
-    canvas->dirty = true;
 }
 
 /*
@@ -196,8 +270,6 @@ void draw_char(Canvas *canvas, const Font *font, char c, DrawableParams *p)
 
     /* Draw Character */
     draw_char_with_shift(canvas, p, &x_offset, NULL, img);
-
-    canvas->dirty = true;
 }
 
 /*
@@ -251,7 +323,7 @@ void draw_box(Canvas *canvas, BoxDrawableParams *p)
     uint16_t height = end_row - start_row;
     uint16_t width = end_col - start_col;
 
-
+    draw_mark_dirty(canvas, start_col, start_row, width, height);
 
     for(uint16_t y = 0; y < height; y++)
     {
@@ -266,8 +338,6 @@ void draw_box(Canvas *canvas, BoxDrawableParams *p)
 
         canvas_pixel += (canvas->width - width);
     }
-
-    canvas->dirty = true;
 }
 
 /*
@@ -289,6 +359,79 @@ void draw_box_simple(Canvas *canvas, uint8_t color, uint16_t x, uint16_t y, uint
     draw_box(canvas, &box_params);
 }
 
+/*
+ * draw_bitmap_mono_scaled() - Draw 1bpp bitmap, each bit as a scale x scale block
+ *
+ * INPUT
+ *     - canvas: canvas
+ *     - bits: bitmap rows, stride bytes apart, leftmost pixel in bit 0
+ *     - stride: bytes per bitmap row
+ *     - width: bitmap width in bits
+ *     - height: bitmap height in rows
+ *     - x: left edge on canvas, border included
+ *     - y: top edge on canvas, border included
+ *     - scale: canvas pixels per bit
+ *     - border: blocks of clear_color around the bitmap
+ *     - set_color: color of set bits
+ *     - clear_color: color of clear bits and border
+ * OUTPUT
+ *     true/false whether bitmap was drawn
+ */
+bool draw_bitmap_mono_scaled(Canvas *canvas, const uint8_t *bits, uint16_t stride,
+                             uint16_t width, uint16_t height, uint16_t x, uint16_t y,
+                             uint8_t scale, uint8_t border, uint8_t set_color,
+                             uint8_t clear_color)
+{
+    const int pad = border * scale;
+    const int scaled_width = width * scale + 2 * pad;
+    const int scaled_height = height * scale + 2 * pad;
+
+    /* Check that bitmap will fit in bounds */
+    if (!canvas || !bits || !scale ||
+        x + scaled_width > canvas->width || y + scaled_height > canvas->height)
+    {
+        return false;
+    }
+
+    draw_mark_dirty(canvas, x, y, scaled_width, scaled_height);
+
+    uint8_t *canvas_row = &canvas->buffer[(y * canvas->width) + x];
+
+    for (int i = 0; i < pad; i++, canvas_row += canvas->width) {
+        memset(canvas_row, clear_color, scaled_width);
+    }
+
+    for (int row = 0; row < height; row++) {
+        const uint8_t *src = bits + row * stride;
+        uint8_t *dst = canvas_row;
+
+        memset(dst, clear_color, pad);
+        dst += pad;
+
+        for (int col = 0; col < width; col++) {
+            const uint8_t color = ((src[col >> 3] >> (col & 7)) & 1)
+                ? set_color : clear_color;
+            for (int i = 0; i < scale; i++) {
+                *dst++ = color;
+            }
+        }
+
+        memset(dst, clear_color, pad);
+        canvas_row += canvas->width;
+
+        /* The rest of the block is a copy of the scanline just expanded */
+        for (int i = 1; i < scale; i++, canvas_row += canvas->width) {
+            memcpy(canvas_row, canvas_row - canvas->width, scaled_width);
+        }
+    }
+
+    for (int i = 0; i < pad; i++, canvas_row += canvas->width) {
+        memset(canvas_row, clear_color, scaled_width);
+    }
+
+    return true;
+}
+
 /*
  * draw_bitmap_mono_rle() - Draw image
  *
@@ -314,58 +457,81 @@ bool draw_bitmap_mono_rle(Canvas *canvas, const AnimationFrame *frame, bool eras
         return false;
     }
 
-    int8_t sequence = 0;
-    int8_t nonsequence = 0;
-    uint32_t pixel_index = 0;
+    draw_mark_dirty(canvas, frame->x, frame->y, img->w, img->h);
 
-    for(int y0 = 0; y0 < img->h; y0++)
+    const int img_width = img->w;
+    uint32_t remaining = (uint32_t)img->w * img->h;
+    uint32_t pixel_index = 0;
+    uint8_t *canvas_row = &canvas->buffer[(frame->y * canvas->width) + frame->x];
+    int x0 = 0;
+
+    /*
+     * Each run is a signed count followed by its data. A count > 0 means the
+     * next pixel value repeats count times; a count < 0 means the next -count
+     * values are all different. Runs may continue onto the next image row.
+     */
+    while(remaining > 0)
     {
-        for(int x0 = 0; x0 < img->w; x0++)
-        {
+        if (pixel_index >= img->length){
+            return false; // defensive bounds check
+        }
 
-            if (pixel_index >= img->length){
-                return false; // defensive bounds check
-            }
+        const int run = (int8_t)img->data[pixel_index];
+        pixel_index++;
 
-            // sequence > 0 implies the next x pixels are the same
-            // sequence < 0 implies the next -x pixels are all different
-            if((sequence == 0) && (nonsequence == 0))
+        if (run == 0 || pixel_index >= img->length){
+            return false; // defensive bounds check
+        }
+
+        if(run > 0)
+        {
+            const uint8_t value = (uint8_t)((int)img->data[pixel_index] * color / 100);
+            uint32_t count = (uint32_t)run < remaining ? (uint32_t)run : remaining;
+            pixel_index++;
+            remaining -= count;
+
+            while(count > 0)
             {
-                sequence = img->data[pixel_index];
-                pixel_index++;
+                int span = img_width - x0;
+                if ((uint32_t)span > count) {
+                    span = count;
+                }
 
-                if(sequence < 0)
+                memset(&canvas_row[x0], value, span);
+                count -= span;
+                x0 += span;
+
+                if(x0 == img_width)
                 {
-                    nonsequence = -sequence;
-                    sequence = 0;
+                    x0 = 0;
+                    canvas_row += canvas->width;
                 }
             }
+        }
+        else
+        {
+            uint32_t count = (uint32_t)-run < remaining ? (uint32_t)-run : remaining;
+            remaining -= count;
 
-            if (pixel_index >= img->length){
-                return false; // defensive bounds check
-            }
+            while(count > 0)
+            {
+                if (pixel_index >= img->length){
+                    return false; // defensive bounds check
+                }
 
-            const uint32_t canvas_index = ((frame->y + y0) * canvas->width) + frame->x + x0;
-            canvas->buffer[canvas_index] = (uint8_t)((int)img->data[pixel_index] * color / 100);
+                canvas_row[x0] = (uint8_t)((int)img->data[pixel_index] * color / 100);
+                pixel_index++;
+                count--;
 
-            if(sequence > 0)
-            {
-                sequence--;
-                if(sequence == 0)
+                if(++x0 == img_width)
                 {
-                    pixel_index++;
+                    x0 = 0;
+                    canvas_row += canvas->width;
                 }
-            } 
-            else 
-            { 
-                assert(nonsequence > 0);
-                pixel_index++;
-                nonsequence--;
             }
         }
     }
 
-    canvas->dirty = true;
     return true;
 }
 #pragma GCC pop_options
@@ -239,40 +239,39 @@ static const uint8_t image_data_pin_font_0x39[96] =
 };
 static const CharacterImage pin_font_0x39 = { image_data_pin_font_0x39, 8, 12};
 
-static const Character pin_font_array[] =
+static const CharacterImage *const pin_font_array[FONT_GLYPHS] =
 {
 
     /* Character: '1' */
-    {0x31, &pin_font_0x31},
+    [0x31] = &pin_font_0x31,
 
     /* Character: '2' */
-    {0x32, &pin_font_0x32},
+    [0x32] = &pin_font_0x32,
 
     /* Character: '3' */
-    {0x33, &pin_font_0x33},
+    [0x33] = &pin_font_0x33,
 
     /* Character: '4' */
-    {0x34, &pin_font_0x34},
+    [0x34] = &pin_font_0x34,
 
     /* Character: '5' */
-    {0x35, &pin_font_0x35},
+    [0x35] = &pin_font_0x35,
 
     /* Character: '6' */
-    {0x36, &pin_font_0x36},
+    [0x36] = &pin_font_0x36,
 
     /* Character: '7' */
-    {0x37, &pin_font_0x37},
+    [0x37] = &pin_font_0x37,
 
     /* Character: '8' */
-    {0x38, &pin_font_0x38},
+    [0x38] = &pin_font_0x38,
 
     /* Character: '9' */
-    {0x39, &pin_font_0x39}
+    [0x39] = &pin_font_0x39,
 
 };
 
-static const Font pin_font = { sizeof(pin_font_array)/sizeof(pin_font_array[0]),
-                               14, pin_font_array };
+static const Font pin_font = { 14, pin_font_array };
 
 /* --- Title Font ---------------------------------------------------------- */
 
@@ -1702,306 +1701,305 @@ static const uint8_t image_data_title_font_0x7e[70] =
 static const CharacterImage title_font_0x7e = { image_data_title_font_0x7e, 7, 10};
 
 
-static const Character title_font_array[] =
+static const CharacterImage *const title_font_array[FONT_GLYPHS] =
 {
     /* SegWit logo */
-    {0x01, &segwit_12x10},
+    [0x01] = &segwit_12x10,
 
     /* Unlocked Symbol */
-    {0x02, &unlocked_12x10},
+    [0x02] = &unlocked_12x10,
 
     /* Locked Symbol */
-    {0x03, &locked_12x10},
+    [0x03] = &locked_12x10,
 
     /* Character: ' ' */
-    {0x20, &title_font_0x20},
+    [0x20] = &title_font_0x20,
 
     /* Character: '!' */
-    {0x21, &title_font_0x21},
+    [0x21] = &title_font_0x21,
 
     /* Character: '"' */
-    {0x22, &title_font_0x22},
+    [0x22] = &title_font_0x22,
 
     /* Character: '#' */
-    {0x23, &title_font_0x23},
+    [0x23] = &title_font_0x23,
 
     /* Character: '$' */
-    {0x24, &title_font_0x24},
+    [0x24] = &title_font_0x24,
 
     /* Character: '%' */
-    {0x25, &title_font_0x25},
+    [0x25] = &title_font_0x25,
 
     /* Character: '&' */
-    {0x26, &title_font_0x26},
+    [0x26] = &title_font_0x26,
 
     /* Character: ''' */
-    {0x27, &title_font_0x27},
+    [0x27] = &title_font_0x27,
 
     /* Character: '(' */
-    {0x28, &title_font_0x28},
+    [0x28] = &title_font_0x28,
 
     /* Character: ')' */
-    {0x29, &title_font_0x29},
+    [0x29] = &title_font_0x29,
 
     /* Character: '*' */
-    {0x2a, &title_font_0x2a},
+    [0x2a] = &title_font_0x2a,
 
     /* Character: '+' */
-    {0x2b, &title_font_0x2b},
+    [0x2b] = &title_font_0x2b,
 
     /* Character: ',' */
-    {0x2c, &title_font_0x2c},
+    [0x2c] = &title_font_0x2c,
 
     /* Character: '-' */
-    {0x2d, &title_font_0x2d},
+    [0x2d] = &title_font_0x2d,
 
     /* Character: '.' */
-    {0x2e, &title_font_0x2e},
+    [0x2e] = &title_font_0x2e,
 
     /* Character: '/' */
-    {0x2f, &title_font_0x2f},
+    [0x2f] = &title_font_0x2f,
 
     /* Character: '0' */
-    {0x30, &title_font_0x30},
+    [0x30] = &title_font_0x30,
 
     /* Character: '1' */
-    {0x31, &title_font_0x31},
+    [0x31] = &title_font_0x31,
 
     /* Character: '2' */
-    {0x32, &title_font_0x32},
+    [0x32] = &title_font_0x32,
 
     /* Character: '3' */
-    {0x33, &title_font_0x33},
+    [0x33] = &title_font_0x33,
 
     /* Character: '4' */
-    {0x34, &title_font_0x34},
+    [0x34] = &title_font_0x34,
 
     /* Character: '5' */
-    {0x35, &title_font_0x35},
+    [0x35] = &title_font_0x35,
 
     /* Character: '6' */
-    {0x36, &title_font_0x36},
+    [0x36] = &title_font_0x36,
 
     /* Character: '7' */
-    {0x37, &title_font_0x37},
+    [0x37] = &title_font_0x37,
 
     /* Character: '8' */
-    {0x38, &title_font_0x38},
+    [0x38] = &title_font_0x38,
 
     /* Character: '9' */
-    {0x39, &title_font_0x39},
+    [0x39] = &title_font_0x39,
 
     /* Character: ':' */
-    {0x3a, &title_font_0x3a},
+    [0x3a] = &title_font_0x3a,
 
     /* Character: ';' */
-    {0x3b, &title_font_0x3b},
+    [0x3b] = &title_font_0x3b,
 
     /* Character: '<' */
-    {0x3c, &title_font_0x3c},
+    [0x3c] = &title_font_0x3c,
 
     /* Character: '=' */
-    {0x3d, &title_font_0x3d},
+    [0x3d] = &title_font_0x3d,
 
     /* Character: '>' */
-    {0x3e, &title_font_0x3e},
+    [0x3e] = &title_font_0x3e,
 
     /* Character: '?' */
-    {0x3f, &title_font_0x3f},
+    [0x3f] = &title_font_0x3f,
 
     /* Character: '\x0040' */
-    {0x40, &title_font_0x40},
+    [0x40] = &title_font_0x40,
 
     /* Character: 'A' */
-    {0x41, &title_font_0x41},
+    [0x41] = &title_font_0x41,
 
     /* Character: 'B' */
-    {0x42, &title_font_0x42},
+    [0x42] = &title_font_0x42,
 
     /* Character: 'C' */
-    {0x43, &title_font_0x43},
+    [0x43] = &title_font_0x43,
 
     /* Character: 'D' */
-    {0x44, &title_font_0x44},
+    [0x44] = &title_font_0x44,
 
     /* Character: 'E' */
-    {0x45, &title_font_0x45},
+    [0x45] = &title_font_0x45,
 
     /* Character: 'F' */
-    {0x46, &title_font_0x46},
+    [0x46] = &title_font_0x46,
 
     /* Character: 'G' */
-    {0x47, &title_font_0x47},
+    [0x47] = &title_font_0x47,
 
     /* Character: 'H' */
-    {0x48, &title_font_0x48},
+    [0x48] = &title_font_0x48,
 
     /* Character: 'I' */
-    {0x49, &title_font_0x49},
+    [0x49] = &title_font_0x49,
 
     /* Character: 'J' */
-    {0x4a, &title_font_0x4a},
+    [0x4a] = &title_font_0x4a,
 
     /* Character: 'K' */
-    {0x4b, &title_font_0x4b},
+    [0x4b] = &title_font_0x4b,
 
     /* Character: 'L' */
-    {0x4c, &title_font_0x4c},
+    [0x4c] = &title_font_0x4c,
 
     /* Character: 'M' */
-    {0x4d, &title_font_0x4d},
+    [0x4d] = &title_font_0x4d,
 
     /* Character: 'N' */
-    {0x4e, &title_font_0x4e},
+    [0x4e] = &title_font_0x4e,
 
     /* Character: 'O' */
-    {0x4f, &title_font_0x4f},
+    [0x4f] = &title_font_0x4f,
 
     /* Character: 'P' */
-    {0x50, &title_font_0x50},
+    [0x50] = &title_font_0x50,
 
     /* Character: 'Q' */
-    {0x51, &title_font_0x51},
+    [0x51] = &title_font_0x51,
 
     /* Character: 'R' */
-    {0x52, &title_font_0x52},
+    [0x52] = &title_font_0x52,
 
     /* Character: 'S' */
-    {0x53, &title_font_0x53},
+    [0x53] = &title_font_0x53,
 
     /* Character: 'T' */
-    {0x54, &title_font_0x54},
+    [0x54] = &title_font_0x54,
 
     /* Character: 'U' */
-    {0x55, &title_font_0x55},
+    [0x55] = &title_font_0x55,
 
     /* Character: 'V' */
-    {0x56, &title_font_0x56},
+    [0x56] = &title_font_0x56,
 
     /* Character: 'W' */
-    {0x57, &title_font_0x57},
+    [0x57] = &title_font_0x57,
 
     /* Character: 'X' */
-    {0x58, &title_font_0x58},
+    [0x58] = &title_font_0x58,
 
     /* Character: 'Y' */
-    {0x59, &title_font_0x59},
+    [0x59] = &title_font_0x59,
 
     /* Character: 'Z' */
-    {0x5a, &title_font_0x5a},
+    [0x5a] = &title_font_0x5a,
 
     /* Character: '[' */
-    {0x5b, &title_font_0x5b},
+    [0x5b] = &title_font_0x5b,
 
     /* Character: '\' */
-    {0x5c, &title_font_0x5c},
+    [0x5c] = &title_font_0x5c,
 
     /* Character: ']' */
-    {0x5d, &title_font_0x5d},
+    [0x5d] = &title_font_0x5d,
 
     /* Character: '^' */
-    {0x5e, &title_font_0x5e},
+    [0x5e] = &title_font_0x5e,
 
     /* Character: '_' */
-    {0x5f, &title_font_0x5f},
+    [0x5f] = &title_font_0x5f,
 
     /* Character: '`' */
-    {0x60, &title_font_0x60},
+    [0x60] = &title_font_0x60,
 
     /* Character: 'a' */
-    {0x61, &title_font_0x61},
+    [0x61] = &title_font_0x61,
 
     /* Character: 'b' */
-    {0x62, &title_font_0x62},
+    [0x62] = &title_font_0x62,
 
     /* Character: 'c' */
-    {0x63, &title_font_0x63},
+    [0x63] = &title_font_0x63,
 
     /* Character: 'd' */
-    {0x64, &title_font_0x64},
+    [0x64] = &title_font_0x64,
 
     /* Character: 'e' */
-    {0x65, &title_font_0x65},
+    [0x65] = &title_font_0x65,
 
     /* Character: 'f' */
-    {0x66, &title_font_0x66},
+    [0x66] = &title_font_0x66,
 
     /* Character: 'g' */
-    {0x67, &title_font_0x67},
+    [0x67] = &title_font_0x67,
 
     /* Character: 'h' */
-    {0x68, &title_font_0x68},
+    [0x68] = &title_font_0x68,
 
     /* Character: 'i' */
-    {0x69, &title_font_0x69},
+    [0x69] = &title_font_0x69,
 
     /* Character: 'j' */
-    {0x6a, &title_font_0x6a},
+    [0x6a] = &title_font_0x6a,
 
     /* Character: 'k' */
-    {0x6b, &title_font_0x6b},
+    [0x6b] = &title_font_0x6b,
 
     /* Character: 'l' */
-    {0x6c, &title_font_0x6c},
+    [0x6c] = &title_font_0x6c,
 
     /* Character: 'm' */
-    {0x6d, &title_font_0x6d},
+    [0x6d] = &title_font_0x6d,
 
     /* Character: 'n' */
-    {0x6e, &title_font_0x6e},
+    [0x6e] = &title_font_0x6e,
 
     /* Character: 'o' */
-    {0x6f, &title_font_0x6f},
+    [0x6f] = &title_font_0x6f,
 
     /* Character: 'p' */
-    {0x70, &title_font_0x70},
+    [0x70] = &title_font_0x70,
 
     /* Character: 'q' */
-    {0x71, &title_font_0x71},
+    [0x71] = &title_font_0x71,
 
     /* Character: 'r' */
-    {0x72, &title_font_0x72},
+    [0x72] = &title_font_0x72,
 
     /* Character: 's' */
-    {0x73, &title_font_0x73},
+    [0x73] = &title_font_0x73,
 
     /* Character: 't' */
-    {0x74, &title_font_0x74},
+    [0x74] = &title_font_0x74,
 
     /* Character: 'u' */
-    {0x75, &title_font_0x75},
+    [0x75] = &title_font_0x75,
 
     /* Character: 'v' */
-    {0x76, &title_font_0x76},
+    [0x76] = &title_font_0x76,
 
     /* Character: 'w' */
-    {0x77, &title_font_0x77},
+    [0x77] = &title_font_0x77,
 
     /* Character: 'x' */
-    {0x78, &title_font_0x78},
+    [0x78] = &title_font_0x78,
 
     /* Character: 'y' */
-    {0x79, &title_font_0x79},
+    [0x79] = &title_font_0x79,
 
     /* Character: 'z' */
-    {0x7a, &title_font_0x7a},
+    [0x7a] = &title_font_0x7a,
 
     /* Character: '{' */
-    {0x7b, &title_font_0x7b},
+    [0x7b] = &title_font_0x7b,
 
     /* Character: '|' */
-    {0x7c, &title_font_0x7c},
+    [0x7c] = &title_font_0x7c,
 
     /* Character: '}' */
-    {0x7d, &title_font_0x7d},
+    [0x7d] = &title_font_0x7d,
 
     /* Character: '~' */
-    {0x7e, &title_font_0x7e}
+    [0x7e] = &title_font_0x7e,
 
 };
 
-static const Font title_font = { sizeof(title_font_array)/sizeof(title_font_array[0]),
-                                 10, title_font_array };
+static const Font title_font = { 10, title_font_array };
 
 /* --- Body Font ----------------------------------------------------------- */
 
@@ -3431,306 +3429,305 @@ static const uint8_t image_data_body_font_0x7e[70] =
 static const CharacterImage body_font_0x7e = { image_data_body_font_0x7e, 7, 10};
 
 
-static const Character body_font_array[] =
+static const CharacterImage *const body_font_array[FONT_GLYPHS] =
 {
     /* SegWit logo */
-    {0x01, &segwit_12x10},
+    [0x01] = &segwit_12x10,
 
     /* Unlocked Symbol */
-    {0x02, &unlocked_12x10},
+    [0x02] = &unlocked_12x10,
 
     /* Locked Symbol */
-    {0x03, &locked_12x10},
+    [0x03] = &locked_12x10,
 
     /* Character: ' ' */
-    {0x20, &body_font_0x20},
+    [0x20] = &body_font_0x20,
 
     /* Character: '!' */
-    {0x21, &body_font_0x21},
+    [0x21] = &body_font_0x21,
 
     /* Character: '"' */
-    {0x22, &body_font_0x22},
+    [0x22] = &body_font_0x22,
 
     /* Character: '#' */
-    {0x23, &body_font_0x23},
+    [0x23] = &body_font_0x23,
 
     /* Character: '$' */
-    {0x24, &body_font_0x24},
+    [0x24] = &body_font_0x24,
 
     /* Character: '%' */
-    {0x25, &body_font_0x25},
+    [0x25] = &body_font_0x25,
 
     /* Character: '&' */
-    {0x26, &body_font_0x26},
+    [0x26] = &body_font_0x26,
 
     /* Character: ''' */
-    {0x27, &body_font_0x27},
+    [0x27] = &body_font_0x27,
 
     /* Character: '(' */
-    {0x28, &body_font_0x28},
+    [0x28] = &body_font_0x28,
 
     /* Character: ')' */
-    {0x29, &body_font_0x29},
+    [0x29] = &body_font_0x29,
 
     /* Character: '*' */
-    {0x2a, &body_font_0x2a},
+    [0x2a] = &body_font_0x2a,
 
     /* Character: '+' */
-    {0x2b, &body_font_0x2b},
+    [0x2b] = &body_font_0x2b,
 
     /* Character: ',' */
-    {0x2c, &body_font_0x2c},
+    [0x2c] = &body_font_0x2c,
 
     /* Character: '-' */
-    {0x2d, &body_font_0x2d},
+    [0x2d] = &body_font_0x2d,
 
     /* Character: '.' */
-    {0x2e, &body_font_0x2e},
+    [0x2e] = &body_font_0x2e,
 
     /* Character: '/' */
-    {0x2f, &body_font_0x2f},
+    [0x2f] = &body_font_0x2f,
 
     /* Character: '0' */
-    {0x30, &body_font_0x30},
+    [0x30] = &body_font_0x30,
 
     /* Character: '1' */
-    {0x31, &body_font_0x31},
+    [0x31] = &body_font_0x31,
 
     /* Character: '2' */
-    {0x32, &body_font_0x32},
+    [0x32] = &body_font_0x32,
 
     /* Character: '3' */
-    {0x33, &body_font_0x33},
+    [0x33] = &body_font_0x33,
 
     /* Character: '4' */
-    {0x34, &body_font_0x34},
+    [0x34] = &body_font_0x34,
 
     /* Character: '5' */
-    {0x35, &body_font_0x35},
+    [0x35] = &body_font_0x35,
 
     /* Character: '6' */
-    {0x36, &body_font_0x36},
+    [0x36] = &body_font_0x36,
 
     /* Character: '7' */
-    {0x37, &body_font_0x37},
+    [0x37] = &body_font_0x37,
 
     /* Character: '8' */
-    {0x38, &body_font_0x38},
+    [0x38] = &body_font_0x38,
 
     /* Character: '9' */
-    {0x39, &body_font_0x39},
+    [0x39] = &body_font_0x39,
 
     /* Character: ':' */
-    {0x3a, &body_font_0x3a},
+    [0x3a] = &body_font_0x3a,
 
     /* Character: ';' */
-    {0x3b, &body_font_0x3b},
+    [0x3b] = &body_font_0x3b,
 
     /* Character: '<' */
-    {0x3c, &body_font_0x3c},
+    [0x3c] = &body_font_0x3c,
 
     /* Character: '=' */
-    {0x3d, &body_font_0x3d},
+    [0x3d] = &body_font_0x3d,
 
     /* Character: '>' */
-    {0x3e, &body_font_0x3e},
+    [0x3e] = &body_font_0x3e,
 
     /* Character: '?' */
-    {0x3f, &body_font_0x3f},
+    [0x3f] = &body_font_0x3f,
 
     /* Character: '\x0040' */
-    {0x40, &body_font_0x40},
+    [0x40] = &body_font_0x40,
 
     /* Character: 'A' */
-    {0x41, &body_font_0x41},
+    [0x41] = &body_font_0x41,
 
     /* Character: 'B' */
-    {0x42, &body_font_0x42},
+    [0x42] = &body_font_0x42,
 
     /* Character: 'C' */
-    {0x43, &body_font_0x43},
+    [0x43] = &body_font_0x43,
 
     /* Character: 'D' */
-    {0x44, &body_font_0x44},
+    [0x44] = &body_font_0x44,
 
     /* Character: 'E' */
-    {0x45, &body_font_0x45},
+    [0x45] = &body_font_0x45,
 
     /* Character: 'F' */
-    {0x46, &body_font_0x46},
+    [0x46] = &body_font_0x46,
 
     /* Character: 'G' */
-    {0x47, &body_font_0x47},
+    [0x47] = &body_font_0x47,
 
     /* Character: 'H' */
-    {0x48, &body_font_0x48},
+    [0x48] = &body_font_0x48,
 
     /* Character: 'I' */
-    {0x49, &body_font_0x49},
+    [0x49] = &body_font_0x49,
 
     /* Character: 'J' */
-    {0x4a, &body_font_0x4a},
+    [0x4a] = &body_font_0x4a,
 
     /* Character: 'K' */
-    {0x4b, &body_font_0x4b},
+    [0x4b] = &body_font_0x4b,
 
     /* Character: 'L' */
-    {0x4c, &body_font_0x4c},
+    [0x4c] = &body_font_0x4c,
 
     /* Character: 'M' */
-    {0x4d, &body_font_0x4d},
+    [0x4d] = &body_font_0x4d,
 
     /* Character: 'N' */
-    {0x4e, &body_font_0x4e},
+    [0x4e] = &body_font_0x4e,
 
     /* Character: 'O' */
-    {0x4f, &body_font_0x4f},
+    [0x4f] = &body_font_0x4f,
 
     /* Character: 'P' */
-    {0x50, &body_font_0x50},
+    [0x50] = &body_font_0x50,
 
     /* Character: 'Q' */
-    {0x51, &body_font_0x51},
+    [0x51] = &body_font_0x51,
 
     /* Character: 'R' */
-    {0x52, &body_font_0x52},
+    [0x52] = &body_font_0x52,
 
     /* Character: 'S' */
-    {0x53, &body_font_0x53},
+    [0x53] = &body_font_0x53,
 
     /* Character: 'T' */
-    {0x54, &body_font_0x54},
+    [0x54] = &body_font_0x54,
 
     /* Character: 'U' */
-    {0x55, &body_font_0x55},
+    [0x55] = &body_font_0x55,
 
     /* Character: 'V' */
-    {0x56, &body_font_0x56},
+    [0x56] = &body_font_0x56,
 
     /* Character: 'W' */
-    {0x57, &body_font_0x57},
+    [0x57] = &body_font_0x57,
 
     /* Character: 'X' */
-    {0x58, &body_font_0x58},
+    [0x58] = &body_font_0x58,
 
     /* Character: 'Y' */
-    {0x59, &body_font_0x59},
+    [0x59] = &body_font_0x59,
 
     /* Character: 'Z' */
-    {0x5a, &body_font_0x5a},
+    [0x5a] = &body_font_0x5a,
 
     /* Character: '[' */
-    {0x5b, &body_font_0x5b},
+    [0x5b] = &body_font_0x5b,
 
     /* Character: '\' */
-    {0x5c, &body_font_0x5c},
+    [0x5c] = &body_font_0x5c,
 
     /* Character: ']' */
-    {0x5d, &body_font_0x5d},
+    [0x5d] = &body_font_0x5d,
 
     /* Character: '^' */
-    {0x5e, &body_font_0x5e},
+    [0x5e] = &body_font_0x5e,
 
     /* Character: '_' */
-    {0x5f, &body_font_0x5f},
+    [0x5f] = &body_font_0x5f,
 
     /* Character: '`' */
-    {0x60, &body_font_0x60},
+    [0x60] = &body_font_0x60,
 
     /* Character: 'a' */
-    {0x61, &body_font_0x61},
+    [0x61] = &body_font_0x61,
 
     /* Character: 'b' */
-    {0x62, &body_font_0x62},
+    [0x62] = &body_font_0x62,
 
     /* Character: 'c' */
-    {0x63, &body_font_0x63},
+    [0x63] = &body_font_0x63,
 
     /* Character: 'd' */
-    {0x64, &body_font_0x64},
+    [0x64] = &body_font_0x64,
 
     /* Character: 'e' */
-    {0x65, &body_font_0x65},
+    [0x65] = &body_font_0x65,
 
     /* Character: 'f' */
-    {0x66, &body_font_0x66},
+    [0x66] = &body_font_0x66,
 
     /* Character: 'g' */
-    {0x67, &body_font_0x67},
+    [0x67] = &body_font_0x67,
 
     /* Character: 'h' */
-    {0x68, &body_font_0x68},
+    [0x68] = &body_font_0x68,
 
     /* Character: 'i' */
-    {0x69, &body_font_0x69},
+    [0x69] = &body_font_0x69,
 
     /* Character: 'j' */
-    {0x6a, &body_font_0x6a},
+    [0x6a] = &body_font_0x6a,
 
     /* Character: 'k' */
-    {0x6b, &body_font_0x6b},
+    [0x6b] = &body_font_0x6b,
 
     /* Character: 'l' */
-    {0x6c, &body_font_0x6c},
+    [0x6c] = &body_font_0x6c,
 
     /* Character: 'm' */
-    {0x6d, &body_font_0x6d},
+    [0x6d] = &body_font_0x6d,
 
     /* Character: 'n' */
-    {0x6e, &body_font_0x6e},
+    [0x6e] = &body_font_0x6e,
 
     /* Character: 'o' */
-    {0x6f, &body_font_0x6f},
+    [0x6f] = &body_font_0x6f,
 
     /* Character: 'p' */
-    {0x70, &body_font_0x70},
+    [0x70] = &body_font_0x70,
 
     /* Character: 'q' */
-    {0x71, &body_font_0x71},
+    [0x71] = &body_font_0x71,
 
     /* Character: 'r' */
-    {0x72, &body_font_0x72},
+    [0x72] = &body_font_0x72,
 
     /* Character: 's' */
-    {0x73, &body_font_0x73},
+    [0x73] = &body_font_0x73,
 
     /* Character: 't' */
-    {0x74, &body_font_0x74},
+    [0x74] = &body_font_0x74,
 
     /* Character: 'u' */
-    {0x75, &body_font_0x75},
+    [0x75] = &body_font_0x75,
 
     /* Character: 'v' */
-    {0x76, &body_font_0x76},
+    [0x76] = &body_font_0x76,
 
     /* Character: 'w' */
-    {0x77, &body_font_0x77},
+    [0x77] = &body_font_0x77,
 
     /* Character: 'x' */
-    {0x78, &body_font_0x78},
+    [0x78] = &body_font_0x78,
 
     /* Character: 'y' */
-    {0x79, &body_font_0x79},
+    [0x79] = &body_font_0x79,
 
     /* Character: 'z' */
-    {0x7a, &body_font_0x7a},
+    [0x7a] = &body_font_0x7a,
 
     /* Character: '{' */
-    {0x7b, &body_font_0x7b},
+    [0x7b] = &body_font_0x7b,
 
     /* Character: '|' */
-    {0x7c, &body_font_0x7c},
+    [0x7c] = &body_font_0x7c,
 
     /* Character: '}' */
-    {0x7d, &body_font_0x7d},
+    [0x7d] = &body_font_0x7d,
 
     /* Character: '~' (we use this one for checkmark) */
-    {0x7e, &body_font_0x7e}
+    [0x7e] = &body_font_0x7e,
 
 };
 
-static const Font body_font = { sizeof(body_font_array)/sizeof(body_font_array[0]),
-                                10, body_font_array };
+static const Font body_font = { 10, body_font_array };
 
 
 /*
@@ -3788,12 +3785,11 @@ const Font *get_body_font(void)
  */
 const CharacterImage *font_get_char(const Font *font, char c)
 {
-    for (int i = 0; i < font->length; i++)
+    unsigned char code = (unsigned char)c;
+
+    if (code < FONT_GLYPHS && font->glyphs[code])
     {
-        if(font->characters[ i ].code == c)
-        {
-            return font->characters[ i ].image;
-        }
+        return font->glyphs[code];
     }
 
     return &sadface_9x10;
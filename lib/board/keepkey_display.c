@@ -283,6 +283,10 @@ Canvas *display_canvas_init(void)
     canvas.width    = KEEPKEY_DISPLAY_WIDTH;
     canvas.height   = KEEPKEY_DISPLAY_HEIGHT;
     canvas.dirty    = false;
+    canvas.dirty_x0 = 0;
+    canvas.dirty_y0 = 0;
+    canvas.dirty_x1 = 0;
+    canvas.dirty_y1 = 0;
 
     return &canvas;
 }
@@ -305,9 +309,35 @@ void display_set_dump_callback(DumpDisplayCallback d) {
     DumpDisplay = d;
 }
 
+/*
+ * display_set_window() - Restrict GRAM writes to a window of the panel
+ *
+ * INPUT
+ *     - row_start: first row
+ *     - row_end: last row (inclusive)
+ *     - col_start: first column, in units of 4 pixels
+ *     - col_end: last column (inclusive), in units of 4 pixels
+ * OUTPUT
+ *     none
+ */
+static void display_set_window(uint8_t row_start, uint8_t row_end,
+                               uint8_t col_start, uint8_t col_end)
+{
+    display_write_reg((uint8_t)0x75);
+    display_write_ram(START_ROW + row_start);
+    display_write_ram(START_ROW + row_end);
+    display_write_reg((uint8_t)0x15);
+    display_write_ram(START_COL + col_start);
+    display_write_ram(START_COL + col_end);
+}
+
 /*
  * display_refresh() - Refresh display
  *
+ * Only the dirty rectangle of the canvas is sent to the panel. Columns are
+ * addressed in units of 4 pixels, so the rectangle is widened to that
+ * alignment first.
+ *
  * INPUT
  *     none
  * OUTPUT
@@ -324,26 +354,54 @@ void display_refresh(void)
         return;
     }
 
+#ifdef INVERT_DISPLAY
+    /* The inverted scan order doesn't map onto a window, so push it all. */
+    display_set_window(0, canvas.height - 1, 0, (canvas.width / 4) - 1);
     display_prepare_gram_write();
 
     int num_writes = canvas.width * canvas.height;
 
-    int i;
-#ifdef INVERT_DISPLAY
-
-    for(i = num_writes; i > 0; i -= 2)
+    for(int i = num_writes; i > 0; i -= 2)
     {
         uint8_t v = (0xF0 & canvas.buffer[ i ]) | (canvas.buffer[ i - 1 ] >> 4);
+        display_write_ram(v);
+    }
 #else
+    uint16_t x0 = canvas.dirty_x0, x1 = canvas.dirty_x1;
+    uint16_t y0 = canvas.dirty_y0, y1 = canvas.dirty_y1;
 
-    for(i = 0; i < num_writes; i += 2)
+    if (x0 >= x1 || y0 >= y1 || x1 > canvas.width || y1 > canvas.height)
     {
-        uint8_t v = (0xF0 & canvas.buffer[ i ]) | (canvas.buffer[ i + 1 ] >> 4);
-#endif
-        display_write_ram(v);
+        /* Marked dirty without a usable rectangle: refresh everything. */
+        x0 = 0;
+        y0 = 0;
+        x1 = canvas.width;
+        y1 = canvas.height;
+    }
+
+    x0 &= ~3;
+    x1 = (x1 + 3) & ~3;
+
+    display_set_window(y0, y1 - 1, x0 / 4, (x1 / 4) - 1);
+    display_prepare_gram_write();
+
+    for(uint16_t y = y0; y < y1; y++)
+    {
+        const uint8_t *row = &canvas.buffer[ y * canvas.width ];
+
+        for(uint16_t x = x0; x < x1; x += 2)
+        {
+            uint8_t v = (0xF0 & row[ x ]) | (row[ x + 1 ] >> 4);
+            display_write_ram(v);
+        }
     }
+#endif
 
     canvas.dirty = false;
+    canvas.dirty_x0 = 0;
+    canvas.dirty_y0 = 0;
+    canvas.dirty_x1 = 0;
+    canvas.dirty_y1 = 0;
 }
 
 /*
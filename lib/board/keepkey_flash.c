@@ -100,6 +100,10 @@ bool flash_chk_status(void)
  */
 void flash_erase_word(Allocation group)
 {
+    if (group == FLASH_APP) {
+        memory_firmware_invalidate();
+    }
+
 #ifndef EMULATOR
     const FlashSector* s = flash_sector_map;
     while(s->use != FLASH_INVALID)
@@ -125,6 +129,10 @@ void flash_erase_word(Allocation group)
  */
 bool flash_write_word(Allocation group, uint32_t offset, uint32_t len, const uint8_t *data)
 {
+    if (group == FLASH_APP) {
+        memory_firmware_invalidate();
+    }
+
 #ifndef EMULATOR
     bool retval = true;
     uint32_t start = flash_write_helper(group);
@@ -185,6 +193,10 @@ fww_exit:
  */
 bool flash_write(Allocation group, uint32_t offset, uint32_t len, const uint8_t *data)
 {
+    if (group == FLASH_APP) {
+        memory_firmware_invalidate();
+    }
+
 #ifndef EMULATOR
     bool retval = true;
     uint32_t start = flash_write_helper(group);
@@ -184,39 +184,115 @@ int memory_bootloader_hash(uint8_t *hash, bool cached)
     return SHA256_DIGEST_LENGTH;
 }
 
+/* Multiple of the SHA-256 block size, so that neither context has to buffer */
+#define MEASURE_CHUNK_LEN 1024
+
+static FirmwareMeasurement firmware_measurement;
+static bool firmware_measurement_valid = false;
+
 /*
- * memory_firmware_hash() - SHA256 hash of firmware (meta and application)
+ * memory_measure() - Hash a firmware image in one pass
  *
  * INPUT
- *     - hash: buffer to be filled with hash
+ *     - meta: firmware metadata
+ *     - app: application image
+ *     - code_len: length of application image
+ *     - m: buffer to be filled with digests
  * OUTPUT
  *     none
  */
-int memory_firmware_hash(uint8_t *hash)
+void memory_measure(const uint8_t *meta, const uint8_t *app, uint32_t code_len,
+                    FirmwareMeasurement *m)
+{
+    SHA256_CTX app_ctx, image_ctx;
+
+    sha256_Init(&app_ctx);
+    sha256_Init(&image_ctx);
+    sha256_Update(&image_ctx, (const uint8_t *)META_MAGIC_STR, META_MAGIC_SIZE);
+    sha256_Update(&image_ctx, meta + META_MAGIC_SIZE,
+                  FLASH_META_DESC_LEN - META_MAGIC_SIZE);
+
+    /* Feed both digests from the same window, so flash is read once */
+    for (uint32_t offset = 0; offset < code_len; offset += MEASURE_CHUNK_LEN) {
+        uint32_t len = code_len - offset < MEASURE_CHUNK_LEN
+                     ? code_len - offset : MEASURE_CHUNK_LEN;
+        sha256_Update(&app_ctx, app + offset, len);
+        sha256_Update(&image_ctx, app + offset, len);
+    }
+
+    m->code_len = code_len;
+    sha256_Final(&app_ctx, m->fingerprint);
+    sha256_Final(&image_ctx, m->firmware_hash);
+}
+
+/*
+ * memory_firmware_measurement() - Cached digests of firmware in flash
+ *
+ * INPUT
+ *     none
+ * OUTPUT
+ *     measurement, or NULL if there is no firmware to measure
+ */
+const FirmwareMeasurement *memory_firmware_measurement(void)
 {
 #ifndef EMULATOR
-    SHA256_CTX ctx;
     uint32_t codelen = *((uint32_t *)FLASH_META_CODELEN);
 
-    if(codelen <= FLASH_APP_LEN)
+    if(codelen > FLASH_APP_LEN)
     {
-        sha256_Init(&ctx);
-        sha256_Update(&ctx, (const uint8_t *)META_MAGIC_STR, META_MAGIC_SIZE);
-        sha256_Update(&ctx, (const uint8_t *)FLASH_META_CODELEN,
-                      FLASH_META_DESC_LEN - META_MAGIC_SIZE);
-        sha256_Update(&ctx, (const uint8_t *)FLASH_APP_START, codelen);
-        sha256_Final(&ctx, hash);
-        return SHA256_DIGEST_LENGTH;
+        return NULL;
     }
-    else
+
+    if(!firmware_measurement_valid || firmware_measurement.code_len != codelen)
     {
-        return 0;
+        memory_measure((const uint8_t *)FLASH_META_START,
+                       (const uint8_t *)FLASH_APP_START, codelen,
+                       &firmware_measurement);
+        firmware_measurement_valid = true;
     }
+
+    return &firmware_measurement;
 #else
-    return 0;
+    return NULL;
 #endif
 }
 
+/*
+ * memory_firmware_invalidate() - Drop cached firmware digests, to be called
+ * whenever application flash changes
+ *
+ * INPUT
+ *     none
+ * OUTPUT
+ *     none
+ */
+void memory_firmware_invalidate(void)
+{
+    firmware_measurement_valid = false;
+    memset(&firmware_measurement, 0, sizeof(firmware_measurement));
+}
+
+/*
+ * memory_firmware_hash() - SHA256 hash of firmware (meta and application)
+ *
+ * INPUT
+ *     - hash: buffer to be filled with hash
+ * OUTPUT
+ *     none
+ */
+int memory_firmware_hash(uint8_t *hash)
+{
+    const FirmwareMeasurement *m = memory_firmware_measurement();
+
+    if(!m)
+    {
+        return 0;
+    }
+
+    memcpy(hash, m->firmware_hash, SHA256_DIGEST_LENGTH);
+    return SHA256_DIGEST_LENGTH;
+}
+
 /*
  * memory_storage_hash() - SHA256 hash of storage area
  *
@@ -94,43 +94,161 @@ const pb_field_t *message_fields(MessageMapType type, MessageType msg_id,
     return NULL;
 }
 
+/* How long the host may take to send the next report of a message */
+#define MSG_STREAM_TIMEOUT_MS   5000
+
 /*
- * pb_parse() - Process USB message by protocol buffer
+ * Receive state for the message being streamed into the decoder. Reports
+ * after the first are pulled in by msg_stream_read() as the decoder asks for
+ * them, so the message is never reassembled in RAM.
+ */
+typedef struct {
+    MessageMapType type;
+    const uint8_t *frame;    //< Unread payload of the current report.
+    size_t frame_left;       //< Bytes left in frame.
+    uint32_t msg_left;       //< Bytes of the message not yet read.
+    bool waiting;            //< msg_stream_read() is polling for a report.
+    bool failed;             //< A malformed report ended the stream.
+    bool timed_out;          //< The host stopped sending part way through.
+} MsgStream;
+
+static MsgStream msg_stream;
+static uint8_t msg_stream_report[64];
+static msg_stream_poll_t msg_stream_poll = usbPoll;
+static msg_stream_clock_t msg_stream_clock = timer_ms;
+
+/*
+ * msg_stream_feed() - Hand the next report of a streamed message to the decoder
  *
  * INPUT
- *     - entry: pointer to message entry
- *     - msg: pointer to received message buffer
- *     - msg_size: size of message
+ *     - buf: pointer to received report
+ *     - length: length of report
+ *     - type: interface the report arrived on (normal or debug)
+ * OUTPUT
+ *     none
+ */
+static void msg_stream_feed(const uint8_t *buf, size_t length, MessageMapType type)
+{
+    /* Only continuations of the message being decoded are accepted */
+    if (type != msg_stream.type) {
+        (*msg_failure)(FailureType_Failure_UnexpectedMessage,
+                       "Another message is being received");
+        return;
+    }
+
+    msg_stream.waiting = false;
+
+    if (length < 1 + 2 + 2 + 4 || length > sizeof(msg_stream_report) ||
+        buf[0] != '?') {
+        msg_stream.failed = true;
+        return;
+    }
+
+    memcpy(msg_stream_report, &buf[1], length - 1);
+    msg_stream.frame = msg_stream_report;
+    msg_stream.frame_left = length - 1;
+}
+
+/*
+ * msg_stream_read() - pb_istream_t callback reading a message across reports
+ *
+ * INPUT
+ *     - stream: stream being decoded, whose state is the MsgStream
  *     - buf: pointer to destination buffer
+ *     - count: number of bytes to read
+ * OUTPUT
+ *     true/false whether count bytes were read
+ */
+static bool msg_stream_read(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+    MsgStream *ms = (MsgStream *)stream->state;
+
+    while (count > 0) {
+        if (ms->failed) {
+            return false;
+        }
+
+        if (ms->frame_left == 0) {
+            /* Poll from within the handler, as tiny messages do, until the
+             * host sends the next report. Give up if it stops, so that the
+             * main loop gets back to auto-lock and the screensaver. */
+            uint32_t start = (*msg_stream_clock)();
+            ms->waiting = true;
+            while (ms->waiting) {
+                (*msg_stream_poll)();
+
+                if (ms->waiting &&
+                    (*msg_stream_clock)() - start > MSG_STREAM_TIMEOUT_MS) {
+                    ms->waiting = false;
+                    ms->failed = true;
+                    ms->timed_out = true;
+                }
+            }
+            continue;
+        }
+
+        size_t n = MIN(count, ms->frame_left);
+        memcpy(buf, ms->frame, n);
+        buf += n;
+        count -= n;
+        ms->frame += n;
+        ms->frame_left -= n;
+        ms->msg_left -= MIN(n, ms->msg_left);
+    }
+
+    return true;
+}
+
+/*
+ * msg_stream_skip() - Read and discard the rest of a streamed message
+ *
+ *     Used when decoding stops early, so that the remaining reports of the
+ *     message aren't mistaken for the start of the next one. This covers
+ *     bytes already claimed by a substream that the decoder gave up on.
+ *
+ * INPUT
+ *     - stream: stream being decoded, whose state is the MsgStream
  * OUTPUT
- *     true/false whether protocol buffers were parsed successfully
+ *     none
  */
-static bool pb_parse(const MessagesMap_t *entry, uint8_t *msg, uint32_t msg_size,
-                     uint8_t *buf)
+static void msg_stream_skip(pb_istream_t *stream)
 {
-    pb_istream_t stream = pb_istream_from_buffer(msg, msg_size);
-    return pb_decode(&stream, entry->fields, buf);
+    MsgStream *ms = (MsgStream *)stream->state;
+    pb_byte_t discard[16];
+
+    while (ms->msg_left > 0) {
+        if (!msg_stream_read(stream, discard, MIN(sizeof(discard), ms->msg_left))) {
+            return;
+        }
+    }
 }
 
 /*
- * dispatch() - Process received message and jump to corresponding process function
+ * dispatch() - Decode message from stream and jump to corresponding process
+ * function
  *
  * INPUT
  *     - entry: pointer to message entry
- *     - msg: pointer to received message buffer
- *     - msg_size: size of message
+ *     - stream: stream positioned at the start of the message
  * OUTPUT
  *     none
  *
  */
-static void dispatch(const MessagesMap_t *entry, uint8_t *msg, uint32_t msg_size)
+static void dispatch(const MessagesMap_t *entry, pb_istream_t *stream)
 {
     static uint8_t decode_buffer[MAX_DECODE_SIZE] __attribute__((aligned(4)));
     memset(decode_buffer, 0, sizeof(decode_buffer));
 
-    if (!pb_parse(entry, msg, msg_size, decode_buffer)) {
-        (*msg_failure)(FailureType_Failure_UnexpectedMessage,
-                       "Could not parse protocol buffer message");
+    if (!pb_decode(stream, entry->fields, decode_buffer)) {
+        msg_stream_skip(stream);
+
+        if (((MsgStream *)stream->state)->timed_out) {
+            (*msg_failure)(FailureType_Failure_UnexpectedMessage,
+                           "Timed out waiting for message");
+        } else {
+            (*msg_failure)(FailureType_Failure_UnexpectedMessage,
+                           "Could not parse protocol buffer message");
+        }
         return;
     }
 
@@ -167,36 +285,6 @@ static void raw_dispatch(const MessagesMap_t *entry, const uint8_t *msg, uint32_
     }
 }
 
-#if !defined(__has_builtin)
-#  define __has_builtin(X) 0
-#endif
-#if __has_builtin(__builtin_add_overflow)
-#  define check_uadd_overflow(A, B, R) \
-    ({ \
-        typeof(A) __a = (A); \
-        typeof(B) __b = (B); \
-        typeof(R) __r = (R); \
-        (void)(&__a == &__b && "types must match"); \
-        (void)(&__a == __r && "types must match"); \
-        _Static_assert(0 < (typeof(A))-1, "types must be unsigned"); \
-        __builtin_add_overflow((A), (B), (R)); \
-    })
-#else
-#  define check_uadd_overflow(A, B, R) \
-    ({ \
-        typeof(A) __a = (A); \
-        typeof(B) __b = (B); \
-        typeof(R) __r = (R); \
-        (void)(&__a == &__b); \
-        (void)(&__a == __r); \
-        (void)(&__a == &__b && "types must match"); \
-        (void)(&__a == __r && "types must match"); \
-        _Static_assert(0 < (typeof(A))-1, "types must be unsigned"); \
-        *__r = __a + __b; \
-        *__r < __a; \
-    })
-#endif
-
 /// Common helper that handles USB messages from host
 void usb_rx_helper(const uint8_t *buf, size_t length, MessageMapType type)
 {
@@ -204,15 +292,11 @@ void usb_rx_helper(const uint8_t *buf, size_t length, MessageMapType type)
 
     static uint16_t msgId;
     static uint32_t msgSize;
-    static uint8_t msg[MAX_FRAME_SIZE];
-    static size_t cursor; //< Index into msg where the current frame is to be written.
     static const MessagesMap_t *entry;
 
     if (firstFrame) {
         msgId = 0xffff;
         msgSize = 0;
-        memset(msg, 0, sizeof(msg));
-        cursor = 0;
         entry = NULL;
     }
 
@@ -238,11 +322,8 @@ void usb_rx_helper(const uint8_t *buf, size_t length, MessageMapType type)
     size_t frameSize;
 
     if (firstFrame) {
-        // Reset the buffer that we're writing fragments into.
-        memset(msg, 0, sizeof(msg));
-
-        // Then fish out the id / size, which are big-endian uint16 /
-        // uint32's respectively.
+        // Fish out the id / size, which are big-endian uint16 / uint32's
+        // respectively.
         msgId = buf[4] | ((uint16_t)buf[3]) << 8;
         msgSize =    buf[8]        |
           ((uint32_t)buf[7]) <<  8 |
@@ -252,9 +333,6 @@ void usb_rx_helper(const uint8_t *buf, size_t length, MessageMapType type)
         // Determine callback handler and message map type.
         entry = message_map_entry(type, msgId, IN_MSG);
 
-        // And reset the cursor.
-        cursor = 0;
-
         // Then take note of the fragment boundaries.
         frame = &buf[9];
         frameSize = MIN(length - 9, msgSize);
@@ -280,32 +358,34 @@ void usb_rx_helper(const uint8_t *buf, size_t length, MessageMapType type)
         return;
     }
 
-    size_t end;
-    if (check_uadd_overflow(cursor, frameSize, &end) || sizeof(msg) < end) {
+    if (MAX_FRAME_SIZE < msgSize) {
         (*msg_failure)(FailureType_Failure_UnexpectedMessage, "Malformed message");
         goto reset;
     }
 
-    // Copy content to frame buffer.
-    memcpy(&msg[cursor], frame, frameSize);
-
-    // Advance the cursor.
-    cursor = end;
-
-    // Only parse and message map if all segments have been buffered.
-    bool last_segment = cursor >= msgSize;
-    if (!last_segment) {
-        firstFrame = false;
-        return;
-    }
-
-    dispatch(entry, msg, msgSize);
+    // Decode straight out of the reports, starting with the rest of this one.
+    // The stream pulls in the remaining reports itself.
+    msg_stream.type = type;
+    msg_stream.frame = frame;
+    msg_stream.frame_left = frameSize;
+    msg_stream.msg_left = msgSize;
+    msg_stream.waiting = false;
+    msg_stream.failed = false;
+    msg_stream.timed_out = false;
+
+    pb_istream_t stream = {
+        .callback = &msg_stream_read,
+        .state = &msg_stream,
+        .bytes_left = msgSize,
+    };
+    dispatch(entry, &stream);
+
+    memset(&msg_stream, 0, sizeof(msg_stream));
+    memset(msg_stream_report, 0, sizeof(msg_stream_report));
 
 reset:
     msgId = 0xffff;
     msgSize = 0;
-    memset(msg, 0, sizeof(msg));
-    cursor = 0;
     firstFrame = true;
     entry = NULL;
 }
@@ -395,7 +475,9 @@ static void msg_read_tiny(const uint8_t *msg, size_t len) {
 
 void handle_usb_rx(const void *msg, size_t len)
 {
-    if (msg_tiny_flag) {
+    if (msg_stream.waiting) {
+        msg_stream_feed(msg, len, NORMAL_MSG);
+    } else if (msg_tiny_flag) {
         msg_read_tiny(msg, len);
     } else {
         usb_rx_helper(msg, len, NORMAL_MSG);
@@ -405,7 +487,9 @@ void handle_usb_rx(const void *msg, size_t len)
 #if DEBUG_LINK
 void handle_debug_usb_rx(const void *msg, size_t len)
 {
-    if (msg_tiny_flag) {
+    if (msg_stream.waiting) {
+        msg_stream_feed(msg, len, DEBUG_MSG);
+    } else if (msg_tiny_flag) {
         msg_read_tiny(msg, len);
     } else {
         usb_rx_helper(msg, len, DEBUG_MSG);
@@ -477,6 +561,23 @@ void set_msg_failure_handler(msg_failure_t failure_func)
     msg_failure = failure_func;
 }
 
+/*
+ * set_msg_stream_poll_handler() - Setup how a streamed message waits for the
+ * next report
+ *
+ * INPUT
+ *     - poll_func: called until the next report arrives (usbPoll if NULL)
+ *     - clock_func: millisecond clock for the timeout (timer_ms if NULL)
+ * OUTPUT
+ *     none
+ */
+void set_msg_stream_poll_handler(msg_stream_poll_t poll_func,
+                                 msg_stream_clock_t clock_func)
+{
+    msg_stream_poll = poll_func ? poll_func : usbPoll;
+    msg_stream_clock = clock_func ? clock_func : timer_ms;
+}
+
 /*
  * set_msg_debug_link_get_state_handler() - Setup usb message debug link get state handler
  *
@@ -17,6 +17,7 @@
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "trezor/crypto/bignum.h"
 #include "trezor/crypto/sha2.h"
 #include "trezor/crypto/ecdsa.h"
 #include "trezor/crypto/secp256k1.h"
@@ -25,6 +26,7 @@
 #include "keepkey/board/pubkeys.h"
 
 #include <stdint.h>
+#include <string.h>
 
 volatile const uint8_t valid_pubkey[PUBKEYS] = {
     0xff,
@@ -34,14 +36,120 @@ volatile const uint8_t valid_pubkey[PUBKEYS] = {
     0xff,
 };
 
-int signatures_ok(void)
+/* signatures_verify_batch() - Verify signatures that share a digest
+ *
+ * Follows ecdsa_verify_digest(), except that s^-1 for every signature comes
+ * from a single bn_inverse() of the product of all of the s values
+ * (Montgomery's trick), which is the most expensive step after the point
+ * multiplications.
+ *
+ * INPUT
+ *     - digest: signed digest
+ *     - pubkeys: uncompressed public keys, one per signature
+ *     - sigs: r || s signatures
+ *     - count: number of signatures, at most SIGNATURES
+ * OUTPUT
+ *     mask of the signatures that failed to verify
+ */
+uint32_t signatures_verify_batch(const uint8_t digest[32],
+                                 const uint8_t *const pubkeys[],
+                                 const uint8_t *const sigs[], size_t count)
 {
-    uint32_t codelen = *((uint32_t *)FLASH_META_CODELEN);
-    uint8_t sigindex1, sigindex2, sigindex3, firmware_fingerprint[32];
+    const ecdsa_curve *curve = &secp256k1;
+    bignum256 z, r[SIGNATURES], s_inv[SIGNATURES], prefix[SIGNATURES], inv, s;
+    uint32_t failed = 0;
+    size_t i;
+
+    if(count == 0 || count > SIGNATURES) { return (1u << SIGNATURES) - 1; }
+
+    bn_read_be(digest, &z);
+
+    /* Range check r and s, and keep the running products of the s values */
+    for(i = 0; i < count; i++)
+    {
+        bn_read_be(sigs[i], &r[i]);
+        bn_read_be(sigs[i] + 32, &s_inv[i]);
+
+        if(bn_is_zero(&r[i]) || bn_is_zero(&s_inv[i]) ||
+           !bn_is_less(&r[i], &curve->order) || !bn_is_less(&s_inv[i], &curve->order))
+        {
+            failed |= 1u << i;
+            bn_one(&s_inv[i]);  /* Keep the product invertible */
+        }
+
+        prefix[i] = s_inv[i];
+        if(i > 0)
+        {
+            bn_multiply(&prefix[i - 1], &prefix[i], &curve->order);
+            bn_mod(&prefix[i], &curve->order);
+        }
+    }
+
+    /* inv = (s_0 * ... * s_{count-1})^-1, then peel off one s at a time */
+    inv = prefix[count - 1];
+    bn_inverse(&inv, &curve->order);
+    for(i = count; i-- > 0;)
+    {
+        s = s_inv[i];
+        if(i > 0)
+        {
+            s_inv[i] = prefix[i - 1];
+            bn_multiply(&inv, &s_inv[i], &curve->order);
+            bn_mod(&s_inv[i], &curve->order);
+            bn_multiply(&s, &inv, &curve->order);
+            bn_mod(&inv, &curve->order);
+        }
+        else
+        {
+            s_inv[i] = inv;
+        }
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        curve_point pub, res;
+        bignum256 u1, u2;
+
+        if(failed & (1u << i)) { continue; }
+
+        if(!ecdsa_read_pubkey(curve, pubkeys[i], &pub))
+        {
+            failed |= 1u << i;
+            continue;
+        }
+
+        u1 = z;                                       /* z * s^-1 */
+        bn_multiply(&s_inv[i], &u1, &curve->order);
+        bn_mod(&u1, &curve->order);
+        u2 = r[i];                                    /* r * s^-1 */
+        bn_multiply(&s_inv[i], &u2, &curve->order);
+        bn_mod(&u2, &curve->order);
+
+        if(bn_is_zero(&u1))
+        {
+            failed |= 1u << i;
+            continue;
+        }
 
-    sigindex1 = *((uint8_t *)FLASH_META_SIGINDEX1);
-    sigindex2 = *((uint8_t *)FLASH_META_SIGINDEX2);
-    sigindex3 = *((uint8_t *)FLASH_META_SIGINDEX3);
+        scalar_multiply(curve, &u1, &res);
+        point_multiply(curve, &u2, &pub, &pub);
+        point_add(curve, &pub, &res);
+        bn_mod(&res.x, &curve->order);
+
+        if(!bn_is_equal(&res.x, &r[i])) { failed |= 1u << i; }
+    }
+
+    return failed;
+}
+
+int signatures_check(const app_meta_td *meta, const uint8_t fingerprint[32])
+{
+    uint8_t sigindex1, sigindex2, sigindex3;
+    uint32_t failed;
+
+    sigindex1 = meta->sig_index1;
+    sigindex2 = meta->sig_index2;
+    sigindex3 = meta->sig_index3;
 
     if(sigindex1 < 1 || sigindex1 > PUBKEYS) { return SIG_FAIL; }  /* Invalid index */
     if(sigindex2 < 1 || sigindex2 > PUBKEYS) { return SIG_FAIL; }  /* Invalid index */
@@ -55,22 +163,24 @@ int signatures_ok(void)
     if(0xff != valid_pubkey[sigindex2 - 1]) { return KEY_EXPIRED; } /* Expired signing key */
     if(0xff != valid_pubkey[sigindex3 - 1]) { return KEY_EXPIRED; } /* Expired signing key */
 
-    sha256_Raw((uint8_t *)FLASH_APP_START, codelen, firmware_fingerprint);
-
-    if(ecdsa_verify_digest(&secp256k1, pubkey[sigindex1 - 1], (uint8_t *)FLASH_META_SIG1,
-                           firmware_fingerprint) != 0) {   /* Failure */
-        return SIG_FAIL;
-    }
+    const uint8_t *const keys[SIGNATURES] = {
+        pubkey[sigindex1 - 1], pubkey[sigindex2 - 1], pubkey[sigindex3 - 1]
+    };
+    const uint8_t *const sigs[SIGNATURES] = { meta->sig1, meta->sig2, meta->sig3 };
 
-    if(ecdsa_verify_digest(&secp256k1, pubkey[sigindex2 - 1], (uint8_t *)FLASH_META_SIG2,
-                           firmware_fingerprint) != 0) {   /* Failure */
-        return SIG_FAIL;
-    }
+    failed = signatures_verify_batch(fingerprint, keys, sigs, SIGNATURES);
 
-    if(ecdsa_verify_digest(&secp256k1, pubkey[sigindex3 - 1], (uint8_t *)FLASH_META_SIG3,
-                           firmware_fingerprint) != 0) {   /* Failure */
-        return KEY_EXPIRED;
-    }
+    if(failed & 0x3) { return SIG_FAIL; }     /* Failure */
+    if(failed & 0x4) { return KEY_EXPIRED; }  /* Failure */
 
     return SIG_OK;
 }
+
+int signatures_ok(void)
+{
+    /* Shared with memory_firmware_hash(), so flash is only hashed once */
+    const FirmwareMeasurement *measurement = memory_firmware_measurement();
+    if(!measurement) { return SIG_FAIL; }  /* Invalid code length */
+
+    return signatures_check((const app_meta_td *)FLASH_META_START, measurement->fingerprint);
+}
@@ -35,144 +35,189 @@
 #include "trezor/crypto/rand.h"
 
 #include <stddef.h>
+#include <string.h>
 
 
 static volatile uint32_t remaining_delay = UINT32_MAX;
+static volatile uint32_t elapsed_ms;
 static RunnableNode runnables[MAX_RUNNABLES];
-static RunnableQueue free_queue = {NULL, 0};
-static RunnableQueue active_queue = {NULL, 0};
+static RunnableNode *free_runnables;
+
+/*
+ * Runnables are kept in a hierarchical timer wheel indexed by the tick they
+ * expire on. Level 0 holds the next 64 ms, one slot per tick; each level
+ * above covers 64 slots of the whole level below it. On each tick only the
+ * current level 0 slot is run, and when a level wraps, the matching slot of
+ * the level above is cascaded down.
+ */
+#define WHEEL_LEVELS        4
+#define WHEEL_BITS          6
+#define WHEEL_SLOTS         (1u << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1)
+#define WHEEL_MAX_DELTA     ((1u << (WHEEL_LEVELS * WHEEL_BITS)) - 1)
+
+static RunnableNode *wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static RunnableNode *expired_runnables;
 
 
 /*
- * runnable_queue_peek() - Get pointer to head node in task manager (queue)
+ * runnable_link() - Add node to the front of a wheel slot
  *
  * INPUT
- *     - queue: head pointer to linklist (queue)
+ *     - head: slot the node is added to
+ *     - node: node to add
  * OUTPUT
- *     head node in the queue
+ *     none
  */
-static RunnableNode *runnable_queue_peek(RunnableQueue *queue)
+static void runnable_link(RunnableNode **head, RunnableNode *node)
 {
-    return(queue->head);
+    node->next = *head;
+    node->pprev = head;
+
+    if(*head != NULL)
+    {
+        (*head)->pprev = &node->next;
+    }
+
+    *head = node;
 }
 
 /*
- * runnable_queue_get() - Get the pointer to node that contains the
- * callback function (task)
+ * runnable_unlink() - Remove node from whichever slot it is in
  *
  * INPUT
- *     - queue: head pointer to linklist (queue)
- *     - callback: task function
+ *     - node: node to remove
  * OUTPUT
- *     pointer to a node containing the requested task function
+ *     none
  */
-static RunnableNode *runnable_queue_get(RunnableQueue *queue, Runnable callback)
+static void runnable_unlink(RunnableNode *node)
 {
-    RunnableNode *current = queue->head;
-    RunnableNode *result = NULL;
+    *node->pprev = node->next;
 
-    /* check queue is empty */
-    if(current != NULL)
+    if(node->next != NULL)
     {
-        if(current->runnable == callback)
-        {
-            result = current;
-            queue->head = current->next;
-        }
-        else
-        {
-            /* search through the linklist for node that contains the runnable
-               callback function */
-            RunnableNode *previous = current;
-            current = current->next;
-
-            while((current != NULL) && (result == NULL))
-            {
-                // Found the node!
-                if(current->runnable == callback)
-                {
-                    result = current;
-                    previous->next = current->next;
-                    result->next = NULL;
-                }
-
-                previous = current;
-                current = current->next;
-            }
-        }
+        node->next->pprev = node->pprev;
     }
 
-    if(result != NULL)
+    node->next = NULL;
+    node->pprev = NULL;
+}
+
+/*
+ * runnable_schedule() - Put node in the wheel slot for its expiry tick
+ *
+ * INPUT
+ *     - node: node with expires set
+ * OUTPUT
+ *     none
+ */
+static void runnable_schedule(RunnableNode *node)
+{
+    uint32_t delta = node->expires - elapsed_ms;
+    uint32_t expires = node->expires;
+    int level = 0;
+
+    /* Too far out for the wheel: park it in the last slot it can reach, and
+       the cascade will place it again from the real expiry */
+    if(delta > WHEEL_MAX_DELTA)
+    {
+        delta = WHEEL_MAX_DELTA;
+        expires = elapsed_ms + WHEEL_MAX_DELTA;
+    }
+
+    while(delta >= WHEEL_SLOTS && level < WHEEL_LEVELS - 1)
     {
-        queue->size -= 1;
+        delta >>= WHEEL_BITS;
+        level++;
     }
 
-    return(result);
+    runnable_link(&wheel[level][(expires >> (level * WHEEL_BITS)) & WHEEL_MASK],
+                  node);
 }
 
 /*
- * runnable_queue_push() - Push node to the task manger (queue)
+ * runnable_cascade() - Move a slot of an upper level down the wheel
  *
  * INPUT
- *     - queue: head pointer to the queue
- *     - node: pointer to a new node to be added
+ *     - level: level to cascade from
  * OUTPUT
  *     none
  */
-static void runnable_queue_push(RunnableQueue *queue, RunnableNode *node)
+static void runnable_cascade(int level)
 {
-#ifndef EMULATOR
-    svc_disable_interrupts();
-#endif
+    uint32_t index = (elapsed_ms >> (level * WHEEL_BITS)) & WHEEL_MASK;
+    RunnableNode *node = wheel[level][index];
+
+    wheel[level][index] = NULL;
 
-    if(queue->head != NULL)
+    while(node != NULL)
     {
-        node->next = queue->head;
+        RunnableNode *next = node->next;
+        runnable_schedule(node);
+        node = next;
     }
-    else
+}
+
+/*
+ * runnable_find() - Get the scheduled node for a callback function
+ *
+ * INPUT
+ *     - callback: task function
+ * OUTPUT
+ *     pointer to the node, or NULL when the callback isn't scheduled
+ */
+static RunnableNode *runnable_find(Runnable callback)
+{
+    for(int i = 0; i < MAX_RUNNABLES; i++)
     {
-        node->next = NULL;
+        if(runnables[i].pprev != NULL && runnables[i].runnable == callback)
+        {
+            return(&runnables[i]);
+        }
     }
 
-    queue->head = node;
-    queue->size += 1;
-
-#ifndef EMULATOR
-    svc_enable_interrupts();
-#endif
+    return(NULL);
 }
 
 /*
- * runnable_queue_pop() - Pop node from task manager (queue)
+ * runnable_free() - Return node to the free list
  *
  * INPUT
- *     - queue: head pointer to task manager
+ *     - node: unlinked node
  * OUTPUT
- *     pointer to an available node retrieved from the queue
+ *     none
  */
-static RunnableNode *runnable_queue_pop(RunnableQueue *queue)
+static void runnable_free(RunnableNode *node)
 {
-#ifndef EMULATOR
-    svc_disable_interrupts();
-#endif
+    node->runnable = NULL;
+    node->context = NULL;
+    node->next = free_runnables;
+    free_runnables = node;
+}
 
-    RunnableNode *runnable_node = queue->head;
+/*
+ * runnables_reset() - Empty the wheel and put every node on the free list
+ *
+ * INPUT
+ *     none
+ * OUTPUT
+ *     none
+ */
+static void runnables_reset(void)
+{
+    memset(wheel, 0, sizeof(wheel));
+    expired_runnables = NULL;
+    free_runnables = NULL;
 
-    if(runnable_node != NULL)
+    for(int i = 0; i < MAX_RUNNABLES; i++)
     {
-        queue->head = runnable_node->next;
-        queue->size -= 1;
+        runnables[i].pprev = NULL;
+        runnable_free(&runnables[i]);
     }
-
-#ifndef EMULATOR
-    svc_enable_interrupts();
-#endif
-
-    return(runnable_node);
 }
 
 /*
- * run_runnables() - Run task (callback function) located in task manager (queue)
+ * run_runnables() - Run tasks (callback functions) that expire on this tick
  *
  * INPUT
  *     none
@@ -181,48 +226,56 @@ static RunnableNode *runnable_queue_pop(RunnableQueue *queue)
  */
 static void run_runnables(void)
 {
-    // Do timer function work.
-    RunnableNode *runnable_node = runnable_queue_peek(&active_queue);
+    /* Cascade upper levels as the ones below them wrap */
+    for(int level = 1;
+        level < WHEEL_LEVELS &&
+        ((elapsed_ms >> ((level - 1) * WHEEL_BITS)) & WHEEL_MASK) == 0;
+        level++)
+    {
+        runnable_cascade(level);
+    }
+
+    /* Detach the current slot, so that callbacks can post and remove
+       runnables, including the ones still waiting to run here */
+    RunnableNode **slot = &wheel[0][elapsed_ms & WHEEL_MASK];
+    expired_runnables = *slot;
+    *slot = NULL;
+
+    if(expired_runnables != NULL)
+    {
+        expired_runnables->pprev = &expired_runnables;
+    }
 
-    while(runnable_node != NULL)
+    while(expired_runnables != NULL)
     {
-        RunnableNode *next = runnable_node->next;
+        RunnableNode *runnable_node = expired_runnables;
+        Runnable runnable = runnable_node->runnable;
+        void *context = runnable_node->context;
+
+        runnable_unlink(runnable_node);
 
-        if(runnable_node->remaining != 0)
+        if(runnable_node->repeating)
         {
-            runnable_node->remaining -= 1;
+            runnable_node->expires = elapsed_ms +
+                (runnable_node->period ? runnable_node->period : 1);
+            runnable_schedule(runnable_node);
         }
-
-        if(runnable_node->remaining == 0)
+        else
         {
-            if(runnable_node->runnable != NULL)
-            {
-                runnable_node->runnable(runnable_node->context);
-            }
-
-            if(runnable_node->repeating)
-            {
-                runnable_node->remaining = runnable_node->period;
-            }
-            else
-            {
-                runnable_queue_push(
-                    &free_queue,
-                    runnable_queue_get(&active_queue, runnable_node->runnable));
-            }
+            runnable_free(runnable_node);
         }
 
-        runnable_node = next;
+        if(runnable != NULL)
+        {
+            runnable(context);
+        }
     }
 }
 
 
 void kk_timer_init(void)
 {
-    for(int i = 0; i < MAX_RUNNABLES; i++)
-    {
-        runnable_queue_push(&free_queue, &runnables[ i ]);
-    }
+    runnables_reset();
 }
 
 
@@ -238,12 +291,7 @@ void kk_timer_init(void)
  */
 void timer_init(void)
 {
-    int i;
-
-    for(i = 0; i < MAX_RUNNABLES; i++)
-    {
-        runnable_queue_push(&free_queue, &runnables[ i ]);
-    }
+    runnables_reset();
 
 #ifndef EMULATOR
     // Set up the timer.
@@ -359,6 +407,8 @@ void delay_ms_with_callback(uint32_t ms, callback_func_t callback_func,
  */
 void timerisr_usr(void)
 {
+    elapsed_ms++;
+
     /* Decrement the delay */
     if(remaining_delay > 0)
     {
@@ -372,6 +422,19 @@ void timerisr_usr(void)
 #endif
 }
 
+/*
+ * timer_ms() - Milliseconds since timer_init()
+ *
+ * INPUT
+ *     none
+ * OUTPUT
+ *     tick count, which wraps after about 49 days
+ */
+uint32_t timer_ms(void)
+{
+    return elapsed_ms;
+}
+
 #ifdef EMULATOR
 void tim4_sighandler(int sig) {
     timerisr_usr();
@@ -379,30 +442,65 @@ void tim4_sighandler(int sig) {
 #endif
 
 /*
- * post_delayed() - Add delay to existing task (callback function) in task manager (queue)
+ * runnable_post() - Schedule task (callback function), replacing any earlier
+ * post of the same callback
  *
  * INPUT
  *     - callback: task function
  *     - context: pointer to task arguments
+ *     - period_ms: task repeat interval (period)
  *     - delay_ms: delay befor task starts
+ *     - repeating: whether to run again every period_ms
  * OUTPUT
  *     none
  */
-void post_delayed(Runnable callback, void *context, uint32_t delay_ms)
+static void runnable_post(Runnable callback, void *context, uint32_t period_ms,
+                          uint32_t delay_ms, bool repeating)
 {
-    RunnableNode *runnable_node = runnable_queue_get(&active_queue, callback);
+#ifndef EMULATOR
+    svc_disable_interrupts();
+#endif
+
+    RunnableNode *runnable_node = runnable_find(callback);
 
-    if(runnable_node == NULL)
+    if(runnable_node != NULL)
+    {
+        runnable_unlink(runnable_node);
+    }
+    else if(free_runnables != NULL)
     {
-        runnable_node = runnable_queue_pop(&free_queue);
+        runnable_node = free_runnables;
+        free_runnables = runnable_node->next;
     }
 
-    runnable_node->runnable     = callback;
-    runnable_node->context      = context;
-    runnable_node->remaining    = delay_ms;
-    runnable_node->period       = 0;
-    runnable_node->repeating    = false;
-    runnable_queue_push(&active_queue, runnable_node);
+    if(runnable_node != NULL)
+    {
+        runnable_node->runnable     = callback;
+        runnable_node->context      = context;
+        runnable_node->expires      = elapsed_ms + (delay_ms ? delay_ms : 1);
+        runnable_node->period       = period_ms;
+        runnable_node->repeating    = repeating;
+        runnable_schedule(runnable_node);
+    }
+
+#ifndef EMULATOR
+    svc_enable_interrupts();
+#endif
+}
+
+/*
+ * post_delayed() - Add delay to existing task (callback function) in task manager (queue)
+ *
+ * INPUT
+ *     - callback: task function
+ *     - context: pointer to task arguments
+ *     - delay_ms: delay befor task starts
+ * OUTPUT
+ *     none
+ */
+void post_delayed(Runnable callback, void *context, uint32_t delay_ms)
+{
+    runnable_post(callback, context, 0, delay_ms, false);
 }
 
 /*
@@ -419,20 +517,7 @@ void post_delayed(Runnable callback, void *context, uint32_t delay_ms)
 void post_periodic(Runnable callback, void *context, uint32_t period_ms,
                    uint32_t delay_ms)
 {
-    RunnableNode *runnable_node = runnable_queue_get(&active_queue, callback);
-
-    if(runnable_node == NULL)
-    {
-        runnable_node = runnable_queue_pop(&free_queue);
-    }
-
-    runnable_node->runnable     = callback;
-    runnable_node->context      = context;
-    runnable_node->remaining    = delay_ms;
-    runnable_node->period       = period_ms;
-    runnable_node->repeating    = true;
-
-    runnable_queue_push(&active_queue, runnable_node);
+    runnable_post(callback, context, period_ms, delay_ms, true);
 }
 
 /*
@@ -445,16 +530,25 @@ void post_periodic(Runnable callback, void *context, uint32_t period_ms,
  */
 void remove_runnable(Runnable callback)
 {
-    RunnableNode *runnable_node = runnable_queue_get(&active_queue, callback);
+#ifndef EMULATOR
+    svc_disable_interrupts();
+#endif
+
+    RunnableNode *runnable_node = runnable_find(callback);
 
     if(runnable_node != NULL)
     {
-        runnable_queue_push(&free_queue, runnable_node);
+        runnable_unlink(runnable_node);
+        runnable_free(runnable_node);
     }
+
+#ifndef EMULATOR
+    svc_enable_interrupts();
+#endif
 }
 
 /*
- * clear_runnables() - Reset free_queue and active_queue to initial state
+ * clear_runnables() - Remove every task from the task manager
  *
  * INPUT
  *     none
@@ -463,11 +557,13 @@ void remove_runnable(Runnable callback)
  */
 void clear_runnables(void)
 {
-    RunnableNode *runnable_node = runnable_queue_pop(&active_queue);
+#ifndef EMULATOR
+    svc_disable_interrupts();
+#endif
 
-    while(runnable_node != NULL)
-    {
-        runnable_queue_push(&free_queue, runnable_node);
-        runnable_node = runnable_queue_pop(&active_queue);
-    }
+    runnables_reset();
+
+#ifndef EMULATOR
+    svc_enable_interrupts();
+#endif
 }
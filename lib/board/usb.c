@@ -423,83 +423,146 @@ char usbTiny(char set)
 
 #endif // EMULATOR
 
-bool msg_write(MessageType msg_id, const void *msg)
+/* State of the HID report being filled by msg_report_write() */
+typedef struct {
+	msg_report_sink_t sink;
+	int iface;           //< 0 for the main interface, 1 for debug link.
+	size_t pos;          //< Next free byte of report.
+	uint8_t report[64];
+} MsgReportStream;
+
+static void msg_report_usb(int iface, const uint8_t *report, size_t len)
 {
-	const pb_field_t *fields = message_fields(NORMAL_MSG, msg_id, OUT_MSG);
-
-	if (!fields)
-		return false;
-
-	TrezorFrameBuffer framebuf;
-	memset(&framebuf, 0, sizeof(framebuf));
-	framebuf.frame.usb_header.hid_type = '?';
-	framebuf.frame.header.pre1 = '#';
-	framebuf.frame.header.pre2 = '#';
-	framebuf.frame.header.id = __builtin_bswap16(msg_id);
-
-	pb_ostream_t os = pb_ostream_from_buffer(framebuf.buffer, sizeof(framebuf.buffer));
-
-	if (!pb_encode(&os, fields, msg))
-		return false;
+#ifndef EMULATOR
+#if DEBUG_LINK
+	const uint8_t ep = iface == 0 ? ENDPOINT_ADDRESS_IN : ENDPOINT_ADDRESS_DEBUG_IN;
+#else
+	const uint8_t ep = ENDPOINT_ADDRESS_IN;
+#endif
+	while (usbd_ep_write_packet(usbd_dev, ep, report, len) == 0) {};
+#else
+	emulatorSocketWrite(iface, report, len);
+#endif
+}
 
-	framebuf.frame.header.len = __builtin_bswap32(os.bytes_written);
+static void msg_report_send(MsgReportStream *rs)
+{
+	rs->sink(rs->iface, rs->report, sizeof(rs->report));
 
-	// Chunk out data
-	for (uint32_t pos = 1; pos < sizeof(framebuf.frame) + os.bytes_written; pos += 64 - 1) {
-		uint8_t tmp_buffer[64] = { 0 };
+	memset(rs->report, 0, sizeof(rs->report));
+	rs->report[0] = '?';
+	rs->pos = 1;
+}
 
-		tmp_buffer[0] = '?';
+/// pb_ostream_t callback that sends each report as soon as it fills up.
+static bool msg_report_write(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
+{
+	MsgReportStream *rs = (MsgReportStream *)stream->state;
 
-		memcpy(tmp_buffer + 1, ((const uint8_t*)&framebuf) + pos, 64 - 1);
+	while (count > 0) {
+		size_t n = MIN(count, sizeof(rs->report) - rs->pos);
+		memcpy(&rs->report[rs->pos], buf, n);
+		rs->pos += n;
+		buf += n;
+		count -= n;
 
-#ifndef EMULATOR
-		while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_IN, tmp_buffer, 64) == 0) {};
-#else
-		emulatorSocketWrite(0, tmp_buffer, sizeof(tmp_buffer));
-#endif
+		if (rs->pos == sizeof(rs->report))
+			msg_report_send(rs);
 	}
 
 	return true;
 }
 
-#if DEBUG_LINK
-bool msg_debug_write(MessageType msg_id, const void *msg)
+/// Encode a message straight into 64-byte HID reports on the given interface,
+/// without staging the whole frame in RAM.
+static bool msg_write_fields(msg_report_sink_t sink, int iface,
+                             MessageType msg_id, const pb_field_t *fields,
+                             const void *msg)
 {
-	const pb_field_t *fields = message_fields(DEBUG_MSG, msg_id, OUT_MSG);
-
-	if (!fields)
+	// The frame header carries the length, so size the message first, and
+	// check that it succeeded before anything is sent.
+	size_t len;
+	if (!pb_get_encoded_size(&len, fields, msg))
 		return false;
 
-	TrezorFrameBuffer framebuf;
-	memset(&framebuf, 0, sizeof(framebuf));
-	framebuf.frame.usb_header.hid_type = '?';
-	framebuf.frame.header.pre1 = '#';
-	framebuf.frame.header.pre2 = '#';
-	framebuf.frame.header.id = __builtin_bswap16(msg_id);
+	// Keep the bound of the old frame buffer, and check it before the header
+	// announces a length that could not be sent.
+	if (len > sizeof(((TrezorFrameBuffer *)0)->buffer))
+		return false;
 
-	pb_ostream_t os = pb_ostream_from_buffer(framebuf.buffer, sizeof(framebuf.buffer));
+	MsgReportStream rs;
+	memset(&rs, 0, sizeof(rs));
+	rs.sink = sink;
+	rs.iface = iface;
+
+	TrezorFrame *frame = (TrezorFrame *)rs.report;
+	frame->usb_header.hid_type = '?';
+	frame->header.pre1 = '#';
+	frame->header.pre2 = '#';
+	frame->header.id = __builtin_bswap16(msg_id);
+	frame->header.len = __builtin_bswap32(len);
+	rs.pos = sizeof(TrezorFrame);
+
+	pb_ostream_t os = {
+		.callback = &msg_report_write,
+		.state = &rs,
+		.max_size = len,
+		.bytes_written = 0,
+	};
+
+	bool encoded = pb_encode(&os, fields, msg) && os.bytes_written == len;
+
+	if (!encoded) {
+		// Some reports may already be out, and the header promised len
+		// bytes. Pad the frame out to that length so that the host stays in
+		// step, and follow it with a Failure saying why it won't parse.
+		static const pb_byte_t padding[16];
+		while (os.bytes_written < len) {
+			size_t n = MIN(sizeof(padding), len - os.bytes_written);
+			msg_report_write(&os, padding, n);
+			os.bytes_written += n;
+		}
+	}
 
-	if (!pb_encode(&os, fields, msg))
-		return false;
+	// Flush the final, zero-padded report.
+	if (rs.pos > 1)
+		msg_report_send(&rs);
+
+	if (!encoded) {
+		Failure failure;
+		memset(&failure, 0, sizeof(failure));
+		failure.has_code = true;
+		failure.code = FailureType_Failure_FirmwareError;
+		failure.has_message = true;
+		strlcpy(failure.message, "Could not encode message",
+		        sizeof(failure.message));
+		msg_write_fields(sink, iface, MessageType_MessageType_Failure,
+		                 Failure_fields, &failure);
+	}
 
-	framebuf.frame.header.len = __builtin_bswap32(os.bytes_written);
+	return encoded;
+}
 
-	// Chunk out data
-	for (uint32_t pos = 1; pos < sizeof(framebuf.frame) + os.bytes_written; pos += 64 - 1) {
-		uint8_t tmp_buffer[64] = { 0 };
+bool msg_write_impl(msg_report_sink_t sink, int iface, MessageMapType type,
+                    MessageType msg_id, const void *msg)
+{
+	const pb_field_t *fields = message_fields(type, msg_id, OUT_MSG);
 
-		tmp_buffer[0] = '?';
+	if (!fields)
+		return false;
 
-		memcpy(tmp_buffer + 1, ((const uint8_t*)&framebuf) + pos, 64 - 1);
+	return msg_write_fields(sink, iface, msg_id, fields, msg);
+}
 
-#ifndef EMULATOR
-		while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_DEBUG_IN, tmp_buffer, 64) == 0) {};
-#else
-		emulatorSocketWrite(1, tmp_buffer, sizeof(tmp_buffer));
-#endif
-	}
+bool msg_write(MessageType msg_id, const void *msg)
+{
+	return msg_write_impl(&msg_report_usb, 0, NORMAL_MSG, msg_id, msg);
+}
 
-	return true;
+#if DEBUG_LINK
+bool msg_debug_write(MessageType msg_id, const void *msg)
+{
+	return msg_write_impl(&msg_report_usb, 1, DEBUG_MSG, msg_id, msg);
 }
 #endif
 
@@ -2,8 +2,7 @@
 
 #include "keepkey/board/keepkey_flash.h"
 #include "keepkey/board/pubkeys.h"
-#include "trezor/crypto/secp256k1.h"
-#include "trezor/crypto/ecdsa.h"
+#include "keepkey/board/signatures.h"
 #include "trezor/crypto/sha2.h"
 #include "keepkey/variant/keepkey.h"
 #include "keepkey/variant/salt.h"
@@ -73,16 +72,14 @@ static int variant_signature_check(const SignedVariantInfo *svi) {
     uint8_t info_fingerprint[32];
     sha256_Raw((void *)&svi->info, svi->meta.code_len, info_fingerprint);
 
-    if (ecdsa_verify_digest(&secp256k1, pubkey[sigindex1 - 1], &svi->meta.sig1[0],
-                            info_fingerprint) != 0)
-        return SIG_FAIL;
-
-    if (ecdsa_verify_digest(&secp256k1, pubkey[sigindex2 - 1], &svi->meta.sig2[0],
-                            info_fingerprint) != 0)
-        return SIG_FAIL;
+    const uint8_t *const keys[SIGNATURES] = {
+        pubkey[sigindex1 - 1], pubkey[sigindex2 - 1], pubkey[sigindex3 - 1]
+    };
+    const uint8_t *const sigs[SIGNATURES] = {
+        &svi->meta.sig1[0], &svi->meta.sig2[0], &svi->meta.sig3[0]
+    };
 
-    if (ecdsa_verify_digest(&secp256k1, pubkey[sigindex3 - 1], &svi->meta.sig3[0],
-                            info_fingerprint) != 0)
+    if (signatures_verify_batch(info_fingerprint, keys, sigs, SIGNATURES) != 0)
         return SIG_FAIL;
 
     return SIG_OK;
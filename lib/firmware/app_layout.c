@@ -38,6 +38,9 @@
 
 #define QR_LARGE_VERSION 8
 #define QR_MAX_VERSION 9
+#define QR_MAX_SIDE (QR_MAX_VERSION * 4 + 17)
+#define QR_ROW_BYTES ((QR_MAX_SIDE + 7) / 8)
+#define QR_CACHE_ADDRESS_LEN 130
 
 /*
  * layout_animate_pin() - Animate pin scramble
@@ -660,25 +663,36 @@ void layout_cipher(const char *current_word, const char *cipher)
                          CIPHER_ANIMATION_FREQUENCY_MS * 30);
 }
 
+/* Last symbol encoded by layout_address(), one bit per module */
+static struct {
+    bool valid;
+    QRSize size;
+    char address[QR_CACHE_ADDRESS_LEN];
+    uint8_t side;
+    uint8_t modules[QR_MAX_SIDE * QR_ROW_BYTES];
+} qr_cache;
+
 /*
- * layout_address() - Draws QR code of address
+ * qr_cache_fill() - Encode address into the QR cache unless it is already there
  *
  * INPUT
- *     - address: address to QR code for
+ *     - address: address to encode
+ *     - qr_size: size of QR code
  * OUTPUT
- *     none
+ *     true/false whether the cache holds a symbol for address
  */
-void layout_address(const char *address, QRSize qr_size)
+static bool qr_cache_fill(const char *address, QRSize qr_size)
 {
-    Canvas *canvas = layout_get_canvas();
+    if (qr_cache.valid && qr_cache.size == qr_size &&
+        strcmp(qr_cache.address, address) == 0) {
+        return true;
+    }
+
+    qr_cache.valid = false;
 
     uint8_t codedata[qrcodegen_BUFFER_LEN_FOR_VERSION(QR_MAX_VERSION)];
     uint8_t tempdata[qrcodegen_BUFFER_LEN_FOR_VERSION(QR_MAX_VERSION)];
 
-    int y_pos = qr_size == QR_SMALL
-        ? QR_DISPLAY_Y
-        : QR_DISPLAY_Y - 4;
-
     int side = 0;
     if (qrcodegen_encodeText(address, tempdata, codedata, qrcodegen_Ecc_LOW,
                              qr_size == QR_SMALL
@@ -690,24 +704,53 @@ void layout_address(const char *address, QRSize qr_size)
     }
 
     // Limit QR to version 1-9
-    if (side < 0 || 53 < side)
-        return;
-
-    // Draw QR background
-    draw_box_simple(canvas, 0xFF, QR_DISPLAY_X, y_pos,
-                    (side + 2) * QR_DISPLAY_SCALE, (side + 2) * QR_DISPLAY_SCALE);
-
-    // Fill in QR
-    for (int i = 0; i < side; i++) {
-        for (int j = 0; j < side; j++) {
-            if (qrcodegen_getModule(codedata, i, j)) {
-                draw_box_simple(canvas, 0x00,
-                                QR_DISPLAY_SCALE + (i + QR_DISPLAY_X) * QR_DISPLAY_SCALE,
-                                QR_DISPLAY_SCALE + (j + y_pos) * QR_DISPLAY_SCALE,
-                                QR_DISPLAY_SCALE, QR_DISPLAY_SCALE);
+    if (side <= 0 || QR_MAX_SIDE < side)
+        return false;
+
+    memset(qr_cache.modules, 0, sizeof(qr_cache.modules));
+    for (int y = 0; y < side; y++) {
+        uint8_t *row = &qr_cache.modules[y * QR_ROW_BYTES];
+        for (int x = 0; x < side; x++) {
+            if (qrcodegen_getModule(codedata, x, y)) {
+                row[x >> 3] |= 1 << (x & 7);
             }
         }
     }
+
+    qr_cache.side = side;
+
+    // Addresses too long to remember are still drawn, just not cached.
+    size_t len = strlen(address);
+    if (len < sizeof(qr_cache.address)) {
+        memcpy(qr_cache.address, address, len + 1);
+        qr_cache.size = qr_size;
+        qr_cache.valid = true;
+    }
+
+    return true;
+}
+
+/*
+ * layout_address() - Draws QR code of address
+ *
+ * INPUT
+ *     - address: address to QR code for
+ * OUTPUT
+ *     none
+ */
+void layout_address(const char *address, QRSize qr_size)
+{
+    if (!qr_cache_fill(address, qr_size))
+        return;
+
+    int y_pos = qr_size == QR_SMALL
+        ? QR_DISPLAY_Y
+        : QR_DISPLAY_Y - 4;
+
+    // Draw QR with its one module quiet zone
+    draw_bitmap_mono_scaled(layout_get_canvas(), qr_cache.modules, QR_ROW_BYTES,
+                            qr_cache.side, qr_cache.side, QR_DISPLAY_X, y_pos,
+                            QR_DISPLAY_SCALE, 1, 0x00, 0xFF);
 }
 
 void layoutU2FDialog(bool request, const char *title, const char *body, ...)
@@ -8,7 +8,7 @@
 #include "messages-binance.pb.h"
 
 static CONFIDENTIAL HDNode node;
-static SHA256_CTX ctx;
+static TendermintJson json;
 static bool has_message;
 static bool initialized;
 static uint32_t msgs_remaining;
@@ -30,33 +30,31 @@ bool binance_signTxInit(const HDNode *_node, const BinanceSignTx *_msg)
     memcpy(&msg, _msg, sizeof(msg));
 
     bool success = true;
-    char buffer[64 + 1];
 
-    sha256_Init(&ctx);
+    tendermint_jsonInit(&json);
 
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
+    success &= tendermint_jsonPrintf(&json,
         "{\"account_number\":\"%" PRIu64 "\"", msg.account_number);
 
     const char *const chainid_prefix = ",\"chain_id\":\"";
-    sha256_Update(&ctx, (uint8_t *)chainid_prefix, strlen(chainid_prefix));
-    tendermint_sha256UpdateEscaped(&ctx, msg.chain_id, strlen(msg.chain_id));
+    tendermint_jsonRaw(&json, chainid_prefix, strlen(chainid_prefix));
+    tendermint_jsonEscaped(&json, msg.chain_id, strlen(msg.chain_id));
 
     const char *const data_memo = "\",\"data\":null,\"memo\":\"";
-    sha256_Update(&ctx, (uint8_t *)data_memo, strlen(data_memo));
+    tendermint_jsonRaw(&json, data_memo, strlen(data_memo));
     if (msg.has_memo) {
-        tendermint_sha256UpdateEscaped(&ctx, msg.memo, strlen(msg.memo));
+        tendermint_jsonEscaped(&json, msg.memo, strlen(msg.memo));
     }
 
-    sha256_Update(&ctx, (const uint8_t *)"\",\"msgs\":[", 10);
+    tendermint_jsonRaw(&json, "\",\"msgs\":[", 10);
     return success;
 }
 
 bool binance_serializeCoin(const BinanceCoin *coin)
 {
     bool success = true;
-    char buffer[64 + 1];
 
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
+    success &= tendermint_jsonPrintf(&json,
         "{\"amount\":%" PRIu64 ",\"denom\":\"%s\"}",
         coin->amount, coin->denom);
 
@@ -72,18 +70,18 @@ bool binance_serializeInputOutput(const BinanceInputOutput *io)
         return false;
     }
 
-    sha256_Update(&ctx, (const uint8_t*)"{\"address\":\"", 12);
-    sha256_Update(&ctx, (const uint8_t*)io->address, strlen(io->address));
-    sha256_Update(&ctx, (const uint8_t*)"\",\"coins\":[", 11);
+    tendermint_jsonRaw(&json, "{\"address\":\"", 12);
+    tendermint_jsonRaw(&json, io->address, strlen(io->address));
+    tendermint_jsonRaw(&json, "\",\"coins\":[", 11);
 
     bool success = true;
     for (int i = 0; i < io->coins_count; i++) {
         success &= binance_serializeCoin(&io->coins[i]);
         if (i + 1 != io->coins_count)
-            sha256_Update(&ctx, (const uint8_t*)",", 1);
+            tendermint_jsonRaw(&json, ",", 1);
     }
 
-    sha256_Update(&ctx, (const uint8_t*)"]}", 2);
+    tendermint_jsonRaw(&json, "]}", 2);
 
     return success;
 }
@@ -92,23 +90,23 @@ bool binance_signTxUpdateTransfer(const BinanceTransferMsg *_msg)
 {
     bool success = true;
 
-    sha256_Update(&ctx, (const uint8_t*)"{\"inputs\":[", 11);
+    tendermint_jsonRaw(&json, "{\"inputs\":[", 11);
 
     for (int i = 0; i < _msg->inputs_count; i++) {
         success &= binance_serializeInputOutput(&_msg->inputs[i]);
         if (i + 1 != _msg->inputs_count)
-            sha256_Update(&ctx, (const uint8_t*)",", 1);
+            tendermint_jsonRaw(&json, ",", 1);
     }
 
-    sha256_Update(&ctx, (const uint8_t*)"],\"outputs\":[", 13);
+    tendermint_jsonRaw(&json, "],\"outputs\":[", 13);
 
     for (int i = 0; i < _msg->outputs_count; i++) {
         success &= binance_serializeInputOutput(&_msg->outputs[i]);
         if (i + 1 != _msg->outputs_count)
-            sha256_Update(&ctx, (const uint8_t*)",", 1);
+            tendermint_jsonRaw(&json, ",", 1);
     }
 
-    sha256_Update(&ctx, (const uint8_t*)"]}", 2);
+    tendermint_jsonRaw(&json, "]}", 2);
 
     has_message = true;
     msgs_remaining--;
@@ -117,9 +115,7 @@ bool binance_signTxUpdateTransfer(const BinanceTransferMsg *_msg)
 
 bool binance_signTxFinalize(uint8_t *public_key, uint8_t *signature)
 {
-    char buffer[64 + 1];
-
-    if (!tendermint_snprintf(&ctx, buffer, sizeof(buffer),
+    if (!tendermint_jsonPrintf(&json,
         "],\"sequence\":\"%" PRIu64 "\",\"source\":\"%" PRIu64 "\"}",
         msg.sequence, msg.source))
         return false;
@@ -128,7 +124,7 @@ bool binance_signTxFinalize(uint8_t *public_key, uint8_t *signature)
     memcpy(public_key, node.public_key, 33);
 
     uint8_t hash[SHA256_DIGEST_LENGTH];
-    sha256_Final(&ctx, hash);
+    tendermint_jsonFinal(&json, hash);
     return ecdsa_sign_digest(&secp256k1, node.private_key, hash, signature, NULL, NULL) == 0;
 }
 
@@ -144,6 +140,7 @@ void binance_signAbort(void) {
     initialized = false;
     has_message = false;
     msgs_remaining = 0;
+    memzero(&json, sizeof(json));
     memzero(&msg, sizeof(msg));
     memzero(&node, sizeof(node));
 }
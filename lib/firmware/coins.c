@@ -228,42 +228,133 @@ bool bip32_path_to_string(char *str, size_t len, const uint32_t *address_n,
     return true;
 }
 
-const CoinType *coinByShortcut(const char *shortcut)
+/*
+ * Sorted lookup indexes into coins[], one per search key. Each holds the
+ * table positions ordered by (key, position), so that a lower-bound binary
+ * search lands on the same entry the linear scan would have returned first
+ * when several coins share a key (e.g. every ERC-20 token has slip44 60).
+ */
+_Static_assert(COINS_COUNT <= UINT16_MAX,
+               "Coin indexes are stored as uint16_t");
+
+typedef int (*coin_key_cmp)(const CoinType *coin, const void *key);
+typedef const void *(*coin_key_get)(const CoinType *coin);
+
+static uint16_t coins_by_name[COINS_COUNT];
+static uint16_t coins_by_shortcut[COINS_COUNT];
+static uint16_t coins_by_address_type[COINS_COUNT];
+static uint16_t coins_by_slip44[COINS_COUNT];
+static bool coin_indexes_ready = false;
+
+static int cmp_name(const CoinType *coin, const void *name)
 {
-    if(!shortcut) { return 0; }
+    return strncasecmp(coin->coin_name, (const char *)name,
+                       sizeof(coin->coin_name));
+}
 
-    int i;
+static const void *key_name(const CoinType *coin)
+{
+    return coin->coin_name;
+}
 
-    for(i = 0; i < COINS_COUNT; i++)
-    {
-        if(strncasecmp(shortcut, coins[i].coin_shortcut,
-                       sizeof(coins[i].coin_shortcut)) == 0)
-        {
-            return &coins[i];
-        }
-    }
+static int cmp_shortcut(const CoinType *coin, const void *shortcut)
+{
+    return strncasecmp(coin->coin_shortcut, (const char *)shortcut,
+                       sizeof(coin->coin_shortcut));
+}
 
-    return 0;
+static const void *key_shortcut(const CoinType *coin)
+{
+    return coin->coin_shortcut;
 }
 
-const CoinType *coinByName(const char *name)
+static int cmp_address_type(const CoinType *coin, const void *key)
 {
-    if(!name) { return 0; }
+    uint32_t address_type = *(const uint32_t *)key;
+    return (coin->address_type > address_type) -
+           (coin->address_type < address_type);
+}
 
-    int i;
+static const void *key_address_type(const CoinType *coin)
+{
+    return &coin->address_type;
+}
 
-    for(i = 0; i < COINS_COUNT; i++)
-    {
-        if(strncasecmp(name, coins[i].coin_name,
-                       sizeof(coins[i].coin_name)) == 0)
-        {
-            return &coins[i];
+static int cmp_slip44(const CoinType *coin, const void *key)
+{
+    uint32_t bip44_account_path = *(const uint32_t *)key;
+    return (coin->bip44_account_path > bip44_account_path) -
+           (coin->bip44_account_path < bip44_account_path);
+}
+
+static const void *key_slip44(const CoinType *coin)
+{
+    return &coin->bip44_account_path;
+}
+
+static void coin_index_sort(uint16_t *index, coin_key_cmp cmp,
+                            coin_key_get key)
+{
+    // Insertion sort: stable, so equal keys stay in table order. The table
+    // is small, and this only runs once per boot.
+    for (int i = 0; i < COINS_COUNT; i++) {
+        int j = i;
+        while (j > 0 && cmp(&coins[index[j - 1]], key(&coins[i])) > 0) {
+            index[j] = index[j - 1];
+            j--;
         }
+        index[j] = (uint16_t)i;
     }
+}
+
+static void coin_indexes_init(void)
+{
+    if (coin_indexes_ready)
+        return;
+
+    coin_index_sort(coins_by_name, cmp_name, key_name);
+    coin_index_sort(coins_by_shortcut, cmp_shortcut, key_shortcut);
+    coin_index_sort(coins_by_address_type, cmp_address_type, key_address_type);
+    coin_index_sort(coins_by_slip44, cmp_slip44, key_slip44);
+    coin_indexes_ready = true;
+}
+
+/// \returns the first coin (in table order) whose key compares equal to
+///          `key`, or NULL if there is none.
+static const CoinType *coin_index_find(const uint16_t *index, coin_key_cmp cmp,
+                                       const void *key)
+{
+    coin_indexes_init();
+
+    int lo = 0, hi = COINS_COUNT;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cmp(&coins[index[mid]], key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < COINS_COUNT && cmp(&coins[index[lo]], key) == 0)
+        return &coins[index[lo]];
 
     return 0;
 }
 
+const CoinType *coinByShortcut(const char *shortcut)
+{
+    if(!shortcut) { return 0; }
+
+    return coin_index_find(coins_by_shortcut, cmp_shortcut, shortcut);
+}
+
+const CoinType *coinByName(const char *name)
+{
+    if(!name) { return 0; }
+
+    return coin_index_find(coins_by_name, cmp_name, name);
+}
+
 const CoinType *coinByNameOrTicker(const char *name)
 {
     const CoinType *coin = coinByName(name);
@@ -297,27 +388,13 @@ const CoinType *coinByChainAddress(uint8_t chain_id, const uint8_t *address)
 
 const CoinType *coinByAddressType(uint32_t address_type)
 {
-    int i;
-
-    for(i = 0; i < COINS_COUNT; i++)
-    {
-        if(address_type == coins[i].address_type)
-        {
-            return &coins[i];
-        }
-    }
-
-    return 0;
+    return coin_index_find(coins_by_address_type, cmp_address_type,
+                           &address_type);
 }
 
 const CoinType *coinBySlip44(uint32_t bip44_account_path)
 {
-    for (int i = 0; i < COINS_COUNT; i++) {
-        if (bip44_account_path == coins[i].bip44_account_path) {
-            return &coins[i];
-        }
-    }
-    return 0;
+    return coin_index_find(coins_by_slip44, cmp_slip44, &bip44_account_path);
 }
 
 /*
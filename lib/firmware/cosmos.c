@@ -14,7 +14,7 @@
 #include <time.h>
 
 static CONFIDENTIAL HDNode node;
-static SHA256_CTX ctx;
+static TendermintJson json;
 static bool has_message;
 static bool initialized;
 static uint32_t msgs_remaining;
@@ -36,39 +36,38 @@ bool cosmos_signTxInit(const HDNode* _node, const CosmosSignTx *_msg)
     memcpy(&msg, _msg, sizeof(msg));
 
     bool success = true;
-    char buffer[64 + 1];
 
-    sha256_Init(&ctx);
+    tendermint_jsonInit(&json);
 
     // Each segment guaranteed to be less than or equal to 64 bytes
     // 19 + ^20 + 1 = ^40
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   "{\"account_number\":\"%" PRIu64 "\"",
-                                   msg.account_number);
+    success &= tendermint_jsonPrintf(&json,
+                                     "{\"account_number\":\"%" PRIu64 "\"",
+                                     msg.account_number);
 
     // <escape chain_id>
     const char *const chainid_prefix = ",\"chain_id\":\"";
-    sha256_Update(&ctx, (uint8_t *)chainid_prefix, strlen(chainid_prefix));
-    tendermint_sha256UpdateEscaped(&ctx, msg.chain_id, strlen(msg.chain_id));
+    tendermint_jsonRaw(&json, chainid_prefix, strlen(chainid_prefix));
+    tendermint_jsonEscaped(&json, msg.chain_id, strlen(msg.chain_id));
 
     // 30 + ^10 + 19 = ^59
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   "\",\"fee\":{\"amount\":[{\"amount\":\"%" PRIu32 "\",\"denom\":\"uatom\"}]",
-                                   msg.fee_amount);
+    success &= tendermint_jsonPrintf(&json,
+                                     "\",\"fee\":{\"amount\":[{\"amount\":\"%" PRIu32 "\",\"denom\":\"uatom\"}]",
+                                     msg.fee_amount);
 
     // 8 + ^10 + 2 = ^20
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   ",\"gas\":\"%" PRIu32 "\"}", msg.gas);
+    success &= tendermint_jsonPrintf(&json,
+                                     ",\"gas\":\"%" PRIu32 "\"}", msg.gas);
 
     // <escape memo>
     const char *const memo_prefix = ",\"memo\":\"";
-    sha256_Update(&ctx, (uint8_t *)memo_prefix, strlen(memo_prefix));
+    tendermint_jsonRaw(&json, memo_prefix, strlen(memo_prefix));
     if (msg.has_memo) {
-        tendermint_sha256UpdateEscaped(&ctx, msg.memo, strlen(msg.memo));
+        tendermint_jsonEscaped(&json, msg.memo, strlen(msg.memo));
     }
 
     // 10
-    sha256_Update(&ctx, (uint8_t *)"\",\"msgs\":[", 10);
+    tendermint_jsonRaw(&json, "\",\"msgs\":[", 10);
 
     return success;
 }
@@ -76,8 +75,6 @@ bool cosmos_signTxInit(const HDNode* _node, const CosmosSignTx *_msg)
 bool cosmos_signTxUpdateMsgSend(const uint64_t amount,
                                 const char *to_address)
 {
-    char buffer[64 + 1];
-
     size_t decoded_len;
     char hrp[45];
     uint8_t decoded[38];
@@ -87,27 +84,27 @@ bool cosmos_signTxUpdateMsgSend(const uint64_t amount,
     if (!tendermint_getAddress(&node, "cosmos", from_address)) { return false; }
 
     if (has_message) {
-        sha256_Update(&ctx, (uint8_t*)",", 1);
+        tendermint_jsonRaw(&json, ",", 1);
     }
 
     bool success = true;
 
     const char *const prelude = "{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{";
-    sha256_Update(&ctx, (uint8_t *)prelude, strlen(prelude));
+    tendermint_jsonRaw(&json, prelude, strlen(prelude));
 
     // 21 + ^20 + 19 = ^60
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   "\"amount\":[{\"amount\":\"%" PRIu64 "\",\"denom\":\"uatom\"}]",
-                                   amount);
+    success &= tendermint_jsonPrintf(&json,
+                                     "\"amount\":[{\"amount\":\"%" PRIu64 "\",\"denom\":\"uatom\"}]",
+                                     amount);
 
     // 17 + 45 + 1 = 63
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   ",\"from_address\":\"%s\"",
-                                   from_address);
+    success &= tendermint_jsonPrintf(&json,
+                                     ",\"from_address\":\"%s\"",
+                                     from_address);
 
     // 15 + 45 + 3 = 63
-    success &= tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                                   ",\"to_address\":\"%s\"}}", to_address);
+    success &= tendermint_jsonPrintf(&json,
+                                     ",\"to_address\":\"%s\"}}", to_address);
 
     has_message = true;
     msgs_remaining--;
@@ -116,18 +113,15 @@ bool cosmos_signTxUpdateMsgSend(const uint64_t amount,
 
 bool cosmos_signTxFinalize(uint8_t* public_key, uint8_t* signature)
 {
-    char buffer[64 + 1];
-
     // 16 + ^20 = ^36
-    if (!tendermint_snprintf(&ctx, buffer, sizeof(buffer),
-                             "],\"sequence\":\"%" PRIu64 "\"}", msg.sequence))
+    if (!tendermint_jsonPrintf(&json, "],\"sequence\":\"%" PRIu64 "\"}", msg.sequence))
         return false;
 
     hdnode_fill_public_key(&node);
     memcpy(public_key, node.public_key, 33);
 
     uint8_t hash[SHA256_DIGEST_LENGTH];
-    sha256_Final(&ctx, hash);
+    tendermint_jsonFinal(&json, hash);
     return ecdsa_sign_digest(&secp256k1, node.private_key, hash, signature, NULL, NULL) == 0;
 }
 
@@ -143,6 +137,7 @@ void cosmos_signAbort(void) {
     initialized = false;
     has_message = false;
     msgs_remaining = 0;
+    memzero(&json, sizeof(json));
     memzero(&msg, sizeof(msg));
     memzero(&node, sizeof(node));
 }
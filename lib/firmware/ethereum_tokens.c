@@ -4,6 +4,10 @@
 
 #include <string.h>
 
+// Sorted position indexes into tokens[], generated from ethereum_tokens.def
+// at build time by ethereum_tokens_index.py.
+#include "keepkey/firmware/ethereum_tokens_index.inc"
+
 const TokenType tokens[] = {
 #define X(CHAIN_ID, CONTRACT_ADDR, TICKER, DECIMALS) \
     { (CONTRACT_ADDR), (TICKER), (CHAIN_ID), (DECIMALS) },
@@ -16,15 +20,75 @@ _Static_assert(sizeof(tokens) / sizeof(tokens[0]) == TOKENS_COUNT,
 static const TokenType Unknown = { "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", " UNKN", 1, 0 };
 const TokenType *UnknownToken = (const TokenType *)&Unknown;
 
+static int cmp_chain_address(const TokenType *token, uint8_t chain_id,
+                             const uint8_t *address)
+{
+	if (token->chain_id != chain_id)
+		return token->chain_id < chain_id ? -1 : 1;
+	return memcmp(token->address, address, 20);
+}
+
+static int cmp_chain_ticker(const TokenType *token, uint8_t chain_id,
+                            const char *ticker)
+{
+	if (token->chain_id != chain_id)
+		return token->chain_id < chain_id ? -1 : 1;
+	return strcmp(token->ticker + 1, ticker);
+}
+
+const TokenType *tokenSearchByChainAddress(const TokenType *table,
+                                           const uint16_t *index, int count,
+                                           uint8_t chain_id,
+                                           const uint8_t *address)
+{
+	int lo = 0, hi = count;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (cmp_chain_address(&table[index[mid]], chain_id, address) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < count && cmp_chain_address(&table[index[lo]], chain_id, address) == 0)
+		return &table[index[lo]];
+
+	return NULL;
+}
+
+int tokenSearchByTicker(const TokenType *table, const uint16_t *index,
+                        int count, uint8_t chain_id, const char *ticker,
+                        const TokenType **token)
+{
+	*token = NULL;
+
+	int lo = 0, hi = count;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (cmp_chain_ticker(&table[index[mid]], chain_id, ticker) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo >= count || cmp_chain_ticker(&table[index[lo]], chain_id, ticker) != 0)
+		return 0;
+
+	*token = &table[index[lo]];
+
+	if (lo + 1 < count && cmp_chain_ticker(&table[index[lo + 1]], chain_id, ticker) == 0)
+		return 2;
+
+	return 1;
+}
+
 const TokenType *tokenByChainAddress(uint8_t chain_id, const uint8_t *address)
 {
 	if (!address) return 0;
-	for (int i = 0; i < TOKENS_COUNT; i++) {
-		if (chain_id == tokens[i].chain_id && memcmp(address, tokens[i].address, 20) == 0) {
-			return &(tokens[i]);
-		}
-	}
-	return UnknownToken;
+	const TokenType *token = tokenSearchByChainAddress(tokens, tokens_by_address,
+	                                                   TOKENS_COUNT, chain_id,
+	                                                   address);
+	return token ? token : UnknownToken;
 }
 
 bool tokenByTicker(uint8_t chain_id, const char *ticker, const TokenType **token) {
@@ -45,15 +109,8 @@ bool tokenByTicker(uint8_t chain_id, const char *ticker, const TokenType **token
 	}
 
 	// Then look in the new table:
-	for (int i = 0; i < TOKENS_COUNT; i++) {
-		if (chain_id == tokens[i].chain_id && strcmp(ticker, tokens[i].ticker + 1) == 0) {
-			if (!*token)
-				*token = &tokens[i];
-			else
-				return false;
-		}
-	}
-	return *token;
+	return tokenSearchByTicker(tokens, tokens_by_ticker, TOKENS_COUNT,
+	                           chain_id, ticker, token) == 1;
 }
 
 void coinFromToken(CoinType *coin, const TokenType *token) {
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#
+# Generates sorted lookup indexes for the ERC-20 token table.
+#
+# Usage: ethereum_tokens_index.py <ethereum_tokens.def> <ethereum_tokens_index.inc>
+#
+# Each line of ethereum_tokens.def is an X-macro invocation of the form:
+#
+#   X(CHAIN_ID, CONTRACT_ADDR, TICKER, DECIMALS)
+#
+# The output holds two arrays of positions into tokens[]: one ordered by
+# (chain_id, address), and one ordered by (chain_id, ticker). Ties keep table
+# order. The orderings must agree with the comparators in ethereum_tokens.c,
+# which compare addresses with memcmp and tickers with strcmp.
+
+import ast
+import sys
+
+
+def parse_tokens(path):
+    tokens = []
+    with open(path, 'r') as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith('X(') or not line.endswith(')'):
+                continue
+            chain_id, address, ticker, _ = ast.literal_eval(line[1:])
+            address = address.encode('latin-1')
+            ticker = ticker.encode('latin-1')
+            if len(address) != 20:
+                raise ValueError('Bad contract address length: ' + line)
+            # tokens[].ticker carries a leading space, which lookups skip.
+            tokens.append((chain_id, address, ticker[1:]))
+    return tokens
+
+
+def format_index(name, order):
+    out = 'static const uint16_t %s[TOKENS_COUNT] = {\n' % name
+    for i in range(0, len(order), 12):
+        out += '    ' + ', '.join('%d' % x for x in order[i:i + 12]) + ',\n'
+    out += '};\n'
+    return out
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: %s <ethereum_tokens.def> <out.inc>' % sys.argv[0])
+
+    tokens = parse_tokens(sys.argv[1])
+    if len(tokens) > 0xffff:
+        sys.exit('Too many tokens for a uint16_t index')
+
+    positions = range(len(tokens))
+    by_address = sorted(positions, key=lambda i: (tokens[i][0], tokens[i][1], i))
+    by_ticker = sorted(positions, key=lambda i: (tokens[i][0], tokens[i][2], i))
+
+    out = '// Generated by ethereum_tokens_index.py. Do not edit.\n\n'
+    out += format_index('tokens_by_address', by_address)
+    out += '\n'
+    out += format_index('tokens_by_ticker', by_ticker)
+
+    # Only touch the output when it changes, to avoid needless rebuilds.
+    try:
+        with open(sys.argv[2], 'r') as f:
+            if f.read() == out:
+                return
+    except IOError:
+        pass
+
+    with open(sys.argv[2], 'w') as f:
+        f.write(out)
+
+
+if __name__ == '__main__':
+    main()
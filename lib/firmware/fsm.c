@@ -45,6 +45,7 @@
 #include "keepkey/firmware/exchange.h"
 #include "keepkey/firmware/fsm.h"
 #include "keepkey/firmware/home_sm.h"
+#include "keepkey/firmware/node_cache.h"
 #include "keepkey/firmware/passphrase_sm.h"
 #include "keepkey/firmware/pin_sm.h"
 #include "keepkey/firmware/policy.h"
@@ -196,7 +197,7 @@ static HDNode *fsm_getDerivedNode(const char *curve, const uint32_t *address_n,
         return &node;
     }
 
-    if (hdnode_private_ckd_cached(&node, address_n, address_n_count, fingerprint) == 0)
+    if (node_cache_derive(&node, address_n, address_n_count, fingerprint) == 0)
     {
         fsm_sendFailure(FailureType_Failure_Other, "Failed to derive private key");
         layoutHome();
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the KeepKey project.
+ *
+ * Copyright (C) 2019 ShapeShift
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keepkey/firmware/node_cache.h"
+
+#include "trezor/crypto/memzero.h"
+#include "trezor/crypto/sha2.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/// Account-level depth, e.g. m/44'/coin'/account'.
+#define NODE_CACHE_ACCOUNT_DEPTH 3
+
+typedef struct {
+    bool set;
+    uint32_t last_used;
+    const curve_info *curve;
+    uint8_t root_digest[SHA256_DIGEST_LENGTH];
+    uint32_t address_n[NODE_CACHE_MAXDEPTH];
+    size_t address_n_count;
+    HDNode node;
+} NodeCacheEntry;
+
+static CONFIDENTIAL NodeCacheEntry node_cache[NODE_CACHE_SIZE];
+static uint32_t node_cache_clock = 0;
+
+static void node_cache_root_digest(const HDNode *root,
+                                   uint8_t digest[SHA256_DIGEST_LENGTH])
+{
+    SHA256_CTX ctx;
+    sha256_Init(&ctx);
+    sha256_Update(&ctx, root->chain_code, sizeof(root->chain_code));
+    sha256_Update(&ctx, root->private_key, sizeof(root->private_key));
+    sha256_Final(&ctx, digest);
+}
+
+/// \returns the cached entry for the longest proper prefix of address_n.
+static NodeCacheEntry *node_cache_lookup(const curve_info *curve,
+                                         const uint8_t *root_digest,
+                                         const uint32_t *address_n,
+                                         size_t count)
+{
+    NodeCacheEntry *best = NULL;
+
+    for (int i = 0; i < NODE_CACHE_SIZE; i++) {
+        NodeCacheEntry *entry = &node_cache[i];
+
+        if (!entry->set || entry->curve != curve)
+            continue;
+
+        if (entry->address_n_count >= count)
+            continue;
+
+        if (best && best->address_n_count >= entry->address_n_count)
+            continue;
+
+        if (memcmp(entry->root_digest, root_digest, SHA256_DIGEST_LENGTH) != 0)
+            continue;
+
+        if (memcmp(entry->address_n, address_n,
+                   entry->address_n_count * sizeof(uint32_t)) != 0)
+            continue;
+
+        best = entry;
+    }
+
+    if (best)
+        best->last_used = ++node_cache_clock;
+
+    return best;
+}
+
+static void node_cache_insert(const uint8_t *root_digest,
+                              const uint32_t *address_n, size_t count,
+                              const HDNode *node)
+{
+    if (count == 0 || count > NODE_CACHE_MAXDEPTH)
+        return;
+
+    NodeCacheEntry *victim = &node_cache[0];
+    for (int i = 0; i < NODE_CACHE_SIZE; i++) {
+        NodeCacheEntry *entry = &node_cache[i];
+
+        if (entry->set && entry->curve == node->curve &&
+            entry->address_n_count == count &&
+            memcmp(entry->root_digest, root_digest, SHA256_DIGEST_LENGTH) == 0 &&
+            memcmp(entry->address_n, address_n, count * sizeof(uint32_t)) == 0) {
+            entry->last_used = ++node_cache_clock;
+            return;
+        }
+
+        if (!entry->set) {
+            victim = entry;
+        } else if (victim->set && entry->last_used < victim->last_used) {
+            victim = entry;
+        }
+    }
+
+    memzero(victim, sizeof(*victim));
+    victim->set = true;
+    victim->last_used = ++node_cache_clock;
+    victim->curve = node->curve;
+    memcpy(victim->root_digest, root_digest, SHA256_DIGEST_LENGTH);
+    memcpy(victim->address_n, address_n, count * sizeof(uint32_t));
+    victim->address_n_count = count;
+    memcpy(&victim->node, node, sizeof(HDNode));
+}
+
+int node_cache_derive(HDNode *inout, const uint32_t *address_n, size_t count,
+                      uint32_t *fingerprint)
+{
+    if (count == 0)
+        return 1;
+
+    uint8_t root_digest[SHA256_DIGEST_LENGTH];
+    node_cache_root_digest(inout, root_digest);
+
+    size_t depth = 0;
+    const NodeCacheEntry *hit = node_cache_lookup(inout->curve, root_digest,
+                                                  address_n, count);
+    if (hit) {
+        memcpy(inout, &hit->node, sizeof(HDNode));
+        depth = hit->address_n_count;
+    }
+
+    for (; depth < count; depth++) {
+        if (depth + 1 == count && fingerprint)
+            *fingerprint = hdnode_fingerprint(inout);
+
+        if (hdnode_private_ckd(inout, address_n[depth]) == 0) {
+            memzero(root_digest, sizeof(root_digest));
+            return 0;
+        }
+
+        // Remember the account-level node and the parent of the leaf.
+        if (depth + 1 == NODE_CACHE_ACCOUNT_DEPTH || depth + 2 == count)
+            node_cache_insert(root_digest, address_n, depth + 1, inout);
+    }
+
+    memzero(root_digest, sizeof(root_digest));
+    return 1;
+}
+
+void node_cache_clear(void)
+{
+    memzero(node_cache, sizeof(node_cache));
+    node_cache_clock = 0;
+}
@@ -166,6 +166,49 @@ bool exact_str_match(const char *str1, const char *str2, uint32_t len)
 }
 
 #define BIP39_MAX_WORD_LEN 8
+#define BIP39_WORDS 2048
+#define PREFIX_BUCKETS (26 * 26)
+
+/* The wordlist is sorted, so the words sharing their first two letters are a
+ * run starting at bucket_start[]. Every lookup scans bucket_max words from
+ * there, whichever bucket it is: words past the end of a bucket can't match,
+ * and the number of comparisons doesn't depend on the prefix. */
+static uint16_t bucket_start[PREFIX_BUCKETS];
+static uint16_t bucket_max;
+
+static bool prefix_bucket(const char *word, uint32_t *bucket)
+{
+    if (word[0] < 'a' || word[0] > 'z' || word[1] < 'a' || word[1] > 'z') {
+        return false;
+    }
+
+    *bucket = (word[0] - 'a') * 26 + (word[1] - 'a');
+    return true;
+}
+
+static void prefix_buckets_init(void)
+{
+    if (bucket_max) {
+        return;
+    }
+
+    uint32_t next = 0, last = PREFIX_BUCKETS, run = 0;
+    for (uint32_t i = 0; i < BIP39_WORDS; i++) {
+        uint32_t bucket = 0;
+        prefix_bucket(wordlist[i], &bucket);
+        while (next <= bucket) {
+            bucket_start[next++] = i;
+        }
+        run = bucket == last ? run + 1 : 1;
+        last = bucket;
+        if (run > bucket_max) {
+            bucket_max = run;
+        }
+    }
+    while (next < PREFIX_BUCKETS) {
+        bucket_start[next++] = 0;
+    }
+}
 
 bool attempt_auto_complete(char *partial_word)
 {
@@ -187,13 +230,20 @@ bool attempt_auto_complete(char *partial_word)
         return false;
     }
 
+    // Once two letters are known only their bucket needs looking at,
+    // otherwise fall back to the whole wordlist.
+    uint32_t base = 0, slots = BIP39_WORDS, bucket;
+    if (partial_word_len >= 2 && prefix_bucket(partial_word, &bucket)) {
+        prefix_buckets_init();
+        base = bucket_start[bucket];
+        slots = bucket_max;
+    }
 
-
-    static uint16_t CONFIDENTIAL permute[2049];
-    for (int i = 0; i < 2049; i++) {
-        permute[i] = i;
+    static uint16_t CONFIDENTIAL permute[BIP39_WORDS];
+    for (uint32_t i = 0; i < slots; i++) {
+        permute[i] = (base + i) % BIP39_WORDS;
     }
-    random_permute_u16(permute, 2048);
+    random_permute_u16(permute, slots);
 
     // We don't want the compiler to see through the fact that we're randomly
     // permuting the order of iteration of the next few loops, in case it's
@@ -203,18 +253,18 @@ bool attempt_auto_complete(char *partial_word)
     asm volatile ("" ::: "memory");
 
     // Look for precise matches first (including null termination)
-    for (uint32_t volatile i = 0; words[permute[i]] != 0; i++) {
+    for (uint32_t volatile i = 0; i < slots; i++) {
         if (exact_str_match(partial_word, words[permute[i]], partial_word_len + 1)) {
             strlcpy(partial_word, words[permute[i]], CURRENT_WORD_BUF);
             precise_match = true;
         }
     }
 
-    random_permute_u16(permute, 2048);
+    random_permute_u16(permute, slots);
     asm volatile ("" ::: "memory");
 
     // Followed by partial matches (ignoring null termination)
-    for (uint32_t volatile i = 0; words[permute[i]] != 0; i++) {
+    for (uint32_t volatile i = 0; i < slots; i++) {
         if (exact_str_match(partial_word, words[permute[i]], partial_word_len)) {
             match++;
             found = i;
@@ -29,6 +29,7 @@
 #include "keepkey/firmware/exchange.h"
 #include "keepkey/firmware/fsm.h"
 #include "keepkey/firmware/home_sm.h"
+#include "keepkey/firmware/node_cache.h"
 #include "keepkey/firmware/policy.h"
 #include "keepkey/firmware/signing.h"
 #include "keepkey/firmware/transaction.h"
@@ -88,6 +89,39 @@ static uint32_t in_address_n[8];
 static size_t in_address_n_count;
 static uint32_t tx_weight;
 
+/* Previous transactions whose hash was checked earlier in this session, with
+ * the amounts of their first outputs. Inputs spending another output of the
+ * same transaction take the amount from here instead of streaming it again. */
+#define PREVTX_CACHE_TXS     4
+#define PREVTX_CACHE_OUTPUTS 16
+
+typedef struct {
+	uint8_t hash[32];
+	uint32_t outputs_len;
+	uint64_t amounts[PREVTX_CACHE_OUTPUTS];
+} PrevTxCacheEntry;
+
+static PrevTxCacheEntry prevtx_cache[PREVTX_CACHE_TXS];
+static PrevTxCacheEntry prevtx_pending;
+static uint32_t prevtx_cache_used;
+
+/* The outpoint, sequence and script type of every input, recorded in phase 1.
+ * Phase 2 serializes the legacy sighash of each input from this table, and
+ * only requests the input being signed, instead of requesting every input
+ * again for every signature. Transactions with more inputs than fit fall back
+ * to re-requesting them. */
+#define INPUT_TABLE_SIZE 64
+
+typedef struct {
+	uint8_t prev_hash[32];
+	uint32_t prev_index;
+	uint32_t sequence;
+	InputScriptType script_type;
+} InputRecord;
+
+static InputRecord input_table[INPUT_TABLE_SIZE];
+static bool input_table_used;
+
 /* A marker for in_address_n_count to indicate a mismatch in bip32 paths in
    input */
 #define BIP32_NOCHANGEALLOWED 1
@@ -99,13 +133,6 @@ static uint32_t tx_weight;
    use and still allow to quickly brute-force the correct bip32 path. */
 #define BIP32_MAX_LAST_ELEMENT 1000000
 
-/* transaction header size: 4 byte version */
-#define TXSIZE_HEADER 4
-/* transaction footer size: 4 byte lock time */
-#define TXSIZE_FOOTER 4
-/* transaction segwit overhead 2 marker */
-#define TXSIZE_SEGWIT_OVERHEAD 2
-
 enum {
 	SIGHASH_ALL = 1,
 	SIGHASH_FORKID = 0x40,
@@ -123,6 +150,48 @@ enum {
  */
 #define PROGRESS_PRECISION 16
 
+static void prevtx_cache_clear(void)
+{
+	memzero(prevtx_cache, sizeof(prevtx_cache));
+	memzero(&prevtx_pending, sizeof(prevtx_pending));
+	prevtx_cache_used = 0;
+}
+
+/* Remember the previous transaction that was just streamed, once its hash
+ * has been checked. Entries are replaced oldest first. */
+static void prevtx_cache_add(void)
+{
+	memcpy(&prevtx_cache[prevtx_cache_used % PREVTX_CACHE_TXS], &prevtx_pending,
+	       sizeof(prevtx_pending));
+	prevtx_cache_used++;
+}
+
+static bool prevtx_cache_lookup(const TxInputType *txinput, uint64_t *amount)
+{
+	uint32_t count = prevtx_cache_used < PREVTX_CACHE_TXS ? prevtx_cache_used : PREVTX_CACHE_TXS;
+	for (uint32_t i = 0; i < count; i++) {
+		const PrevTxCacheEntry *entry = &prevtx_cache[i];
+		if (memcmp(entry->hash, txinput->prev_hash.bytes, 32) != 0)
+			continue;
+		if (txinput->prev_index >= entry->outputs_len ||
+		    txinput->prev_index >= PREVTX_CACHE_OUTPUTS)
+			return false;
+		*amount = entry->amounts[txinput->prev_index];
+		return true;
+	}
+	return false;
+}
+
+bool signing_prevtx_cached(const uint8_t *prev_hash)
+{
+	uint32_t count = prevtx_cache_used < PREVTX_CACHE_TXS ? prevtx_cache_used : PREVTX_CACHE_TXS;
+	for (uint32_t i = 0; i < count; i++) {
+		if (memcmp(prevtx_cache[i].hash, prev_hash, 32) == 0)
+			return true;
+	}
+	return false;
+}
+
 /*
  * send_co_failed_message() - send transaction output error message to client
  *
@@ -239,6 +308,12 @@ foreach I (idx1):  // input to sign
         Request I                                                     STAGE_REQUEST_SEGWIT_INPUT
         Return serialized input chunk
 
+    else if (all inputs fit in the input table)
+        Request I (idx1)                                              STAGE_REQUEST_4_INPUT
+        Compare I with the input table
+        Fill scriptsig
+        Remember key for signing
+        Add inputs from the table to StreamTransactionSign
     else
         foreach I (idx2):
             Request I                                                 STAGE_REQUEST_4_INPUT
@@ -456,7 +531,8 @@ void phase1_request_next_input(void)
 void phase2_request_next_input(void)
 {
 	if (idx1 == next_nonsegwit_input) {
-		idx2 = 0;
+		// with the input table, only the input being signed is needed
+		idx2 = input_table_used ? idx1 : 0;
 		send_req_4_input();
 	} else {
 		send_req_segwit_input();
@@ -638,7 +714,7 @@ bool compile_input_script_sig(TxInputType *tinput)
 		}
 	}
 	memcpy(&node, root, sizeof(HDNode));
-	if (hdnode_private_ckd_cached(&node, tinput->address_n, tinput->address_n_count, NULL) == 0) {
+	if (node_cache_derive(&node, tinput->address_n, tinput->address_n_count, NULL) == 0) {
 		// Failed to derive private key
 		return false;
 	}
@@ -677,13 +753,7 @@ void signing_init(const SignTx *msg, const CoinType *_coin, const HDNode *_root)
 		}
 	}
 
-	uint32_t size = TXSIZE_HEADER + TXSIZE_FOOTER + ser_length_size(inputs_count) + ser_length_size(outputs_count);
-	if (coin->decred) {
-		size += 4; // Decred expiry
-		size += ser_length_size(inputs_count); // Witness inputs count
-	}
-
-	tx_weight = 4 * size;
+	tx_weight = tx_base_weight(coin, inputs_count, outputs_count);
 
 	signatures = 0;
 	idx1 = 0;
@@ -693,6 +763,8 @@ void signing_init(const SignTx *msg, const CoinType *_coin, const HDNode *_root)
 	authorized_amount = 0;
 	memset(&input, 0, sizeof(TxInputType));
 	memset(&resp, 0, sizeof(TxRequest));
+	prevtx_cache_clear();
+	input_table_used = !coin->decred && inputs_count <= INPUT_TABLE_SIZE;
 
 	signing = true;
 	progress = 0;
@@ -781,6 +853,13 @@ static bool signing_check_input(TxInputType *txinput) {
 		// compute Decred hashPrefix
 		tx_serialize_input_hash(&ti, txinput);
 	}
+	if (input_table_used) {
+		InputRecord *record = &input_table[idx1];
+		memcpy(record->prev_hash, txinput->prev_hash.bytes, 32);
+		record->prev_index = txinput->prev_index;
+		record->sequence = txinput->sequence;
+		record->script_type = txinput->script_type;
+	}
 	// hash prevout and script type to check it later (relevant for fee computation)
 	tx_prevout_hash(&hasher_check, txinput);
 	hasher_Update(&hasher_check, (const uint8_t *) &txinput->script_type, sizeof(&txinput->script_type));
@@ -796,6 +875,7 @@ static bool signing_check_prevtx_hash(void) {
 		signing_abort();
 		return false;
 	}
+	prevtx_cache_add();
 	phase1_request_next_input();
 	return true;
 }
@@ -885,7 +965,7 @@ static bool signing_check_fee(void) {
 	char total_amount_str[32];
 	char fee_str[32];
 	coin_amnt_to_str(coin, fee, fee_str, sizeof(fee_str));
-	if (fee > ((uint64_t) tx_weight * coin->maxfee_kb)/4000) {
+	if (tx_fee_over_threshold(coin, fee, tx_weight)) {
 		if (!confirm(ButtonRequestType_ButtonRequest_FeeOverThreshold,
 		             "Confirm Fee", "Really spend %s on fees? Except in times of high "
 		             "network congestion, fees should be less than %" PRIu64 " sat/byte.",
@@ -1062,6 +1142,60 @@ static bool signing_sign_hash(TxInputType *txinput, const uint8_t* private_key,
 	return true;
 }
 
+/* Phase 2 with the input table: check that the input to sign is the one seen
+ * in phase 1, then hash it together with the other inputs from the table. */
+static bool signing_hash_inputs_from_table(TxInputType *txinput) {
+	const InputRecord *record = &input_table[idx1];
+	if (memcmp(txinput->prev_hash.bytes, record->prev_hash, 32) != 0
+		|| txinput->prev_index != record->prev_index
+		|| txinput->sequence != record->sequence
+		|| txinput->script_type != record->script_type) {
+		fsm_sendFailure(FailureType_Failure_SyntaxError, _("Transaction has changed during signing"));
+		signing_abort();
+		return false;
+	}
+	if (!compile_input_script_sig(txinput)) {
+		fsm_sendFailure(FailureType_Failure_Other, _("Failed to compile input"));
+		signing_abort();
+		return false;
+	}
+	memcpy(&input, txinput, sizeof(input));
+	memcpy(privkey, node.private_key, 32);
+	memcpy(pubkey, node.public_key, 33);
+
+	// find the next input to sign in phase 2
+	if (next_nonsegwit_input == idx1) {
+		for (uint32_t i = idx1 + 1; i < inputs_count; i++) {
+			if (input_table[i].script_type == InputScriptType_SPENDADDRESS
+				|| input_table[i].script_type == InputScriptType_SPENDMULTISIG) {
+				next_nonsegwit_input = i;
+				break;
+			}
+		}
+	}
+
+	tx_init(&ti, inputs_count, outputs_count, version, lock_time, expiry, 0, curve->hasher_sign, overwintered, version_group_id);
+	for (uint32_t i = 0; i < inputs_count; i++) {
+		const TxInputType *serialized = &input;
+		if (i != idx1) {
+			// the request buffer is free once the input to sign is copied
+			memset(txinput, 0, sizeof(TxInputType));
+			txinput->prev_hash.size = 32;
+			memcpy(txinput->prev_hash.bytes, input_table[i].prev_hash, 32);
+			txinput->prev_index = input_table[i].prev_index;
+			txinput->has_sequence = true;
+			txinput->sequence = input_table[i].sequence;
+			serialized = txinput;
+		}
+		if (!tx_serialize_input_hash(&ti, serialized)) {
+			fsm_sendFailure(FailureType_Failure_Other, _("Failed to serialize input"));
+			signing_abort();
+			return false;
+		}
+	}
+	return true;
+}
+
 static bool signing_sign_input(void) {
 	uint8_t hash[32];
 	hasher_Final(&hasher_check, hash);
@@ -1218,7 +1352,19 @@ void signing_txack(TransactionType *tx)
 					// we need to sign during phase2
 					if (next_nonsegwit_input == 0xffffffff)
 						next_nonsegwit_input = idx1;
-					send_req_2_prev_meta();
+					uint64_t amount;
+					if (!coin->decred && prevtx_cache_lookup(&tx->inputs[0], &amount)) {
+						// prevtx was already streamed and checked for an earlier input
+						if (to_spend + amount < to_spend) {
+							fsm_sendFailure(FailureType_Failure_SyntaxError, _("Value overflow"));
+							signing_abort();
+							return;
+						}
+						to_spend += amount;
+						phase1_request_next_input();
+					} else {
+						send_req_2_prev_meta();
+					}
 				}
 			} else if  (tx->inputs[0].script_type == InputScriptType_SPENDWITNESS
 						|| tx->inputs[0].script_type == InputScriptType_SPENDP2SHWITNESS) {
@@ -1243,7 +1389,7 @@ void signing_txack(TransactionType *tx)
 					return;
 				}
 				if (!to.is_segwit) {
-					tx_weight += TXSIZE_SEGWIT_OVERHEAD + to.inputs_len;
+					tx_weight += tx_segwit_overhead_weight(to.inputs_len);
 				}
 #if !ENABLE_SEGWIT_NONSEGWIT_MIXING
 				// don't mix segwit and non-segwit inputs
@@ -1283,6 +1429,8 @@ void signing_txack(TransactionType *tx)
 				tp.is_decred = true;
 			}
 			progress_meta_step = progress_step / (tp.inputs_len + tp.outputs_len);
+			memcpy(prevtx_pending.hash, input.prev_hash.bytes, 32);
+			prevtx_pending.outputs_len = tp.outputs_len;
 			idx2 = 0;
 			if (tp.inputs_len > 0) {
 				send_req_2_prev_input();
@@ -1326,6 +1474,9 @@ void signing_txack(TransactionType *tx)
 				}
 				to_spend += tx->bin_outputs[0].amount;
 			}
+			if (idx2 < PREVTX_CACHE_OUTPUTS) {
+				prevtx_pending.amounts[idx2] = tx->bin_outputs[0].amount;
+			}
 			if (idx2 < tp.outputs_len - 1) {
 				/* Check prevtx of next input */
 				idx2++;
@@ -1359,6 +1510,15 @@ void signing_txack(TransactionType *tx)
 			return;
 		case STAGE_REQUEST_4_INPUT:
 			progress = 500 + ((signatures * progress_step + idx2 * progress_meta_step) >> PROGRESS_PRECISION);
+			if (input_table_used) {
+				if (!signing_hash_inputs_from_table(&tx->inputs[0])) {
+					return;
+				}
+				hasher_Reset(&hasher_check);
+				idx2 = 0;
+				send_req_4_output();
+				return;
+			}
 			if (idx2 == 0) {
 				tx_init(&ti, inputs_count, outputs_count, version, lock_time, expiry, 0, curve->hasher_sign, overwintered, version_group_id);
 				hasher_Reset(&hasher_check);
@@ -1625,6 +1785,9 @@ void signing_txack(TransactionType *tx)
 
 void signing_abort(void)
 {
+	prevtx_cache_clear();
+	memzero(input_table, sizeof(input_table));
+	input_table_used = false;
 	if (signing) {
 		layoutHome();
 		signing = false;
@@ -32,6 +32,7 @@
 
 #include "keepkey/board/common.h"
 #include "keepkey/board/supervise.h"
+#include "keepkey/board/timer.h"
 #include "keepkey/board/keepkey_board.h"
 #include "keepkey/board/keepkey_flash.h"
 #include "keepkey/board/memcmp_s.h"
@@ -39,6 +40,7 @@
 #include "keepkey/board/util.h"
 #include "keepkey/board/variant.h"
 #include "keepkey/firmware/fsm.h"
+#include "keepkey/firmware/node_cache.h"
 #include "keepkey/firmware/passphrase_sm.h"
 #include "keepkey/firmware/policy.h"
 #include "keepkey/firmware/u2f.h"
@@ -56,14 +58,6 @@
 #include <stdint.h>
 #include <assert.h>
 
-#if defined(EMULATOR) || defined(DEBUG_ON)
-#  define PIN_ITER_COUNT 1000
-#  define PIN_ITER_CHUNK 10
-#else
-#  define PIN_ITER_COUNT 100000
-#  define PIN_ITER_CHUNK 1000
-#endif
-
 #define U2F_KEY_PATH 0x80553246
 #define _(X) (X)
 
@@ -71,6 +65,10 @@ static SessionState CONFIDENTIAL session;
 
 static Allocation storage_location = FLASH_INVALID;
 
+/* storage_commit() calls that reached flash, and those that were no-ops */
+static uint32_t storage_commits_written;
+static uint32_t storage_commits_skipped;
+
 /* Shadow memory for configuration data in storage partition */
 _Static_assert(sizeof(ConfigFlash) <= FLASH_STORAGE_LEN,
                "ConfigFlash struct is too large for storage partition");
@@ -84,16 +82,13 @@ char debuglink_mnemonic[241];
 HDNode debuglink_node;
 #endif
 
-static void get_u2froot_callback(uint32_t iter, uint32_t total)
-{
-	layoutProgress(_("Updating"), 1000 * iter / total);
-}
-
 static void storage_compute_u2froot(SessionState *ss,
                                     const char *mnemonic,
                                     HDNodeType *u2froot) {
 	static CONFIDENTIAL HDNode node;
-	mnemonic_to_seed(mnemonic, "", ss->seed, get_u2froot_callback); // BIP-0039
+	ss->u2fRootCached = false;
+	memzero(&ss->u2fRoot, sizeof(ss->u2fRoot));
+	storage_mnemonicToSeed(mnemonic, "", ss->seed, _("Updating")); // BIP-0039
 	hdnode_from_seed(ss->seed, 64, NIST256P1_NAME, &node);
 	hdnode_private_ckd(&node, U2F_KEY_PATH);
 	u2froot->depth = node.depth;
@@ -108,12 +103,20 @@ static void storage_compute_u2froot(SessionState *ss,
 
 bool storage_getU2FRoot(HDNode *node)
 {
-	return shadow_config.storage.pub.has_u2froot &&
-	    hdnode_from_xprv(shadow_config.storage.pub.u2froot.depth,
-	                     shadow_config.storage.pub.u2froot.child_num,
-	                     shadow_config.storage.pub.u2froot.chain_code.bytes,
-	                     shadow_config.storage.pub.u2froot.private_key.bytes,
-	                     NIST256P1_NAME, node);
+	if (!session.u2fRootCached) {
+		if (!shadow_config.storage.pub.has_u2froot ||
+		    !hdnode_from_xprv(shadow_config.storage.pub.u2froot.depth,
+		                      shadow_config.storage.pub.u2froot.child_num,
+		                      shadow_config.storage.pub.u2froot.chain_code.bytes,
+		                      shadow_config.storage.pub.u2froot.private_key.bytes,
+		                      NIST256P1_NAME, &session.u2fRoot)) {
+			return false;
+		}
+		session.u2fRootCached = true;
+	}
+
+	memcpy(node, &session.u2fRoot, sizeof(*node));
+	return true;
 }
 
 uint32_t storage_nextU2FCounter(void) {
@@ -294,23 +297,29 @@ void storage_deriveWrappingKey(
         flash_readHWEntropy(salt, sizeof(salt));
         memcpy(salt + HW_ENTROPY_LEN, random_salt, RANDOM_SALT_LEN);
 
-        PBKDF2_HMAC_SHA256_CTX ctx = {0};
-        pbkdf2_hmac_sha256_Init(&ctx, (const uint8_t*)pin, pin_len, salt, sizeof(salt), 1);
-        for (int i = 0; i < PIN_ITER_COUNT; i += PIN_ITER_CHUNK) {
-	        layoutProgress(message, 1000 * i / (PIN_ITER_COUNT * 2));
-            pbkdf2_hmac_sha256_Update(&ctx, PIN_ITER_CHUNK);
-        }
-        pbkdf2_hmac_sha256_Final(&ctx, wrapping_key);
-        memzero(&ctx, sizeof(ctx));
+        // Each chain yields one half of the key. They share the PIN and the
+        // salt, and run in lockstep so that the progress bar fills once.
+        PBKDF2_HMAC_SHA256_CTX ctx[2];
+        memset(ctx, 0, sizeof(ctx));
+        pbkdf2_hmac_sha256_Init(&ctx[0], (const uint8_t*)pin, pin_len, salt, sizeof(salt), 1);
+        pbkdf2_hmac_sha256_Init(&ctx[1], (const uint8_t*)pin, pin_len, salt, sizeof(salt), 2);
 
-        pbkdf2_hmac_sha256_Init(&ctx, (const uint8_t*)pin, pin_len, salt, sizeof(salt), 2);
+        // A redraw costs about as much as a chunk of iterations, so keep to
+        // a fixed number of frames, however many chunks there are.
+        uint32_t next_frame = 0;
         for (int i = 0; i < PIN_ITER_COUNT; i += PIN_ITER_CHUNK) {
-	        layoutProgress(message, 1000 * (i + PIN_ITER_COUNT) / (PIN_ITER_COUNT * 2));
-            pbkdf2_hmac_sha256_Update(&ctx, PIN_ITER_CHUNK);
+            uint32_t permil = 1000 * i / PIN_ITER_COUNT;
+            if (permil >= next_frame) {
+                layoutProgress(message, permil);
+                next_frame = permil + 1000 / PIN_PROGRESS_FRAMES;
+            }
+            pbkdf2_hmac_sha256_Update(&ctx[0], PIN_ITER_CHUNK);
+            pbkdf2_hmac_sha256_Update(&ctx[1], PIN_ITER_CHUNK);
         }
-	    layoutProgress(message, 1000);
-        pbkdf2_hmac_sha256_Final(&ctx, wrapping_key + 32);
-        memzero(&ctx, sizeof(ctx));
+        layoutProgress(message, 1000);
+        pbkdf2_hmac_sha256_Final(&ctx[0], wrapping_key);
+        pbkdf2_hmac_sha256_Final(&ctx[1], wrapping_key + 32);
+        memzero(ctx, sizeof(ctx));
 
         memzero(salt, sizeof(salt));
     } else {
@@ -520,6 +529,7 @@ void storage_readStorageV1(SessionState *ss, Storage *storage, const char *ptr,
     storage->pub.auto_lock_delay_ms = STORAGE_DEFAULT_SCREENSAVER_TIMEOUT;
 
     // Can't do derivation here, since the pin hasn't been entered.
+    ss->u2fRootCached = false;
     storage->pub.has_u2froot = false;
     memzero(&storage->pub.u2froot, sizeof(storage->pub.u2froot));
     storage->pub.u2f_counter = 0;
@@ -826,7 +836,8 @@ static void wear_leveling_shift(void)
 ///
 /// \param cfg[in]    The active storage sector.
 /// \param seed[in]   Root seed to write into storage.
-/// \param curve[in]  ECDSA curve name being used.
+/// \param curve[in]  ECDSA curve name being used, recorded for older
+///                   firmware, which only reuses the seed for that curve.
 static void storage_setRootSeedCache(const SessionState *ss,
                                      ConfigFlash *cfg, const uint8_t *seed,
                                      const char* curve)
@@ -835,6 +846,13 @@ static void storage_setRootSeedCache(const SessionState *ss,
     if (cfg->storage.pub.passphrase_protection && strlen(ss->passphrase))
         return;
 
+    // The seed does not depend on the curve, so a cache that already holds
+    // it is left alone rather than erased and rewritten for a new label.
+    if (cfg->storage.sec.cache.root_seed_cache_status == CACHE_EXISTS &&
+        memcmp(cfg->storage.sec.cache.root_seed_cache, seed,
+               sizeof(cfg->storage.sec.cache.root_seed_cache)) == 0)
+        return;
+
     memset(&cfg->storage.sec.cache, 0, sizeof(cfg->storage.sec.cache));
 
     memcpy(&cfg->storage.sec.cache.root_seed_cache, seed,
@@ -850,13 +868,14 @@ static void storage_setRootSeedCache(const SessionState *ss,
 
 /// \brief Get root session seed cache from storage.
 ///
+/// The BIP39 seed does not depend on the curve, so the cache is used
+/// whichever curve it was written for.
+///
 /// \param cfg[in]   The active storage sector.
-/// \param curve[in] ECDSA curve name being used.
 /// \param seed[out] The root seed value.
 /// \returns true on success.
 static bool storage_getRootSeedCache(const SessionState *ss, ConfigFlash *cfg,
-                                     const char *curve, bool usePassphrase,
-                                     uint8_t *seed)
+                                     bool usePassphrase, uint8_t *seed)
 {
     if (!cfg->storage.has_sec)
         return false;
@@ -869,10 +888,6 @@ static bool storage_getRootSeedCache(const SessionState *ss, ConfigFlash *cfg,
         return false;
     }
 
-    if (strcmp(cfg->storage.sec.cache.root_ecdsa_curve_type, curve) != 0) {
-        return false;
-    }
-
     memset(seed, 0, sizeof(ss->seed));
     memcpy(seed, &cfg->storage.sec.cache.root_seed_cache,
            sizeof(cfg->storage.sec.cache.root_seed_cache));
@@ -966,6 +981,7 @@ void storage_reset_impl(SessionState *ss, ConfigFlash *cfg)
     cfg->storage.version = STORAGE_VERSION;
 
     memzero(ss, sizeof(*ss));
+    node_cache_clear();
 
     cfg->storage.has_sec = false;
     memzero(&cfg->storage.sec, sizeof(cfg->storage.sec));
@@ -973,6 +989,7 @@ void storage_reset_impl(SessionState *ss, ConfigFlash *cfg)
 
 void storage_wipe(void)
 {
+    node_cache_clear();
     flash_erase_word(FLASH_STORAGE1);
     flash_erase_word(FLASH_STORAGE2);
     flash_erase_word(FLASH_STORAGE3);
@@ -1000,9 +1017,17 @@ pintest_t session_clear_impl(SessionState *ss, Storage *storage, bool clear_pin)
 */
     pintest_t ret = PIN_WRONG;
 
+    node_cache_clear();
+
     ss->seedCached = false;
     memset(&ss->seed, 0, sizeof(ss->seed));
 
+    memzero(ss->rootNodes, sizeof(ss->rootNodes));
+    ss->rootNodesNext = 0;
+
+    ss->u2fRootCached = false;
+    memzero(&ss->u2fRoot, sizeof(ss->u2fRoot));
+
     ss->passphraseCached = false;
     memset(&ss->passphrase, 0, sizeof(ss->passphrase));
 
@@ -1056,6 +1081,19 @@ void storage_commit(void)
 
     memcpy(&shadow_config, STORAGE_MAGIC_STR, STORAGE_MAGIC_LEN);
 
+    /* Nothing to do if the active sector already holds these bytes */
+    if (storage_location >= FLASH_STORAGE1 && storage_location <= FLASH_STORAGE3) {
+        const char *flash = (const char *)flash_write_helper(storage_location);
+        if (storage_isActiveSector(flash) &&
+            memcmp(flash, flash_temp, sizeof(flash_temp)) == 0) {
+            memzero(flash_temp, sizeof(flash_temp));
+            storage_commits_skipped++;
+            return;
+        }
+    }
+
+    storage_commits_written++;
+
     uint32_t retries = 0;
     for (retries = 0; retries < STORAGE_RETRIES; retries++) {
         /* Capture CRC for verification at restore */
@@ -1367,12 +1405,60 @@ uint32_t storage_getPinFails(void)
     return shadow_config.storage.pub.pin_failed_attempts;
 }
 
-/// \brief Calls animation callback.
-/// \param iter Current iteration.
-/// \param total Total iterations.
-static void get_root_node_callback(uint32_t iter, uint32_t total)
+uint32_t storage_getCommitsWritten(void)
+{
+    return storage_commits_written;
+}
+
+uint32_t storage_getCommitsSkipped(void)
+{
+    return storage_commits_skipped;
+}
+
+void storage_pbkdf2_sha512(const uint8_t *pass, size_t pass_len,
+                           const uint8_t *salt, size_t salt_len,
+                           uint32_t rounds, uint8_t key[64], const char *desc)
 {
-    animating_progress_handler(_("Waking up"), 1000 * iter / total);
+    // The context keeps the hashed ipad/opad blocks from Init, so each
+    // round below costs two compressions rather than four.
+    static CONFIDENTIAL PBKDF2_HMAC_SHA512_CTX ctx;
+    pbkdf2_hmac_sha512_Init(&ctx, pass, pass_len, salt, salt_len, 1);
+
+    animating_progress_handler(desc, 0);
+    uint32_t last_frame = timer_ms();
+
+    for (uint32_t i = 0; i < rounds; i += SEED_PROGRESS_CHUNK) {
+        uint32_t chunk = rounds - i < SEED_PROGRESS_CHUNK ? rounds - i
+                                                          : SEED_PROGRESS_CHUNK;
+        pbkdf2_hmac_sha512_Update(&ctx, chunk);
+
+        // Redraw on a clock rather than per chunk, so that a fast core
+        // spends its time hashing instead of pushing frames.
+        if (timer_ms() - last_frame >= SEED_PROGRESS_FRAME_MS) {
+            animating_progress_handler(desc, 1000ULL * (i + chunk) / rounds);
+            last_frame = timer_ms();
+        }
+    }
+
+    pbkdf2_hmac_sha512_Final(&ctx, key);
+    memzero(&ctx, sizeof(ctx));
+
+    animating_progress_handler(desc, 1000);
+}
+
+void storage_mnemonicToSeed(const char *mnemonic, const char *passphrase,
+                            uint8_t seed[64], const char *desc)
+{
+    // BIP-0039: salt is "mnemonic" followed by the passphrase.
+    static CONFIDENTIAL uint8_t salt[8 + 256];
+    size_t passphrase_len = strnlen(passphrase, 256);
+    memcpy(salt, "mnemonic", 8);
+    memcpy(salt + 8, passphrase, passphrase_len);
+
+    storage_pbkdf2_sha512((const uint8_t *)mnemonic, strlen(mnemonic),
+                          salt, 8 + passphrase_len, BIP39_PBKDF2_ROUNDS,
+                          seed, desc);
+    memzero(salt, sizeof(salt));
 }
 
 const uint8_t *storage_getSeed(const ConfigFlash *cfg, bool usePassphrase)
@@ -1393,9 +1479,9 @@ const uint8_t *storage_getSeed(const ConfigFlash *cfg, bool usePassphrase)
             return NULL;
         }
 
-        mnemonic_to_seed(cfg->storage.sec.mnemonic,
-                         usePassphrase ? session.passphrase : "",
-                         session.seed, get_root_node_callback); // BIP-0039
+        storage_mnemonicToSeed(cfg->storage.sec.mnemonic,
+                               usePassphrase ? session.passphrase : "",
+                               session.seed, _("Waking up")); // BIP-0039
         session.seedCached = true;
         session.seedUsesPassphrase = usePassphrase;
         return session.seed;
@@ -1404,7 +1490,55 @@ const uint8_t *storage_getSeed(const ConfigFlash *cfg, bool usePassphrase)
     return NULL;
 }
 
+void session_cacheRootNode(SessionState *ss, const char *curve,
+                           bool usePassphrase, const HDNode *node)
+{
+    if (strlen(curve) >= sizeof(ss->rootNodes[0].curve))
+        return;
+
+    RootNodeCache *entry = NULL;
+    for (int i = 0; i < ROOT_NODE_CACHE_COUNT; i++) {
+        if (ss->rootNodes[i].cached &&
+            ss->rootNodes[i].usesPassphrase == usePassphrase &&
+            strcmp(ss->rootNodes[i].curve, curve) == 0) {
+            entry = &ss->rootNodes[i];
+            break;
+        }
+    }
+
+    if (!entry) {
+        entry = &ss->rootNodes[ss->rootNodesNext];
+        ss->rootNodesNext = (ss->rootNodesNext + 1) % ROOT_NODE_CACHE_COUNT;
+    }
+
+    entry->cached = true;
+    entry->usesPassphrase = usePassphrase;
+    strlcpy(entry->curve, curve, sizeof(entry->curve));
+    memcpy(&entry->node, node, sizeof(entry->node));
+}
+
+bool session_getCachedRootNode(const SessionState *ss, const char *curve,
+                               bool usePassphrase, HDNode *node)
+{
+    for (int i = 0; i < ROOT_NODE_CACHE_COUNT; i++) {
+        if (ss->rootNodes[i].cached &&
+            ss->rootNodes[i].usesPassphrase == usePassphrase &&
+            strcmp(ss->rootNodes[i].curve, curve) == 0) {
+            memcpy(node, &ss->rootNodes[i].node, sizeof(*node));
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool storage_getRootNode(const char *curve, bool usePassphrase, HDNode *node) {
+    // Interleaved requests for different chains each need their own curve's
+    // root; keep them all for the session rather than re-deriving.
+    if (session_getCachedRootNode(&session, curve, usePassphrase, node)) {
+        return true;
+    }
+
     // if storage has node, decrypt and use it
     if (shadow_config.storage.pub.has_node && strcmp(curve, SECP256K1_NAME) == 0) {
         if (!shadow_config.storage.has_sec) {
@@ -1429,13 +1563,10 @@ bool storage_getRootNode(const char *curve, bool usePassphrase, HDNode *node) {
             strlen(session.passphrase) > 0) {
             // decrypt hd node
             static uint8_t CONFIDENTIAL secret[64];
-            PBKDF2_HMAC_SHA512_CTX pctx;
-            pbkdf2_hmac_sha512_Init(&pctx, (const uint8_t *)session.passphrase, strlen(session.passphrase), (const uint8_t *)"TREZORHD", 8, 1);
-            for (int i = 0; i < 8; i++) {
-                pbkdf2_hmac_sha512_Update(&pctx, BIP39_PBKDF2_ROUNDS / 8);
-                get_root_node_callback((i + 1) * BIP39_PBKDF2_ROUNDS / 8, BIP39_PBKDF2_ROUNDS);
-            }
-            pbkdf2_hmac_sha512_Final(&pctx, secret);
+            storage_pbkdf2_sha512((const uint8_t *)session.passphrase,
+                                  strlen(session.passphrase),
+                                  (const uint8_t *)"TREZORHD", 8,
+                                  BIP39_PBKDF2_ROUNDS, secret, _("Waking up"));
             aes_decrypt_ctx ctx;
             aes_decrypt_key256(secret, &ctx);
             aes_cbc_decrypt(node->chain_code, node->chain_code, 32, secret + 32, &ctx);
@@ -1444,6 +1575,7 @@ bool storage_getRootNode(const char *curve, bool usePassphrase, HDNode *node) {
             memzero(secret, sizeof(secret));
         }
 
+        session_cacheRootNode(&session, curve, usePassphrase, node);
         return true;
     }
 
@@ -1459,7 +1591,7 @@ bool storage_getRootNode(const char *curve, bool usePassphrase, HDNode *node) {
         }
 
         if(!session.seedCached) {
-            session.seedCached = storage_getRootSeedCache(&session, &shadow_config, curve, usePassphrase, session.seed);
+            session.seedCached = storage_getRootSeedCache(&session, &shadow_config, usePassphrase, session.seed);
 
             if(!session.seedCached) {
                 /* calculate session seed and update the global sessionSeed/sessionSeedCached variables */
@@ -1474,6 +1606,7 @@ bool storage_getRootNode(const char *curve, bool usePassphrase, HDNode *node) {
         }
 
         if (hdnode_from_seed(session.seed, 64, curve, node) == 1) {
+            session_cacheRootNode(&session, curve, usePassphrase, node);
             return true;
         }
     }
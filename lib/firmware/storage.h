@@ -73,6 +73,16 @@ typedef struct _ConfigFlash {
     Storage storage;
 } ConfigFlash;
 
+/// Number of curves whose root node is kept in RAM for the session.
+#define ROOT_NODE_CACHE_COUNT 4
+
+typedef struct _RootNodeCache {
+    bool cached;
+    bool usesPassphrase;
+    char curve[24];
+    HDNode node;
+} RootNodeCache;
+
 typedef struct _SessionState {
     bool seedUsesPassphrase;
     bool seedCached;
@@ -83,6 +93,12 @@ typedef struct _SessionState {
 
     bool passphraseCached;
     char passphrase[51];
+
+    RootNodeCache rootNodes[ROOT_NODE_CACHE_COUNT];
+    uint8_t rootNodesNext;
+
+    bool u2fRootCached;
+    HDNode u2fRoot;
 } SessionState;
 
 typedef enum {
@@ -93,8 +109,35 @@ typedef enum {
 
 #define MAX_MNEMONIC_LEN 240
 
+#if defined(EMULATOR) || defined(DEBUG_ON)
+#  define PIN_ITER_COUNT 1000
+#  define PIN_ITER_CHUNK 10
+#else
+#  define PIN_ITER_COUNT 100000
+#  define PIN_ITER_CHUNK 1000
+#endif
+
+/// Most times the progress bar is redrawn while stretching a PIN.
+#define PIN_PROGRESS_FRAMES 25
+
+/// Shortest time between progress redraws while deriving a seed.
+#define SEED_PROGRESS_FRAME_MS 100
+
+/// PBKDF2 rounds run between checks of the redraw clock.
+#define SEED_PROGRESS_CHUNK 16
+
 void storage_loadNode(HDNode *dst, const HDNodeType *src);
 
+/// PBKDF2-HMAC-SHA512 with a progress bar that is redrawn at most once
+/// every SEED_PROGRESS_FRAME_MS.
+void storage_pbkdf2_sha512(const uint8_t *pass, size_t pass_len,
+                           const uint8_t *salt, size_t salt_len,
+                           uint32_t rounds, uint8_t key[64], const char *desc);
+
+/// BIP-0039 mnemonic to seed, showing \p desc on the progress bar.
+void storage_mnemonicToSeed(const char *mnemonic, const char *passphrase,
+                            uint8_t seed[64], const char *desc);
+
 /// Derive the wrapping key from the user's pin.
 void storage_deriveWrappingKey(const char *pin, uint8_t wrapping_key[64],
     bool sca_hardened, uint8_t random_salt[RANDOM_SALT_LEN],
@@ -134,6 +177,15 @@ bool storage_hasPin_impl(const Storage *storage);
 ///          PIN_REWRAP -> PIN is correct, storage key was rewrapped, CALLING FUNCTION SHOULD storage_commit()
 pintest_t session_clear_impl(SessionState *session, Storage *storage, bool clear_pin);
 
+/// \brief Remember the root node for a curve until the session is cleared.
+void session_cacheRootNode(SessionState *ss, const char *curve,
+                           bool usePassphrase, const HDNode *node);
+
+/// \brief Look up a root node stored by session_cacheRootNode().
+/// \returns true iff \p node was filled in.
+bool session_getCachedRootNode(const SessionState *ss, const char *curve,
+                               bool usePassphrase, HDNode *node);
+
 /// \brief Get user private seed.
 /// \returns NULL on error, otherwise \returns the private seed.
 const uint8_t *storage_getSeed(const ConfigFlash *cfg, bool usePassphrase);
@@ -1,11 +1,13 @@
 #include "keepkey/firmware/tendermint.h"
 
 #include "keepkey/firmware/fsm.h"
+#include "trezor/crypto/memzero.h"
 #include "trezor/crypto/segwit_addr.h"
 #include "trezor/crypto/sha2.h"
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 bool tendermint_pathMismatched(const CoinType *coin,
                                const uint32_t *address_n,
@@ -42,34 +44,68 @@ bool tendermint_getAddress(const HDNode *node, const char *prefix, char *address
     return bech32_encode(address, prefix, fiveBitExpanded, len) == 1;
 }
 
-void tendermint_sha256UpdateEscaped(SHA256_CTX *ctx, const char *s, size_t len)
+void tendermint_jsonInit(TendermintJson *json)
 {
-    for (size_t i = 0; i != len; i++) {
-        if (s[i] == '"') {
-            sha256_Update(ctx, (const uint8_t *)"\\\"", 2);
-        } else if (s[i] == '\\') {
-            sha256_Update(ctx, (const uint8_t *)"\\\\", 2);
-        } else {
-            // The copy here is required (as opposed to a cast), since the
-            // source is a character array, and sha256_Update uses it as if it
-            // were an array of uint8_t, which would violate the strict aliasing
-            // rule.
-            const uint8_t c = s[i];
-            sha256_Update(ctx, &c, 1);
+    sha256_Init(&json->ctx);
+    json->len = 0;
+}
+
+static void tendermint_jsonPut(TendermintJson *json, uint8_t c)
+{
+    json->buf[json->len++] = c;
+    if (json->len == sizeof(json->buf)) {
+        sha256_Update(&json->ctx, json->buf, sizeof(json->buf));
+        json->len = 0;
+    }
+}
+
+void tendermint_jsonRaw(TendermintJson *json, const char *s, size_t len)
+{
+    while (len) {
+        size_t n = sizeof(json->buf) - json->len;
+        if (n > len)
+            n = len;
+
+        memcpy(json->buf + json->len, s, n);
+        json->len += n;
+        s += n;
+        len -= n;
+
+        if (json->len == sizeof(json->buf)) {
+            sha256_Update(&json->ctx, json->buf, sizeof(json->buf));
+            json->len = 0;
         }
     }
 }
 
-bool tendermint_snprintf(SHA256_CTX *ctx, char *temp, size_t len, const char *format, ...)
+void tendermint_jsonEscaped(TendermintJson *json, const char *s, size_t len)
 {
+    for (size_t i = 0; i != len; i++) {
+        if (s[i] == '"' || s[i] == '\\')
+            tendermint_jsonPut(json, '\\');
+        tendermint_jsonPut(json, s[i]);
+    }
+}
+
+bool tendermint_jsonPrintf(TendermintJson *json, const char *format, ...)
+{
+    char temp[64 + 1];
+
     va_list vl;
     va_start(vl, format);
-    int n = vsnprintf(temp, len, format, vl);
+    int n = vsnprintf(temp, sizeof(temp), format, vl);
     va_end(vl);
 
-    if (n < 0 || (size_t)n >= len)
+    if (n < 0 || (size_t)n >= sizeof(temp))
         return false;
 
-    sha256_Update(ctx, (const uint8_t *)temp, n);
+    tendermint_jsonRaw(json, temp, n);
     return true;
 }
+
+void tendermint_jsonFinal(TendermintJson *json, uint8_t hash[SHA256_DIGEST_LENGTH])
+{
+    sha256_Update(&json->ctx, json->buf, json->len);
+    sha256_Final(&json->ctx, hash);
+    memzero(json, sizeof(*json));
+}
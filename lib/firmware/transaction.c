@@ -25,6 +25,7 @@
 #include "keepkey/firmware/app_confirm.h"
 #include "keepkey/firmware/coins.h"
 #include "keepkey/firmware/crypto.h"
+#include "keepkey/firmware/node_cache.h"
 #include "keepkey/transport/interface.h"
 #include "trezor/crypto/address.h"
 #include "trezor/crypto/base58.h"
@@ -44,6 +45,12 @@
 #define CASHADDR_P2SH (8)
 #define CASHADDR_160  (0)
 
+/* transaction header size: 4 byte version */
+#define TXSIZE_HEADER 4
+/* transaction footer size: 4 byte lock time */
+#define TXSIZE_FOOTER 4
+/* transaction segwit overhead 2 marker */
+#define TXSIZE_SEGWIT_OVERHEAD 2
 /* transaction input size (without script): 32 prevhash, 4 idx, 4 sequence */
 #define TXSIZE_INPUT 40
 /* transaction output size (without script): 8 amount */
@@ -247,7 +254,7 @@ int compile_output(const CoinType *coin, const HDNode *root, TxOutputType *in, T
 				return 0; // failed to compile output
 		}
 		memcpy(&node, root, sizeof(HDNode));
-		if (hdnode_private_ckd_cached(&node, in->address_n, in->address_n_count, NULL) == 0) {
+		if (node_cache_derive(&node, in->address_n, in->address_n_count, NULL) == 0) {
 			return 0; // failed to compile output
 		}
 		hdnode_fill_public_key(&node);
@@ -841,13 +848,13 @@ void tx_hash_final(TxStruct *t, uint8_t *hash, bool reverse)
 	}
 }
 
-static uint32_t tx_input_script_size(const TxInputType *txinput) {
+static uint32_t tx_input_script_size(uint32_t multisig_m, uint32_t multisig_n) {
 	uint32_t input_script_size;
-	if (txinput->has_multisig) {
+	if (multisig_n > 0) {
 		uint32_t multisig_script_size = TXSIZE_MULTISIGSCRIPT
-			+ txinput->multisig.pubkeys_count * (1 + TXSIZE_PUBKEY);
+			+ multisig_n * (1 + TXSIZE_PUBKEY);
 		input_script_size = 1 // the OP_FALSE bug in multisig
-			+ txinput->multisig.m * (1 + TXSIZE_SIGNATURE)
+			+ multisig_m * (1 + TXSIZE_SIGNATURE)
 			+ op_push_size(multisig_script_size) + multisig_script_size;
 	} else {
 		input_script_size = (1 + TXSIZE_SIGNATURE + 1 + TXSIZE_PUBKEY);
@@ -856,21 +863,37 @@ static uint32_t tx_input_script_size(const TxInputType *txinput) {
 	return input_script_size;
 }
 
-uint32_t tx_input_weight(const CoinType *coin, const TxInputType *txinput) {
+uint32_t tx_base_weight(const CoinType *coin, uint32_t inputs_count, uint32_t outputs_count) {
+	uint32_t size = TXSIZE_HEADER + TXSIZE_FOOTER + ser_length_size(inputs_count) + ser_length_size(outputs_count);
+	if (coin->decred) {
+		size += 4; // Decred expiry
+		size += ser_length_size(inputs_count); // Witness inputs count
+	}
+
+	return 4 * size;
+}
+
+uint32_t tx_segwit_overhead_weight(uint32_t inputs_count) {
+	// marker and flag, plus one witness item count per input (discounted)
+	return TXSIZE_SEGWIT_OVERHEAD + inputs_count;
+}
+
+uint32_t tx_input_weight_for(const CoinType *coin, InputScriptType script_type,
+                             uint32_t multisig_m, uint32_t multisig_n) {
 	if (coin->decred) {
 		return 4 * (TXSIZE_INPUT + 1); // Decred tree
 	}
 
-	uint32_t input_script_size = tx_input_script_size(txinput);
+	uint32_t input_script_size = tx_input_script_size(multisig_m, multisig_n);
 	uint32_t weight = 4 * TXSIZE_INPUT;
-	if (txinput->script_type == InputScriptType_SPENDADDRESS
-		|| txinput->script_type == InputScriptType_SPENDMULTISIG) {
+	if (script_type == InputScriptType_SPENDADDRESS
+		|| script_type == InputScriptType_SPENDMULTISIG) {
 		input_script_size += ser_length_size(input_script_size);
 		weight += 4 * input_script_size;
-	} else if (txinput->script_type == InputScriptType_SPENDWITNESS
-			   || txinput->script_type == InputScriptType_SPENDP2SHWITNESS) {
-		if (txinput->script_type == InputScriptType_SPENDP2SHWITNESS) {
-			weight += 4 * (2 + (txinput->has_multisig
+	} else if (script_type == InputScriptType_SPENDWITNESS
+			   || script_type == InputScriptType_SPENDP2SHWITNESS) {
+		if (script_type == InputScriptType_SPENDP2SHWITNESS) {
+			weight += 4 * (2 + (multisig_n > 0
 								? TXSIZE_WITNESSSCRIPT : TXSIZE_WITNESSPKHASH));
 		} else {
 			weight += 4; // empty input script
@@ -880,19 +903,27 @@ uint32_t tx_input_weight(const CoinType *coin, const TxInputType *txinput) {
 	return weight;
 }
 
-uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const TxOutputType *txoutput) {
+uint32_t tx_input_weight(const CoinType *coin, const TxInputType *txinput) {
+	return tx_input_weight_for(coin, txinput->script_type,
+	                           txinput->has_multisig ? txinput->multisig.m : 0,
+	                           txinput->has_multisig ? txinput->multisig.pubkeys_count : 0);
+}
+
+uint32_t tx_output_weight_for(const CoinType *coin, const curve_info *curve,
+                              OutputScriptType script_type, bool change, bool multisig,
+                              uint32_t op_return_size, const char *address) {
 	uint32_t output_script_size = 0;
-	if (txoutput->script_type == OutputScriptType_PAYTOOPRETURN) {
-		output_script_size = 1 + op_push_size(txoutput->op_return_data.size)
-			+ txoutput->op_return_data.size;
-	} else if (txoutput->address_n_count > 0) {
-		if (txoutput->script_type == OutputScriptType_PAYTOWITNESS) {
-			output_script_size = txoutput->has_multisig
+	if (script_type == OutputScriptType_PAYTOOPRETURN) {
+		output_script_size = 1 + op_push_size(op_return_size)
+			+ op_return_size;
+	} else if (change) {
+		if (script_type == OutputScriptType_PAYTOWITNESS) {
+			output_script_size = multisig
 				? TXSIZE_WITNESSSCRIPT : TXSIZE_WITNESSPKHASH;
-		} else if (txoutput->script_type == OutputScriptType_PAYTOP2SHWITNESS) {
+		} else if (script_type == OutputScriptType_PAYTOP2SHWITNESS) {
 			output_script_size = TXSIZE_P2SCRIPT;
 		} else {
-			output_script_size = txoutput->has_multisig
+			output_script_size = multisig
 				? TXSIZE_P2SCRIPT : TXSIZE_P2PKHASH;
 		}
 	} else {
@@ -900,7 +931,7 @@ uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const T
 		int witver;
 		size_t addr_raw_len;
 		if (coin->has_cashaddr_prefix
-			&& cash_addr_decode(addr_raw, &addr_raw_len, coin->cashaddr_prefix, txoutput->address)) {
+			&& cash_addr_decode(addr_raw, &addr_raw_len, coin->cashaddr_prefix, address)) {
 			if (addr_raw_len == 21
 				&& addr_raw[0] == (CASHADDR_P2KH | CASHADDR_160)) {
 				output_script_size = TXSIZE_P2PKHASH;
@@ -909,10 +940,10 @@ uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const T
 				output_script_size = TXSIZE_P2SCRIPT;
 			}
 		} else if (coin->has_bech32_prefix
-			&& segwit_addr_decode(&witver, addr_raw, &addr_raw_len, coin->bech32_prefix, txoutput->address)) {
+			&& segwit_addr_decode(&witver, addr_raw, &addr_raw_len, coin->bech32_prefix, address)) {
 			output_script_size = 2 + addr_raw_len;
 		} else {
-			addr_raw_len = base58_decode_check(txoutput->address, curve->hasher_base58, addr_raw, MAX_ADDR_RAW_SIZE);
+			addr_raw_len = base58_decode_check(address, curve->hasher_base58, addr_raw, MAX_ADDR_RAW_SIZE);
 			if (coin->has_address_type
 				&& address_check_prefix(addr_raw, coin->address_type)) {
 				output_script_size = TXSIZE_P2PKHASH;
@@ -932,9 +963,28 @@ uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const T
 	return 4 * (size + output_script_size);
 }
 
-uint32_t tx_decred_witness_weight(const TxInputType *txinput) {
-	uint32_t input_script_size = tx_input_script_size(txinput);
+uint32_t tx_output_weight(const CoinType *coin, const curve_info *curve, const TxOutputType *txoutput) {
+	return tx_output_weight_for(coin, curve, txoutput->script_type,
+	                            txoutput->address_n_count > 0, txoutput->has_multisig,
+	                            txoutput->op_return_data.size, txoutput->address);
+}
+
+uint32_t tx_decred_witness_weight_for(uint32_t multisig_m, uint32_t multisig_n) {
+	uint32_t input_script_size = tx_input_script_size(multisig_m, multisig_n);
 	uint32_t size = TXSIZE_DECRED_WITNESS + ser_length_size(input_script_size) + input_script_size;
 
 	return 4 * size;
 }
+
+uint32_t tx_decred_witness_weight(const TxInputType *txinput) {
+	return tx_decred_witness_weight_for(txinput->has_multisig ? txinput->multisig.m : 0,
+	                                    txinput->has_multisig ? txinput->multisig.pubkeys_count : 0);
+}
+
+uint64_t tx_fee_threshold(const CoinType *coin, uint32_t weight) {
+	return ((uint64_t) weight * coin->maxfee_kb)/4000;
+}
+
+bool tx_fee_over_threshold(const CoinType *coin, uint64_t fee, uint32_t weight) {
+	return fee > tx_fee_threshold(coin, weight);
+}
@@ -20,6 +20,7 @@
 #include "keepkey/firmware/u2f.h"
 
 #include "storage.h"
+#include "u2f.h"
 #include "u2f_knownapps.h"
 
 #include "keepkey/board/keepkey_button.h"
@@ -69,11 +70,6 @@ static uint8_t u2f_out_packets[U2F_OUT_PKT_BUFFER_LEN][HID_RPT_SIZE];
 #endif
 
 #define U2F_PUBKEY_LEN 65
-#define KEY_PATH_LEN 32
-#define KEY_HANDLE_LEN (KEY_PATH_LEN + SHA256_DIGEST_LENGTH)
-
-// Derivation path is m/U2F'/r'/r'/r'/r'/r'/r'/r'/r'
-#define KEY_PATH_ENTRIES (KEY_PATH_LEN / sizeof(uint32_t))
 
 // Defined as UsbSignHandler.BOGUS_APP_ID_HASH
 // in https://github.com/google/u2f-ref-code/blob/master/u2f-chrome-extension/usbsignhandler.js#L118
@@ -121,141 +117,211 @@ uint32_t next_cid(void)
 // With a packet size of 64 bytes (max for full-speed devices), this means that
 // the maximum message payload length is 64 - 7 + 128 * (64 - 5) = 7609 bytes.
 #define U2F_MAXIMUM_PAYLOAD_LENGTH 7609
-typedef struct {
-	uint8_t buf[U2F_MAXIMUM_PAYLOAD_LENGTH];
-	uint8_t *buf_ptr;
-	uint32_t len;
-	uint8_t seq;
-	uint8_t cmd;
-} U2F_ReadBuffer;
 
-U2F_ReadBuffer *reader;
+// Messages being reassembled, one per channel.
+static U2F_Channel channels[U2F_CHANNEL_COUNT];
+static uint32_t channel_clock;
+static uint32_t channel_completions;
 
-void u2fhid_read(char tiny, const U2FHID_FRAME *f)
+// Channel whose register/authenticate request owns the confirm dialog.
+static uint32_t prompt_cid = 0;
+
+static U2F_Channel *u2f_channels_find(uint32_t fcid)
 {
-	// Always handle init packets directly
-	if (f->init.cmd == U2FHID_INIT) {
-		u2fhid_init(f);
-		if (tiny && reader && f->cid == cid) {
-			// abort current channel
-			reader->cmd = 0;
-			reader->len = 0;
-			reader->seq = 255;
-		}
-		return;
+	for (int i = 0; i < U2F_CHANNEL_COUNT; i++) {
+		if (channels[i].cid == fcid)
+			return &channels[i];
 	}
+	return NULL;
+}
 
-	if (tiny) {
-		// read continue packet
-		if (reader == 0 || cid != f->cid) {
-			send_u2fhid_error(f->cid, ERR_CHANNEL_BUSY);
-			return;
-		}
+void u2f_channels_release(U2F_Channel *ch)
+{
+	memzero(ch, sizeof(*ch));
+}
 
-		if ((f->type & TYPE_INIT) && reader->seq == 255) {
-			u2fhid_init_cmd(f);
-			return;
+void u2f_channels_reset(void)
+{
+	memzero(channels, sizeof(channels));
+	channel_clock = 0;
+	channel_completions = 0;
+}
+
+void u2f_channels_abort(uint32_t fcid)
+{
+	U2F_Channel *ch = u2f_channels_find(fcid);
+	if (ch && !ch->busy)
+		u2f_channels_release(ch);
+}
+
+uint8_t u2f_channels_frame(const U2FHID_FRAME *f)
+{
+	U2F_Channel *ch = f->cid ? u2f_channels_find(f->cid) : NULL;
+
+	if (f->type & TYPE_INIT) {
+		// Broadcast is reserved for init
+		if (f->cid == CID_BROADCAST || f->cid == 0)
+			return ERR_INVALID_CID;
+
+		if ((unsigned)MSG_LEN(*f) > sizeof(ch->buf))
+			return ERR_INVALID_LEN;
+
+		if (ch && ch->busy)
+			return ERR_CHANNEL_BUSY;
+
+		// Take a free slot, or else the partial message that has been quiet
+		// the longest. Complete messages are still queued for an answer, so
+		// they are never evicted.
+		for (int i = 0; !ch && i < U2F_CHANNEL_COUNT; i++) {
+			if (channels[i].cid == 0)
+				ch = &channels[i];
+		}
+		if (!ch) {
+			for (int i = 0; i < U2F_CHANNEL_COUNT; i++) {
+				if (channels[i].busy || channels[i].completed)
+					continue;
+				if (!ch || channels[i].last_used < ch->last_used)
+					ch = &channels[i];
+			}
 		}
+		if (!ch)
+			return ERR_CHANNEL_BUSY;
+
+		u2f_channels_release(ch);
+		ch->cid = f->cid;
+		ch->cmd = f->init.cmd;
+		ch->len = MSG_LEN(*f);
+		ch->received = MIN(sizeof(f->init.data), ch->len);
+		memcpy(ch->buf, f->init.data, ch->received);
+	} else {
+		if (!ch)
+			return ERR_CHANNEL_BUSY;
 
-		if (reader->seq != f->cont.seq) {
-			send_u2fhid_error(f->cid, ERR_INVALID_SEQ);
-			reader->cmd = 0;
-			reader->len = 0;
-			reader->seq = 255;
-			return;
+		// Extra frames after the message is complete are ignored.
+		if (ch->completed || ch->busy)
+			return ERR_NONE;
+
+		if (ch->seq != f->cont.seq) {
+			u2f_channels_release(ch);
+			return ERR_INVALID_SEQ;
 		}
 
-		// check out of bounds
-		if ((reader->buf_ptr - reader->buf) >= (signed) reader->len
-			|| (reader->buf_ptr + sizeof(f->cont.data) - reader->buf) > (signed) sizeof(reader->buf))
-			return;
-		reader->seq++;
-		memcpy(reader->buf_ptr, f->cont.data, sizeof(f->cont.data));
-		reader->buf_ptr += sizeof(f->cont.data);
-		return;
+		uint32_t n = MIN(sizeof(f->cont.data), ch->len - ch->received);
+		memcpy(ch->buf + ch->received, f->cont.data, n);
+		ch->received += n;
+		ch->seq++;
 	}
 
-	u2fhid_read_start(f);
+	ch->timeout = U2F_TIMEOUT;
+	ch->last_used = ++channel_clock;
+	if (ch->received >= ch->len)
+		ch->completed = ++channel_completions;
+
+	return ERR_NONE;
 }
 
-void u2fhid_init_cmd(const U2FHID_FRAME *f) {
-	reader->seq = 0;
-	reader->buf_ptr = reader->buf;
-	reader->len = MSG_LEN(*f);
-	reader->cmd = f->type;
-	memcpy(reader->buf_ptr, f->init.data, sizeof(f->init.data));
-	reader->buf_ptr += sizeof(f->init.data);
-	cid = f->cid;
+U2F_Channel *u2f_channels_next(void)
+{
+	U2F_Channel *next = NULL;
+	for (int i = 0; i < U2F_CHANNEL_COUNT; i++) {
+		U2F_Channel *ch = &channels[i];
+		if (!ch->cid || !ch->completed || ch->busy)
+			continue;
+		if (!next || ch->completed < next->completed)
+			next = ch;
+	}
+	return next;
 }
 
-void u2fhid_read_start(const U2FHID_FRAME *f) {
-	U2F_ReadBuffer readbuffer;
-	memzero(&readbuffer, sizeof(readbuffer));
+bool u2f_channels_pending(void)
+{
+	for (int i = 0; i < U2F_CHANNEL_COUNT; i++) {
+		if (channels[i].cid && !channels[i].completed)
+			return true;
+	}
+	return false;
+}
 
-	if (!(f->type & TYPE_INIT)) {
-		return;
+uint32_t u2f_channels_tick(void)
+{
+	uint32_t expired = 0;
+	for (int i = 0; i < U2F_CHANNEL_COUNT; i++) {
+		U2F_Channel *ch = &channels[i];
+		if (!ch->cid || ch->completed)
+			continue;
+		if (ch->timeout) {
+			ch->timeout--;
+		} else if (!expired) {
+			expired = ch->cid;
+			u2f_channels_release(ch);
+		}
 	}
+	return expired;
+}
+
+static void u2fhid_poll(void)
+{
+	usbPoll();
+
+	uint32_t expired = u2f_channels_tick();
+	if (expired)
+		send_u2fhid_error(expired, ERR_MSG_TIMEOUT);
+}
 
-	// Broadcast is reserved for init
-	if (f->cid == CID_BROADCAST || f->cid == 0) {
-		send_u2fhid_error(f->cid, ERR_INVALID_CID);
+void u2fhid_read(char tiny, const U2FHID_FRAME *f)
+{
+	// Always handle init packets directly
+	if (f->init.cmd == U2FHID_INIT) {
+		u2fhid_init(f);
+		// abort the channel's current message
+		u2f_channels_abort(f->cid);
 		return;
 	}
 
-	if ((unsigned)MSG_LEN(*f) > sizeof(reader->buf)) {
-		send_u2fhid_error(f->cid, ERR_INVALID_LEN);
+	uint8_t err = u2f_channels_frame(f);
+	if (err != ERR_NONE) {
+		send_u2fhid_error(f->cid, err);
 		return;
 	}
 
-	reader = &readbuffer;
-	u2fhid_init_cmd(f);
+	// Frames that arrive while a message is being handled are only queued.
+	if (tiny)
+		return;
 
 	usbTiny(1);
 	for(;;) {
-		// Do we need to wait for more data
-		while ((reader->buf_ptr - reader->buf) < (signed)reader->len) {
-			uint8_t lastseq = reader->seq;
-			uint8_t lastcmd = reader->cmd;
-			int counter = U2F_TIMEOUT;
-			while (reader->seq == lastseq && reader->cmd == lastcmd) {
-				if (counter-- == 0) {
-					// timeout
-					send_u2fhid_error(cid, ERR_MSG_TIMEOUT);
-					cid = 0;
-					reader = 0;
-					usbTiny(0);
-					layoutHome();
-					return;
-				}
-				usbPoll();
-			}
+		// Wait for a whole message on any channel
+		U2F_Channel *ch;
+		while (!(ch = u2f_channels_next())) {
+			if (!u2f_channels_pending())
+				break;
+			u2fhid_poll();
 		}
 
-		// We have all the data
-		switch (reader->cmd) {
-		case 0:
-			// message was aborted by init
-			break;
-		case U2FHID_PING:
-			u2fhid_ping(reader->buf, reader->len);
-			break;
-		case U2FHID_MSG:
-			u2fhid_msg((APDU *)reader->buf, reader->len);
-			break;
-		case U2FHID_WINK:
-			u2fhid_wink(reader->buf, reader->len);
-			break;
-		default:
-			send_u2fhid_error(cid, ERR_INVALID_CMD);
-			break;
+		if (ch) {
+			ch->busy = true;
+			cid = ch->cid;
+			switch (ch->cmd) {
+			case U2FHID_PING:
+				u2fhid_ping(ch->buf, ch->len);
+				break;
+			case U2FHID_MSG:
+				u2fhid_msg((APDU *)ch->buf, ch->len);
+				break;
+			case U2FHID_WINK:
+				u2fhid_wink(ch->buf, ch->len);
+				break;
+			default:
+				send_u2fhid_error(cid, ERR_INVALID_CMD);
+				break;
+			}
+			u2f_channels_release(ch);
 		}
 
 		// wait for next commmand/ button press
-		reader->cmd = 0;
-		reader->seq = 255;
-		while (dialog_timeout > 0 && reader->cmd == 0) {
+		while (dialog_timeout > 0 && !u2f_channels_next()) {
 			dialog_timeout--;
-			usbPoll(); // may trigger new request
+			u2fhid_poll(); // may trigger new request
 			//buttonUpdate();
 			if (keepkey_button_down() &&
 				(last_req_state == AUTH || last_req_state == REG)) {
@@ -265,10 +331,15 @@ void u2fhid_read_start(const U2FHID_FRAME *f) {
 			}
 		}
 
-		if (reader->cmd == 0) {
+		// An unanswered dialog gives way to requests from other channels.
+		if (dialog_timeout == 0 && last_req_state != INIT) {
+			last_req_state = INIT;
+			layoutHome();
+		}
+
+		if (!u2f_channels_next() && !u2f_channels_pending()) {
 			last_req_state = INIT;
 			cid = 0;
-			reader = 0;
 			usbTiny(0);
 			layoutHome();
 			return;
@@ -375,6 +446,15 @@ void u2fhid_msg(const APDU *a, uint32_t len)
 		return;
 	}
 
+	// Only one channel at a time gets the confirm dialog. Others are told
+	// to come back later, as if the user hadn't pressed the button yet.
+	bool needs_presence = a->ins == U2F_REGISTER ||
+	    (a->ins == U2F_AUTHENTICATE && a->p1 == U2F_AUTH_ENFORCE);
+	if (needs_presence && last_req_state != INIT && cid != prompt_cid) {
+		send_u2f_error(U2F_SW_CONDITIONS_NOT_SATISFIED);
+		return;
+	}
+
 	switch (a->ins) {
 		case U2F_REGISTER:
 			u2f_register(a);
@@ -501,87 +581,151 @@ static bool getReadableAppId(const uint8_t appid[U2F_APPID_SIZE], const char **a
 	return false;
 }
 
-static const HDNode *getDerivedNode(uint32_t *address_n, size_t address_n_count)
+static bool getDerivedNode(const HDNode *root, const uint32_t *address_n,
+                           size_t address_n_count, HDNode *node)
 {
-	static CONFIDENTIAL HDNode node;
-	if (!storage_getU2FRoot(&node)) {
-		layoutHome();
-		debugLog(0, "", "ERR: Device not init");
-		return 0;
-	}
-	if (!address_n || address_n_count == 0) {
-		return &node;
-	}
+	memcpy(node, root, sizeof(*node));
 	for (size_t i = 0; i < address_n_count; i++) {
-		if (hdnode_private_ckd(&node, address_n[i]) == 0) {
-			layoutHome();
+		if (hdnode_private_ckd(node, address_n[i]) == 0) {
 			debugLog(0, "", "ERR: Derive private failed");
-			return 0;
+			memzero(node, sizeof(*node));
+			return false;
 		}
 	}
-	return &node;
+	return true;
 }
 
-static const HDNode *generateKeyHandle(const uint8_t app_id[], uint8_t key_handle[])
+static void keyHandleMac(const HDNode *node, const uint8_t app_id[],
+                         const uint8_t key_handle[], uint8_t mac[SHA256_DIGEST_LENGTH])
 {
+	// Signature of app_id and the path half of the key handle
 	uint8_t keybase[U2F_APPID_SIZE + KEY_PATH_LEN];
+	memcpy(&keybase[0], app_id, U2F_APPID_SIZE);
+	memcpy(&keybase[U2F_APPID_SIZE], key_handle, KEY_PATH_LEN);
+	hmac_sha256(node->private_key, sizeof(node->private_key),
+	            keybase, sizeof(keybase), mac);
+}
 
-	// Derivation path is m/U2F'/r'/r'/r'/r'/r'/r'/r'/r'
+bool u2f_generateKeyHandle_impl(const HDNode *root, uint32_t version,
+                                const uint8_t app_id[], uint8_t key_handle[],
+                                HDNode *node)
+{
 	uint32_t key_path[KEY_PATH_ENTRIES];
-	for (uint32_t i = 0; i < KEY_PATH_ENTRIES; i++) {
-		// high bit for hardened keys
-		key_path[i]= 0x80000000 | random32();
+	const uint32_t *derivation = key_path;
+	size_t derivation_count = KEY_PATH_ENTRIES;
+
+	switch (version) {
+	case KEY_HANDLE_LEGACY:
+		for (uint32_t i = 0; i < KEY_PATH_ENTRIES; i++) {
+			// high bit for hardened keys
+			key_path[i] = 0x80000000 | random32();
+		}
+		break;
+	case KEY_HANDLE_V1:
+		key_path[0] = KEY_HANDLE_V1;
+		for (uint32_t i = 1; i <= KEY_PATH_V1_ENTRIES; i++) {
+			key_path[i] = 0x80000000 | random32();
+		}
+		random_buffer((uint8_t *)&key_path[1 + KEY_PATH_V1_ENTRIES],
+		              sizeof(key_path) - (1 + KEY_PATH_V1_ENTRIES) * sizeof(uint32_t));
+		derivation = &key_path[1];
+		derivation_count = KEY_PATH_V1_ENTRIES;
+		break;
+	default:
+		return false;
 	}
 
 	// First half of keyhandle is key_path
 	memcpy(key_handle, key_path, KEY_PATH_LEN);
 
 	// prepare keypair from /random data
-	const HDNode *node = getDerivedNode(key_path, KEY_PATH_ENTRIES);
-	if (!node)
-		return NULL;
+	if (!getDerivedNode(root, derivation, derivation_count, node))
+		return false;
 
-	// For second half of keyhandle
-	// Signature of app_id and random data
-	memcpy(&keybase[0], app_id, U2F_APPID_SIZE);
-	memcpy(&keybase[U2F_APPID_SIZE], key_handle, KEY_PATH_LEN);
-	hmac_sha256(node->private_key, sizeof(node->private_key),
-					keybase, sizeof(keybase), &key_handle[KEY_PATH_LEN]);
+	keyHandleMac(node, app_id, key_handle, &key_handle[KEY_PATH_LEN]);
 
 	// Done!
-	return node;
+	return true;
 }
 
-
-static const HDNode *validateKeyHandle(const uint8_t app_id[], const uint8_t key_handle[])
+bool u2f_validateKeyHandle_impl(const HDNode *root, const uint8_t app_id[],
+                                const uint8_t key_handle[], HDNode *node)
 {
 	uint32_t key_path[KEY_PATH_ENTRIES];
 	memcpy(key_path, key_handle, KEY_PATH_LEN);
-	for (unsigned int i = 0; i < KEY_PATH_ENTRIES; i++) {
-		// check high bit for hardened keys
-		if (! (key_path[i] & 0x80000000)) {
-			return NULL;
+
+	const uint32_t *derivation = key_path;
+	size_t derivation_count = KEY_PATH_ENTRIES;
+
+	if (key_path[0] & 0x80000000) {
+		for (unsigned int i = 0; i < KEY_PATH_ENTRIES; i++) {
+			// check high bit for hardened keys
+			if (! (key_path[i] & 0x80000000)) {
+				return false;
+			}
+		}
+	} else if (key_path[0] == KEY_HANDLE_V1) {
+		for (unsigned int i = 1; i <= KEY_PATH_V1_ENTRIES; i++) {
+			if (! (key_path[i] & 0x80000000)) {
+				return false;
+			}
 		}
+		derivation = &key_path[1];
+		derivation_count = KEY_PATH_V1_ENTRIES;
+	} else {
+		return false;
 	}
 
-	const HDNode *node = getDerivedNode(key_path, KEY_PATH_ENTRIES);
-	if (!node)
+	if (!getDerivedNode(root, derivation, derivation_count, node))
+		return false;
+
+	uint8_t hmac[SHA256_DIGEST_LENGTH];
+	keyHandleMac(node, app_id, key_handle, hmac);
+
+	if (memcmp_s(&key_handle[KEY_PATH_LEN], hmac, SHA256_DIGEST_LENGTH) != 0) {
+		memzero(node, sizeof(*node));
+		return false;
+	}
+
+	// Done!
+	return true;
+}
+
+static const HDNode *generateKeyHandle(const uint8_t app_id[], uint8_t key_handle[])
+{
+	static CONFIDENTIAL HDNode root, node;
+	if (!storage_getU2FRoot(&root)) {
+		layoutHome();
+		debugLog(0, "", "ERR: Device not init");
 		return NULL;
+	}
 
-	uint8_t keybase[U2F_APPID_SIZE + KEY_PATH_LEN];
-	memcpy(&keybase[0], app_id, U2F_APPID_SIZE);
-	memcpy(&keybase[U2F_APPID_SIZE], key_handle, KEY_PATH_LEN);
+	bool ok = u2f_generateKeyHandle_impl(&root, KEY_HANDLE_VERSION, app_id,
+	                                     key_handle, &node);
+	memzero(&root, sizeof(root));
+	if (!ok) {
+		layoutHome();
+		return NULL;
+	}
 
+	return &node;
+}
 
-	uint8_t hmac[SHA256_DIGEST_LENGTH];
-	hmac_sha256(node->private_key, sizeof(node->private_key),
-				keybase, sizeof(keybase), hmac);
+static const HDNode *validateKeyHandle(const uint8_t app_id[], const uint8_t key_handle[])
+{
+	static CONFIDENTIAL HDNode root, node;
+	if (!storage_getU2FRoot(&root)) {
+		layoutHome();
+		debugLog(0, "", "ERR: Device not init");
+		return NULL;
+	}
 
-	if (memcmp_s(&key_handle[KEY_PATH_LEN], hmac, SHA256_DIGEST_LENGTH) != 0)
+	bool ok = u2f_validateKeyHandle_impl(&root, app_id, key_handle, &node);
+	memzero(&root, sizeof(root));
+	if (!ok)
 		return NULL;
 
-	// Done!
-	return node;
+	return &node;
 }
 
 static void promptRegister(bool request, const U2F_REGISTER_REQ *req)
@@ -639,6 +783,7 @@ void u2f_register(const APDU *a)
 		//buttonUpdate();
 		promptRegister(true, req);
 		last_req_state = REG;
+		prompt_cid = cid;
 	}
 
 	// Still awaiting Keypress
@@ -786,6 +931,7 @@ void u2f_authenticate(const APDU *a)
 		//buttonUpdate(); // Clear button state
 		promptAuthenticate(true, req);
 		last_req_state = AUTH;
+		prompt_cid = cid;
 	}
 
 	// Awaiting Keypress
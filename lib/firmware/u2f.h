@@ -1,8 +1,97 @@
 #ifndef LIB_FIRMWARE_U2F_H
 #define LIB_FIRMWARE_U2F_H
 
+#include "keepkey/firmware/u2f/u2f_hid.h"
+#include "trezor/crypto/bip32.h"
+#include "trezor/crypto/sha2.h"
+
 #include <inttypes.h>
+#include <stdbool.h>
+
+#define KEY_PATH_LEN 32
+#define KEY_HANDLE_LEN (KEY_PATH_LEN + SHA256_DIGEST_LENGTH)
+
+// Legacy handles: every word of the path is hardened, and the key is at
+// m/U2F'/r'/r'/r'/r'/r'/r'/r'/r'
+#define KEY_PATH_ENTRIES (KEY_PATH_LEN / sizeof(uint32_t))
+
+// Versioned handles start with a word that is not hardened, holding the
+// version. Version 1 puts the key at m/U2F'/r'/r', followed by random
+// padding up to KEY_PATH_LEN.
+#define KEY_HANDLE_LEGACY 0
+#define KEY_HANDLE_V1 1
+#define KEY_PATH_V1_ENTRIES 2
+
+// Format used for new registrations. Firmware from before versioned
+// handles rejects V1 handles, so after a downgrade every site registered
+// with one stops working. V1 is opt-in (KK_U2F_KEY_HANDLE_V1) until then.
+#if U2F_KEY_HANDLE_V1
+#define KEY_HANDLE_VERSION KEY_HANDLE_V1
+#else
+#define KEY_HANDLE_VERSION KEY_HANDLE_LEGACY
+#endif
+
+// Channels that can have a message in flight at once.
+#define U2F_CHANNEL_COUNT 4
+
+// Largest message a channel accepts. U2FHID allows up to 7609 bytes
+// (64 - 7 + 128 * (64 - 5)), but U2F register and authenticate requests
+// are a few hundred bytes at most, and U2F_CHANNEL_COUNT buffers of the
+// full size don't fit in RAM. This deviates from the protocol: longer
+// messages, e.g. a large PING, are rejected with ERR_INVALID_LEN.
+#define U2F_CHANNEL_BUFFER_LEN 1024
+
+typedef struct {
+	uint32_t cid;        // 0 when the slot is free
+	uint32_t len;        // message length from the init frame
+	uint32_t received;
+	uint32_t timeout;    // polls left before the message is dropped
+	uint32_t last_used;  // for LRU eviction
+	uint32_t completed;  // completion order, 0 while incomplete
+	uint8_t cmd;
+	uint8_t seq;
+	bool busy;           // being handled, so it can't be evicted
+	uint8_t buf[U2F_CHANNEL_BUFFER_LEN];
+} U2F_Channel;
 
 const char *words_from_data(const uint8_t *data, int len);
 
+/// Forget all partial and queued messages.
+void u2f_channels_reset(void);
+
+/// Drop the message in progress on a channel.
+void u2f_channels_abort(uint32_t cid);
+
+/// Add a frame to its channel's message.
+/// \returns ERR_NONE, or the U2FHID error to send back.
+uint8_t u2f_channels_frame(const U2FHID_FRAME *f);
+
+/// \returns the oldest complete message, or NULL.
+U2F_Channel *u2f_channels_next(void);
+
+/// Free a channel once its message has been handled.
+void u2f_channels_release(U2F_Channel *ch);
+
+/// \returns true if any channel has a partial message.
+bool u2f_channels_pending(void);
+
+/// Count down partial message timeouts.
+/// \returns the channel id of a message that timed out and was dropped, or 0.
+uint32_t u2f_channels_tick(void);
+
+/// Fill in a new key handle of the given version for app_id.
+/// \param root   U2F root node, m/U2F'
+/// \param node   Key pair for the new handle.
+/// \returns true on success.
+bool u2f_generateKeyHandle_impl(const HDNode *root, uint32_t version,
+                                const uint8_t app_id[], uint8_t key_handle[],
+                                HDNode *node);
+
+/// Check that key_handle was issued by this device for app_id.
+/// \param root   U2F root node, m/U2F'
+/// \param node   Key pair for the handle.
+/// \returns true iff the handle is valid.
+bool u2f_validateKeyHandle_impl(const HDNode *root, const uint8_t app_id[],
+                                const uint8_t key_handle[], HDNode *node);
+
 #endif
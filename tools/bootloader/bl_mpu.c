@@ -54,6 +54,10 @@ void bl_flash_erase_word(Allocation group)
 
 /// bootloader-only: flash-erase that erases a given sector in 32bit chunks
 void bl_flash_erase_sector(int sector) {
+    if (sector >= FLASH_APP_SECTOR_FIRST) {
+        memory_firmware_invalidate();
+    }
+
 #ifndef EMULATOR
     const FlashSector* s = flash_sector_map;
     while (s->use != FLASH_INVALID) {
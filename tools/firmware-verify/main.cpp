@@ -0,0 +1,88 @@
+extern "C" {
+#include "keepkey/board/pubkeys.h"
+}
+
+#include "verify.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+/// Checks the 3-of-5 signatures of signed firmware images, as the
+/// bootloader would, so that release images can be checked in bulk before
+/// they are published.
+///
+/// Usage: firmware-verify [-j threads] image.bin...
+///
+/// Prints one line per image: the result, the firmware hash reported by
+/// Features once installed, and the path. Exits non-zero unless every image
+/// verified.
+
+static std::string hex(const uint8_t *data, size_t len) {
+    std::ostringstream out;
+    out << std::hex << std::setfill('0');
+    for (size_t i = 0; i < len; i++)
+        out << std::setw(2) << (int)data[i];
+    return out.str();
+}
+
+static const char *status_str(int status) {
+    switch (status) {
+    case SIG_OK: return "OK";
+    case KEY_EXPIRED: return "EXPIRED";
+    default: return "FAIL";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned threads = std::thread::hardware_concurrency();
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = (unsigned)atoi(argv[++i]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << "usage: " << argv[0] << " [-j threads] image.bin...\n";
+        return 2;
+    }
+
+    std::vector<std::vector<uint8_t> > images;
+    for (const std::string &path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << path << ": cannot open\n";
+            return 2;
+        }
+        images.emplace_back(std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>());
+    }
+
+    std::vector<fwverify::Result> results = fwverify::verify_images(images, threads);
+
+    int ret = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        const fwverify::Result &r = results[i];
+        std::cout << std::left << std::setw(8) << status_str(r.status)
+                  << hex(r.measurement.firmware_hash, sizeof(r.measurement.firmware_hash))
+                  << "  " << paths[i];
+        if (!r.error.empty())
+            std::cout << " (" << r.error << ")";
+        std::cout << "\n";
+
+        if (r.status != SIG_OK)
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,67 @@
+extern "C" {
+#include "keepkey/board/pubkeys.h"
+#include "keepkey/board/signatures.h"
+}
+
+#include "verify.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace fwverify {
+
+Result verify_image(const std::vector<uint8_t> &image) {
+    Result result;
+    result.status = SIG_FAIL;
+    memset(&result.measurement, 0, sizeof(result.measurement));
+
+    if (image.size() < FLASH_META_DESC_LEN) {
+        result.error = "shorter than the metadata header";
+        return result;
+    }
+
+    app_meta_td meta;
+    memcpy(&meta, image.data(), sizeof(meta));
+
+    if (memcmp(meta.magic, META_MAGIC_STR, META_MAGIC_SIZE) != 0) {
+        result.error = "bad magic";
+        return result;
+    }
+
+    if (meta.code_len > image.size() - FLASH_META_DESC_LEN) {
+        result.error = "code_len runs past the end of the image";
+        return result;
+    }
+
+    memory_measure(image.data(), image.data() + FLASH_META_DESC_LEN, meta.code_len,
+                   &result.measurement);
+    result.status = signatures_check(&meta, result.measurement.fingerprint);
+    return result;
+}
+
+std::vector<Result> verify_images(const std::vector<std::vector<uint8_t> > &images,
+                                  unsigned threads) {
+    std::vector<Result> results(images.size());
+    std::atomic<size_t> next(0);
+
+    // Images are independent and signatures_check() keeps no state, so
+    // workers just take the next unclaimed image.
+    auto worker = [&]() {
+        for (size_t i = next++; i < images.size(); i = next++)
+            results[i] = verify_image(images[i]);
+    };
+
+    threads = std::max(1u, std::min<unsigned>(threads, images.size()));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread &t : pool)
+        t.join();
+
+    return results;
+}
+
+} // namespace fwverify
@@ -0,0 +1,37 @@
+#ifndef KEEPKEY_TOOLS_FIRMWARE_VERIFY_H
+#define KEEPKEY_TOOLS_FIRMWARE_VERIFY_H
+
+extern "C" {
+#include "keepkey/board/memory.h"
+}
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fwverify {
+
+/// Outcome of checking one signed firmware image.
+struct Result {
+    /// SIG_OK, KEY_EXPIRED or SIG_FAIL, as the bootloader would report it.
+    int status;
+
+    /// Set when the image is malformed, in which case status is SIG_FAIL.
+    std::string error;
+
+    /// Fingerprint and the hash Features.firmware_hash will report.
+    FirmwareMeasurement measurement;
+};
+
+/// Checks the signatures of an image laid out as it is on disk: the
+/// metadata header followed by the application.
+Result verify_image(const std::vector<uint8_t> &image);
+
+/// Checks many images on up to `threads` worker threads.
+/// \returns results in the same order as images.
+std::vector<Result> verify_images(const std::vector<std::vector<uint8_t> > &images,
+                                  unsigned threads);
+
+} // namespace fwverify
+
+#endif
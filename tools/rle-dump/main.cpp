@@ -1,12 +1,15 @@
 extern "C" {
 #include "keepkey/board/canvas.h"
 #include "keepkey/board/draw.h"
+#include "keepkey/board/font.h"
 #include "keepkey/board/variant.h"
 }
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 static const uint8_t confirm_icon_1_data[240] = {
     0x08, 0x00, 0xfc, 0x02, 0x11, 0x1e, 0x29, 0x02, 0x2f, 0xfc, 0x29, 0x1e, 0x11, 0x02, 0x0b, 0x00, 0xfe, 0x0d, 0x22, 0x08, 0x33, 0xfe, 0x22, 0x0d, 0x09, 0x00, 0xfe, 0x11, 0x2b, 0x0a, 0x33, 0xfe, 0x2b, 0x11, 0x07, 0x00, 0xfe, 0x0d, 0x2b, 0x05, 0x33, 0x02, 0x31, 0x05, 0x33, 0xfe, 0x2b, 0x0d, 0x05, 0x00, 0xfe, 0x02, 0x22, 0x06, 0x33, 0x02, 0x15, 0x06, 0x33, 0xfe, 0x22, 0x02, 0x04, 0x00, 0xff, 0x11, 0x06, 0x33, 0xff, 0x2b, 0x02, 0x01, 0xff, 0x2b, 0x06, 0x33, 0xff, 0x11, 0x04, 0x00, 0xff, 0x1e, 0x06, 0x33, 0xff, 0x0d, 0x02, 0x00, 0xff, 0x0d, 0x06, 0x33, 0xff, 0x1e, 0x04, 0x00, 0xff, 0x29, 0x05, 0x33, 0xff, 0x1f, 0x04, 0x00, 0xff, 0x1f, 0x05, 0x33, 0xff, 0x29, 0x04, 0x00, 0xff, 0x2f, 0x04, 0x33, 0xfe, 0x2f, 0x02, 0x04, 0x00, 0xfe, 0x02, 0x2f, 0x04, 0x33, 0xff, 0x2f, 0x04, 0x00, 0xff, 0x2f, 0x04, 0x33, 0xff, 0x11, 0x06, 0x00, 0xff, 0x15, 0x04, 0x33, 0xff, 0x2f, 0x04, 0x00, 0xff, 0x29, 0x03, 0x33, 0xff, 0x26, 0x08, 0x00, 0xff, 0x26, 0x03, 0x33, 0xff, 0x29, 0x04, 0x00, 0xff, 0x1e, 0x03, 0x33, 0xff, 0x11, 0x08, 0x07, 0xff, 0x15, 0x03, 0x33, 0xff, 0x1e, 0x04, 0x00, 0xff, 0x11, 0x10, 0x33, 0xff, 0x11, 0x04, 0x00, 0xfe, 0x02, 0x22, 0x0e, 0x33, 0xfe, 0x22, 0x02, 0x05, 0x00, 0xfe, 0x0d, 0x2b, 0x0c, 0x33, 0xfe, 0x2b, 0x0d, 0x07, 0x00, 0xfe, 0x11, 0x2b, 0x0a, 0x33, 0xfe, 0x2b, 0x11, 0x09, 0x00, 0xfe, 0x0d, 0x22, 0x08, 0x33, 0xfe, 0x22, 0x0d, 0x0b, 0x00, 0xfc, 0x02, 0x11, 0x1e, 0x29, 0x02, 0x2f, 0xfc, 0x29, 0x1e, 0x11, 0x02, 0x04, 0x00
@@ -27,36 +30,93 @@ static const AnimationFrame confirm_icon_1_frame = {
     .image = &confirm_icon_1_image
 };
 
-void to_ppm(Canvas *canvas) {
-    std::cout << "P2\n"
-              << canvas->width << " " << canvas->height << "\n"
-              << "255\n";
+// Same image at an unaligned offset and a dimmer color, to exercise the
+// color scaling and runs that do not start on a word boundary.
+static const AnimationFrame confirm_icon_2_frame = {
+    .x = 3,
+    .y = 41,
+    .duration = 1,
+    .color = 57,
+    .image = &confirm_icon_1_image
+};
+
+void to_ppm(std::ostream &out, Canvas *canvas) {
+    out << "P2\n"
+        << canvas->width << " " << canvas->height << "\n"
+        << "255\n";
 
     for (uint16_t y = 0; y < canvas->height; y++) {
         for (uint16_t x = 0; x < canvas->width; x++) {
             int color = canvas->buffer[y * canvas->width + x];
-            std::cout << std::setw(4) << color;
+            out << std::setw(4) << color;
             if (x + 1 == canvas->width)
-                std::cout << "\n";
+                out << "\n";
         }
     }
 }
 
+static bool draw_text(Canvas *canvas) {
+    char glyphs[0x7f - 0x20 + 1];
+    for (int c = 0x20; c < 0x7f; c++)
+        glyphs[c - 0x20] = (char)c;
+    glyphs[sizeof(glyphs) - 1] = '\0';
+
+    DrawableParams title = { 0xff, 1, 1 };
+    draw_string(canvas, get_title_font(), glyphs, &title, 228,
+                font_height(get_title_font()));
+
+    DrawableParams body = { 0x7f, 30, 26 };
+    draw_string(canvas, get_body_font(), glyphs, &body, 225,
+                font_height(get_body_font()) + 1);
+
+    DrawableParams pin = { 0x33, 50, 49 };
+    draw_string(canvas, get_pin_font(), "123456789", &pin, 0, 0);
+
+    return true;
+}
+
+// Usage: rle-dump [reference.ppm]
+//
+// Renders a fixed test scene and writes it to stdout as a PPM. When a
+// reference image is given, compares against it instead and exits non-zero
+// on any pixel difference.
 int main(int argc, char *argv[]) {
     Canvas canvas;
+    memset(&canvas, 0, sizeof(canvas));
     canvas.height = 64;
     canvas.width = 256;
-    canvas.buffer = new uint8_t[64 * 255];
-
-    memset(canvas.buffer, 0, 64 * 255);
+    canvas.buffer = new uint8_t[64 * 256];
 
     if (!canvas.buffer)
         return 1;
 
-    if (draw_bitmap_mono_rle(&canvas, &confirm_icon_1_frame, false)) {
-        to_ppm(&canvas);
+    memset(canvas.buffer, 0, 64 * 256);
+
+    if (!draw_bitmap_mono_rle(&canvas, &confirm_icon_1_frame, false) ||
+        !draw_bitmap_mono_rle(&canvas, &confirm_icon_2_frame, false) ||
+        !draw_text(&canvas))
+        return 2;
+
+    std::ostringstream image;
+    to_ppm(image, &canvas);
+
+    if (argc < 2) {
+        std::cout << image.str();
         return 0;
     }
 
-    return 2;
+    std::ifstream reference_file(argv[1]);
+    if (!reference_file) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::stringstream reference;
+    reference << reference_file.rdbuf();
+    if (reference.str() != image.str()) {
+        std::cerr << "rendering differs from " << argv[1] << "\n";
+        return 3;
+    }
+
+    return 0;
 }
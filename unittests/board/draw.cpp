@@ -0,0 +1,121 @@
+extern "C" {
+#include "keepkey/board/draw.h"
+#include "keepkey/board/font.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct TestCanvas {
+    std::vector<uint8_t> pixels;
+    Canvas canvas;
+
+    TestCanvas() : pixels(64 * 256, 0) {
+        memset(&canvas, 0, sizeof(canvas));
+        canvas.buffer = pixels.data();
+        canvas.width = 256;
+        canvas.height = 64;
+    }
+};
+
+} // namespace
+
+TEST(Draw, DirtyRectStartsFromFirstPrimitive) {
+    TestCanvas tc;
+    draw_box_simple(&tc.canvas, 0xff, 10, 20, 5, 6);
+
+    ASSERT_TRUE(tc.canvas.dirty);
+    EXPECT_EQ(tc.canvas.dirty_x0, 10);
+    EXPECT_EQ(tc.canvas.dirty_y0, 20);
+    EXPECT_EQ(tc.canvas.dirty_x1, 15);
+    EXPECT_EQ(tc.canvas.dirty_y1, 26);
+}
+
+TEST(Draw, DirtyRectGrowsToBoundingBox) {
+    TestCanvas tc;
+    draw_box_simple(&tc.canvas, 0xff, 10, 20, 5, 6);
+    draw_box_simple(&tc.canvas, 0xff, 100, 2, 4, 4);
+
+    ASSERT_TRUE(tc.canvas.dirty);
+    EXPECT_EQ(tc.canvas.dirty_x0, 10);
+    EXPECT_EQ(tc.canvas.dirty_y0, 2);
+    EXPECT_EQ(tc.canvas.dirty_x1, 104);
+    EXPECT_EQ(tc.canvas.dirty_y1, 26);
+}
+
+TEST(Draw, DirtyRectCoversString) {
+    TestCanvas tc;
+    const Font *font = get_body_font();
+    DrawableParams p;
+    p.color = 0xff;
+    p.x = 30;
+    p.y = 12;
+    draw_string(&tc.canvas, font, "Hi", &p, 0, font_height(font));
+
+    ASSERT_TRUE(tc.canvas.dirty);
+    EXPECT_EQ(tc.canvas.dirty_x0, 30);
+    EXPECT_EQ(tc.canvas.dirty_y0, 12);
+    EXPECT_EQ(tc.canvas.dirty_x1, 30 + calc_str_width(font, "Hi"));
+    EXPECT_EQ(tc.canvas.dirty_y1, 12 + font_height(font));
+
+    // Every lit pixel must be inside the dirty rectangle.
+    for (int y = 0; y < tc.canvas.height; ++y) {
+        for (int x = 0; x < tc.canvas.width; ++x) {
+            if (!tc.pixels[y * tc.canvas.width + x])
+                continue;
+            EXPECT_GE(x, tc.canvas.dirty_x0);
+            EXPECT_LT(x, tc.canvas.dirty_x1);
+            EXPECT_GE(y, tc.canvas.dirty_y0);
+            EXPECT_LT(y, tc.canvas.dirty_y1);
+        }
+    }
+}
+
+TEST(Draw, NothingDrawnStaysClean) {
+    TestCanvas tc;
+    draw_box_simple(&tc.canvas, 0xff, 10, 20, 0, 0);
+    EXPECT_FALSE(tc.canvas.dirty);
+}
+
+TEST(Draw, BitmapMonoScaled) {
+    TestCanvas tc;
+
+    // 3x2 bitmap, bit 0 is the leftmost pixel:  #.#
+    //                                           .#.
+    const uint8_t bits[] = { 0x05, 0x02 };
+    ASSERT_TRUE(draw_bitmap_mono_scaled(&tc.canvas, bits, 1, 3, 2, 10, 20,
+                                        2, 1, 0x00, 0xff));
+
+    EXPECT_EQ(tc.canvas.dirty_x0, 10);
+    EXPECT_EQ(tc.canvas.dirty_y0, 20);
+    EXPECT_EQ(tc.canvas.dirty_x1, 10 + (3 + 2) * 2);
+    EXPECT_EQ(tc.canvas.dirty_y1, 20 + (2 + 2) * 2);
+
+    for (int y = 0; y < (2 + 2) * 2; ++y) {
+        for (int x = 0; x < (3 + 2) * 2; ++x) {
+            int bx = x / 2 - 1, by = y / 2 - 1;
+            bool set = bx >= 0 && bx < 3 && by >= 0 && by < 2 &&
+                       ((bits[by] >> bx) & 1);
+            EXPECT_EQ(tc.pixels[(20 + y) * tc.canvas.width + 10 + x],
+                      set ? 0x00 : 0xff) << x << "," << y;
+        }
+    }
+
+    // Nothing outside the bitmap and its border is touched.
+    EXPECT_EQ(tc.pixels[19 * tc.canvas.width + 10], 0);
+    EXPECT_EQ(tc.pixels[20 * tc.canvas.width + 9], 0);
+    EXPECT_EQ(tc.pixels[28 * tc.canvas.width + 10], 0);
+    EXPECT_EQ(tc.pixels[20 * tc.canvas.width + 20], 0);
+}
+
+TEST(Draw, BitmapMonoScaledOutOfBounds) {
+    TestCanvas tc;
+    const uint8_t bits[] = { 0xff };
+    EXPECT_FALSE(draw_bitmap_mono_scaled(&tc.canvas, bits, 1, 8, 1, 250, 0,
+                                         1, 1, 0x00, 0xff));
+    EXPECT_FALSE(tc.canvas.dirty);
+}
@@ -0,0 +1,316 @@
+extern "C" {
+#include "keepkey/board/draw.h"
+#include "keepkey/board/font.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+
+TEST(Font, GlyphTableCoversPrintableAscii) {
+    const CharacterImage *sadface = font_get_char(get_pin_font(), 'A');
+
+    for (const Font *font : { get_title_font(), get_body_font() }) {
+        for (int c = 0x20; c < 0x7f; ++c) {
+            const CharacterImage *img = font_get_char(font, (char)c);
+            ASSERT_NE(img, nullptr);
+            EXPECT_NE(img, sadface) << "missing glyph 0x" << std::hex << c;
+            EXPECT_EQ(img, font->glyphs[c]);
+        }
+    }
+
+    for (int c = '1'; c <= '9'; ++c)
+        EXPECT_NE(font_get_char(get_pin_font(), (char)c), sadface);
+}
+
+TEST(Font, OutOfRangeCharactersFallBack) {
+    const Font *font = get_body_font();
+    const CharacterImage *sadface = font_get_char(get_pin_font(), 'A');
+
+    EXPECT_EQ(font_get_char(font, '\0'), sadface);
+    EXPECT_EQ(font_get_char(font, (char)0x7f), sadface);
+    EXPECT_EQ(font_get_char(font, (char)0x80), sadface);
+    EXPECT_EQ(font_get_char(font, (char)0xff), sadface);
+}
+
+// The Character tables font.c held before glyphs were indexed by code:
+// code, width, height and the FNV-1a hash of the image data, for every
+// glyph the font had. Every other code fell back to the sadface.
+struct Character {
+    int code;
+    uint16_t width;
+    uint16_t height;
+    uint32_t hash;
+};
+
+static const Character PinCharacters[] = {
+    { 0x31,  4, 12, 0x1b16c830 },
+    { 0x32,  8, 12, 0xba5832bc },
+    { 0x33,  8, 12, 0xdfa4ce29 },
+    { 0x34,  8, 12, 0x64354a5f },
+    { 0x35,  8, 12, 0x8b0d2cad },
+    { 0x36,  8, 12, 0x68d17cb0 },
+    { 0x37,  8, 12, 0x84fd91b9 },
+    { 0x38,  8, 12, 0x37a8afdd },
+    { 0x39,  8, 12, 0xa4617032 }
+};
+
+static const Character TitleCharacters[] = {
+    { 0x01, 12, 10, 0x437ed17e },
+    { 0x02, 12, 10, 0x48529f89 },
+    { 0x03, 12, 10, 0x392f78b9 },
+    { 0x20,  5, 10, 0x6e3c61b3 },
+    { 0x21,  3, 10, 0x0a17f6e3 },
+    { 0x22,  5, 10, 0x14695f6b },
+    { 0x23,  8, 10, 0x61313205 },
+    { 0x24,  7, 10, 0xd78a4689 },
+    { 0x25,  9, 10, 0xcf8b4ba9 },
+    { 0x26,  8, 10, 0x09d15c45 },
+    { 0x27,  3, 10, 0x10cf70f3 },
+    { 0x28,  4, 10, 0xc8fe7437 },
+    { 0x29,  4, 10, 0x329495ff },
+    { 0x2a,  7, 10, 0x1665aa13 },
+    { 0x2b,  7, 10, 0xe89ad345 },
+    { 0x2c,  4, 10, 0x4aaf8c31 },
+    { 0x2d,  7, 10, 0x5a9b263d },
+    { 0x2e,  4, 10, 0xf9be36f5 },
+    { 0x2f,  9, 10, 0xb4585819 },
+    { 0x30,  7, 10, 0xd0f2a5e3 },
+    { 0x31,  4, 10, 0xf9b85a38 },
+    { 0x32,  7, 10, 0x8dd26370 },
+    { 0x33,  7, 10, 0x8ff134ef },
+    { 0x34,  7, 10, 0x15ef1056 },
+    { 0x35,  7, 10, 0x0d47dda7 },
+    { 0x36,  7, 10, 0xd88a92e4 },
+    { 0x37,  7, 10, 0x59481701 },
+    { 0x38,  7, 10, 0x47810dfb },
+    { 0x39,  7, 10, 0x0624af96 },
+    { 0x3a,  4, 10, 0xcc2d13ad },
+    { 0x3b,  4, 10, 0xdc9fbae9 },
+    { 0x3c,  6, 10, 0x3d0864cf },
+    { 0x3d,  7, 10, 0x8ac6acab },
+    { 0x3e,  6, 10, 0x32f96577 },
+    { 0x3f,  7, 10, 0x7022e7af },
+    { 0x40,  9, 10, 0x40a0f083 },
+    { 0x41,  7, 10, 0xd5cb2915 },
+    { 0x42,  7, 10, 0x614d8ee0 },
+    { 0x43,  7, 10, 0x00c694dd },
+    { 0x44,  7, 10, 0xfdbb0f47 },
+    { 0x45,  7, 10, 0xfdf358b8 },
+    { 0x46,  7, 10, 0xc5835544 },
+    { 0x47,  7, 10, 0xe59869d3 },
+    { 0x48,  7, 10, 0xc48362f5 },
+    { 0x49,  5, 10, 0xeb976755 },
+    { 0x4a,  7, 10, 0x5fb916c1 },
+    { 0x4b,  7, 10, 0xb800dc36 },
+    { 0x4c,  7, 10, 0x93278849 },
+    { 0x4d,  9, 10, 0x67cfa4d3 },
+    { 0x4e,  7, 10, 0xdf365d77 },
+    { 0x4f,  7, 10, 0x2ad02f5b },
+    { 0x50,  7, 10, 0x328759d7 },
+    { 0x51,  7, 10, 0x345a45c5 },
+    { 0x52,  7, 10, 0x7c73ec3b },
+    { 0x53,  7, 10, 0x78fb7427 },
+    { 0x54,  7, 10, 0xe0b5f249 },
+    { 0x55,  7, 10, 0x34205d3b },
+    { 0x56,  7, 10, 0xd08d1ff9 },
+    { 0x57,  9, 10, 0xe6740675 },
+    { 0x58,  7, 10, 0x75d25801 },
+    { 0x59,  7, 10, 0xd657c85d },
+    { 0x5a,  7, 10, 0x48cace6d },
+    { 0x5b,  5, 10, 0x56f2774d },
+    { 0x5c,  9, 10, 0x165b2319 },
+    { 0x5d,  5, 10, 0xe4c94e7d },
+    { 0x5e,  5, 10, 0xc3ddedd1 },
+    { 0x5f,  7, 10, 0xf7483fd5 },
+    { 0x60,  4, 10, 0x3962abb9 },
+    { 0x61,  7, 10, 0x8924b02d },
+    { 0x62,  7, 10, 0x08d60427 },
+    { 0x63,  7, 10, 0x5849fe11 },
+    { 0x64,  7, 10, 0xda177387 },
+    { 0x65,  7, 10, 0x2547da84 },
+    { 0x66,  6, 10, 0xcac23d3d },
+    { 0x67,  7, 10, 0xfaf4e999 },
+    { 0x68,  7, 10, 0xa0c73316 },
+    { 0x69,  3, 10, 0xe8fa4803 },
+    { 0x6a,  4, 10, 0x5b2ea2c5 },
+    { 0x6b,  6, 10, 0x9d7c4510 },
+    { 0x6c,  3, 10, 0x15e4dc5d },
+    { 0x6d,  9, 10, 0x6d9c89c4 },
+    { 0x6e,  7, 10, 0x0645db32 },
+    { 0x6f,  7, 10, 0x7acd33e3 },
+    { 0x70,  7, 10, 0x75566617 },
+    { 0x71,  7, 10, 0xdcb99a77 },
+    { 0x72,  6, 10, 0xf740b589 },
+    { 0x73,  7, 10, 0x9264a78d },
+    { 0x74,  6, 10, 0x5cc20531 },
+    { 0x75,  7, 10, 0x1395ffdc },
+    { 0x76,  7, 10, 0xe334c381 },
+    { 0x77,  9, 10, 0x93112881 },
+    { 0x78,  7, 10, 0x29ef40d1 },
+    { 0x79,  7, 10, 0xcca31e4a },
+    { 0x7a,  7, 10, 0x6e22a551 },
+    { 0x7b,  6, 10, 0x0573e98f },
+    { 0x7c,  3, 10, 0x15e4dc5d },
+    { 0x7d,  6, 10, 0xba79e9d7 },
+    { 0x7e,  7, 10, 0x9a079ca3 }
+};
+
+static const Character BodyCharacters[] = {
+    { 0x01, 12, 10, 0x437ed17e },
+    { 0x02, 12, 10, 0x48529f89 },
+    { 0x03, 12, 10, 0x392f78b9 },
+    { 0x20,  4, 10, 0x999fdcbd },
+    { 0x21,  2, 10, 0xb63539b1 },
+    { 0x22,  4, 10, 0xdbb8ed35 },
+    { 0x23,  7, 10, 0x3c4b92ab },
+    { 0x24,  6, 10, 0xf2e2cd32 },
+    { 0x25,  8, 10, 0xde7d15b0 },
+    { 0x26,  7, 10, 0xcc7c0b2c },
+    { 0x27,  2, 10, 0x883ece9d },
+    { 0x28,  3, 10, 0x2866a410 },
+    { 0x29,  3, 10, 0xf6b89e52 },
+    { 0x2a,  6, 10, 0xd145214a },
+    { 0x2b,  6, 10, 0x0b034962 },
+    { 0x2c,  3, 10, 0x2f85412f },
+    { 0x2d,  6, 10, 0x3c95d382 },
+    { 0x2e,  3, 10, 0xf9e74e43 },
+    { 0x2f,  8, 10, 0x61a3fa80 },
+    { 0x30,  6, 10, 0xf34ba082 },
+    { 0x31,  3, 10, 0x1c13db63 },
+    { 0x32,  6, 10, 0x985e0aa9 },
+    { 0x33,  6, 10, 0xbc58bb12 },
+    { 0x34,  6, 10, 0xf4df3d6f },
+    { 0x35,  6, 10, 0x9815fb76 },
+    { 0x36,  6, 10, 0xefd1bd29 },
+    { 0x37,  6, 10, 0x3dd705a4 },
+    { 0x38,  6, 10, 0x7e309b92 },
+    { 0x39,  6, 10, 0xa1e540f9 },
+    { 0x3a,  3, 10, 0x2cfa7b1f },
+    { 0x3b,  3, 10, 0x4196bc0b },
+    { 0x3c,  5, 10, 0x5e7f3ea0 },
+    { 0x3d,  6, 10, 0x2285b661 },
+    { 0x3e,  5, 10, 0xe2645fc6 },
+    { 0x3f,  6, 10, 0x84a3b258 },
+    { 0x40,  8, 10, 0x92e81cc3 },
+    { 0x41,  6, 10, 0x42cb773d },
+    { 0x42,  6, 10, 0xeabaf3e5 },
+    { 0x43,  6, 10, 0x09f9fed6 },
+    { 0x44,  6, 10, 0x9f97f659 },
+    { 0x45,  6, 10, 0xabe05245 },
+    { 0x46,  6, 10, 0x06ddfcf1 },
+    { 0x47,  6, 10, 0x01fc4137 },
+    { 0x48,  6, 10, 0xb4500082 },
+    { 0x49,  4, 10, 0xdb49905c },
+    { 0x4a,  6, 10, 0xd60293dd },
+    { 0x4b,  6, 10, 0xc64c4207 },
+    { 0x4c,  6, 10, 0xb1c23a22 },
+    { 0x4d,  8, 10, 0x01c5cfec },
+    { 0x4e,  6, 10, 0x3f6aaac2 },
+    { 0x4f,  6, 10, 0xadb55a39 },
+    { 0x50,  6, 10, 0x471a189d },
+    { 0x51,  6, 10, 0x8151f996 },
+    { 0x52,  6, 10, 0x61c62f67 },
+    { 0x53,  6, 10, 0xfcb97da2 },
+    { 0x54,  6, 10, 0xd50a6b02 },
+    { 0x55,  6, 10, 0x8c8f357e },
+    { 0x56,  6, 10, 0x3fe8dd2e },
+    { 0x57,  8, 10, 0x6da64f41 },
+    { 0x58,  6, 10, 0xd089fb6a },
+    { 0x59,  6, 10, 0x0cb3e37e },
+    { 0x5a,  6, 10, 0x4e1713e2 },
+    { 0x5b,  4, 10, 0x8df7b8b6 },
+    { 0x5c,  8, 10, 0xeb50c080 },
+    { 0x5d,  4, 10, 0x6e8caada },
+    { 0x5e,  4, 10, 0x10f3c840 },
+    { 0x5f,  6, 10, 0x7e52d4de },
+    { 0x60,  3, 10, 0x053d5a2f },
+    { 0x61,  6, 10, 0x6e5cc041 },
+    { 0x62,  6, 10, 0xaff2bf7d },
+    { 0x63,  6, 10, 0x78468d62 },
+    { 0x64,  6, 10, 0x8f18cd5d },
+    { 0x65,  6, 10, 0xdd5d95aa },
+    { 0x66,  5, 10, 0x3e83444c },
+    { 0x67,  6, 10, 0x93c7b229 },
+    { 0x68,  6, 10, 0xce77b2d1 },
+    { 0x69,  2, 10, 0x60ccd871 },
+    { 0x6a,  3, 10, 0xaeb68243 },
+    { 0x6b,  5, 10, 0x99c845c3 },
+    { 0x6c,  2, 10, 0x93afffd6 },
+    { 0x6d,  8, 10, 0xaa9ac9f3 },
+    { 0x6e,  6, 10, 0x85806f7d },
+    { 0x6f,  6, 10, 0x616b0e21 },
+    { 0x70,  6, 10, 0x3e7807dd },
+    { 0x71,  6, 10, 0x0130bfbd },
+    { 0x72,  5, 10, 0x4b81a205 },
+    { 0x73,  6, 10, 0xfce5cca6 },
+    { 0x74,  5, 10, 0xaccdee50 },
+    { 0x75,  6, 10, 0x5889998d },
+    { 0x76,  6, 10, 0x2d6b991e },
+    { 0x77,  8, 10, 0xfda0dfd1 },
+    { 0x78,  6, 10, 0xdbb9dbfe },
+    { 0x79,  6, 10, 0x271c826d },
+    { 0x7a,  6, 10, 0xb9acd9a6 },
+    { 0x7b,  5, 10, 0xab0f1130 },
+    { 0x7c,  2, 10, 0x93afffd6 },
+    { 0x7d,  5, 10, 0xbfcc6d86 },
+    { 0x7e,  7, 10, 0xdc9c46de }
+};
+
+static uint32_t imageHash(const CharacterImage *img) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < img->width * img->height; ++i) {
+        hash ^= img->data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <size_t N>
+static void expectCharacters(const Font *font, const Character (&chars)[N]) {
+    const CharacterImage *sadface = font_get_char(get_pin_font(), 'A');
+    size_t next = 0;
+    for (int c = 0; c < FONT_GLYPHS; ++c) {
+        const CharacterImage *img = font_get_char(font, (char)c);
+        ASSERT_NE(img, nullptr);
+        if (next < N && chars[next].code == c) {
+            EXPECT_NE(img, sadface) << "missing glyph 0x" << std::hex << c;
+            EXPECT_EQ(img->width, chars[next].width) << std::hex << c;
+            EXPECT_EQ(img->height, chars[next].height) << std::hex << c;
+            EXPECT_EQ(imageHash(img), chars[next].hash) << std::hex << c;
+            ++next;
+        } else {
+            EXPECT_EQ(img, sadface) << "extra glyph 0x" << std::hex << c;
+        }
+    }
+    EXPECT_EQ(next, N);
+}
+
+TEST(Font, GlyphsMatchCharacterTables) {
+    const CharacterImage *sadface = font_get_char(get_pin_font(), 'A');
+    EXPECT_EQ(sadface->width, 9);
+    EXPECT_EQ(sadface->height, 10);
+    EXPECT_EQ(imageHash(sadface), 0xdbe639deu);
+
+    expectCharacters(get_pin_font(), PinCharacters);
+    expectCharacters(get_title_font(), TitleCharacters);
+    expectCharacters(get_body_font(), BodyCharacters);
+}
+
+TEST(Font, Metrics) {
+    EXPECT_EQ(font_height(get_pin_font()), 14u);
+    EXPECT_EQ(font_height(get_title_font()), 10u);
+    EXPECT_EQ(font_height(get_body_font()), 10u);
+    EXPECT_EQ(font_width(get_title_font()), 3u);
+    EXPECT_EQ(font_width(get_body_font()), 2u);
+
+    // The title and summary line of layoutEthereumData.
+    EXPECT_EQ(calc_str_width(get_title_font(), "CONFIRM DATA"), 82u);
+    EXPECT_EQ(calc_str_width(get_body_font(),
+                             "5aeda56215b167893e80b4fe645ba6d5...     1024 bytes"),
+              268u);
+    EXPECT_EQ(calc_str_line(get_body_font(),
+                            "The quick brown fox jumps over the lazy dog, "
+                            "twice over the lazy dog.", 100), 4u);
+}
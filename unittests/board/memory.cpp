@@ -0,0 +1,48 @@
+extern "C" {
+#include "keepkey/board/memory.h"
+#include "trezor/crypto/sha2.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+TEST(Memory, MeasureMatchesSeparateHashes) {
+    std::vector<uint8_t> meta(FLASH_META_DESC_LEN);
+    for (size_t i = 0; i < meta.size(); i++)
+        meta[i] = (uint8_t)(i * 7);
+    // The magic is not yet written when the bootloader checks the image.
+    memset(meta.data(), 0xff, META_MAGIC_SIZE);
+
+    // Lengths around the chunk size, and one that isn't block aligned.
+    for (uint32_t code_len : { 0u, 1u, 1023u, 1024u, 1025u, 70001u }) {
+        std::vector<uint8_t> app(code_len);
+        for (size_t i = 0; i < app.size(); i++)
+            app[i] = (uint8_t)(i ^ (i >> 8));
+
+        FirmwareMeasurement m;
+        memory_measure(meta.data(), app.data(), code_len, &m);
+        EXPECT_EQ(m.code_len, code_len);
+
+        uint8_t fingerprint[SHA256_DIGEST_LENGTH];
+        sha256_Raw(app.data(), app.size(), fingerprint);
+        EXPECT_EQ(memcmp(m.fingerprint, fingerprint, sizeof(fingerprint)), 0)
+            << "code_len: " << code_len;
+
+        std::vector<uint8_t> image(META_MAGIC_STR, META_MAGIC_STR + META_MAGIC_SIZE);
+        image.insert(image.end(), meta.begin() + META_MAGIC_SIZE, meta.end());
+        image.insert(image.end(), app.begin(), app.end());
+
+        uint8_t firmware_hash[SHA256_DIGEST_LENGTH];
+        sha256_Raw(image.data(), image.size(), firmware_hash);
+        EXPECT_EQ(memcmp(m.firmware_hash, firmware_hash, sizeof(firmware_hash)), 0)
+            << "code_len: " << code_len;
+    }
+}
+
+TEST(Memory, NoFirmwareMeasurementOnEmulator) {
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    EXPECT_EQ(memory_firmware_measurement(), nullptr);
+    EXPECT_EQ(memory_firmware_hash(hash), 0);
+}
@@ -0,0 +1,92 @@
+extern "C" {
+#include "keepkey/board/pubkeys.h"
+#include "keepkey/board/signatures.h"
+#include "trezor/crypto/ecdsa.h"
+#include "trezor/crypto/secp256k1.h"
+#include "trezor/crypto/sha2.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+namespace {
+
+struct Signed {
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    uint8_t pub[SIGNATURES][PUBKEY_LENGTH];
+    uint8_t sig[SIGNATURES][64];
+    const uint8_t *keys[SIGNATURES];
+    const uint8_t *sigs[SIGNATURES];
+
+    Signed() {
+        sha256_Raw((const uint8_t *)"firmware", 8, digest);
+        for (int i = 0; i < SIGNATURES; i++) {
+            uint8_t priv[32];
+            memset(priv, 0x11 * (i + 1), sizeof(priv));
+            ecdsa_get_public_key65(&secp256k1, priv, pub[i]);
+            ecdsa_sign_digest(&secp256k1, priv, digest, sig[i], nullptr, nullptr);
+            keys[i] = pub[i];
+            sigs[i] = sig[i];
+        }
+    }
+};
+
+} // namespace
+
+TEST(Signatures, BatchAcceptsValid) {
+    Signed s;
+    EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES), 0u);
+    EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, 1), 0u);
+}
+
+TEST(Signatures, BatchMatchesVerifyDigest) {
+    for (int bad = 0; bad < SIGNATURES; bad++) {
+        Signed s;
+        s.sig[bad][40] ^= 0x01;
+
+        uint32_t expected = 0;
+        for (int i = 0; i < SIGNATURES; i++) {
+            if (ecdsa_verify_digest(&secp256k1, s.keys[i], s.sigs[i], s.digest) != 0)
+                expected |= 1u << i;
+        }
+
+        EXPECT_EQ(expected, 1u << bad);
+        EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES), expected);
+    }
+}
+
+TEST(Signatures, BatchRejectsOutOfRange) {
+    Signed s;
+    // s == 0 must fail alone, without spoiling the shared inversion.
+    memset(&s.sig[1][32], 0, 32);
+    EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES), 1u << 1);
+
+    // r >= n
+    memset(&s.sig[2][0], 0xff, 32);
+    EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES), 3u << 1);
+}
+
+TEST(Signatures, BatchRejectsWrongKey) {
+    Signed s;
+    s.keys[0] = s.pub[2];
+    EXPECT_EQ(signatures_verify_batch(s.digest, s.keys, s.sigs, SIGNATURES), 1u);
+}
+
+TEST(Signatures, CheckRejectsBadIndexes) {
+    app_meta_td meta;
+    memset(&meta, 0, sizeof(meta));
+    uint8_t fingerprint[32] = {0};
+
+    meta.sig_index1 = 1;
+    meta.sig_index2 = 1;
+    meta.sig_index3 = 2;
+    EXPECT_EQ(signatures_check(&meta, fingerprint), SIG_FAIL);
+
+    meta.sig_index2 = PUBKEYS + 1;
+    EXPECT_EQ(signatures_check(&meta, fingerprint), SIG_FAIL);
+
+    // Real keys, garbage signatures.
+    meta.sig_index2 = 3;
+    EXPECT_EQ(signatures_check(&meta, fingerprint), SIG_FAIL);
+}
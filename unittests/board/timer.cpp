@@ -0,0 +1,118 @@
+extern "C" {
+#include "keepkey/board/timer.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+int fired[MAX_RUNNABLES];
+uint32_t fired_at[MAX_RUNNABLES];
+
+void count(void *context) {
+    int i = (int)(intptr_t)context;
+    fired[i]++;
+    fired_at[i] = timer_ms();
+}
+
+void remove_self(void *context) {
+    count(context);
+    remove_runnable(&remove_self);
+}
+
+void reset() {
+    clear_runnables();
+    memset(fired, 0, sizeof(fired));
+    memset(fired_at, 0, sizeof(fired_at));
+}
+
+void tick(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++)
+        timerisr_usr();
+}
+
+} // namespace
+
+TEST(Board, TimerDelayed) {
+    reset();
+
+    // Delays on each level of the wheel, across cascades, and past its range.
+    const uint32_t delays[] = {0, 1, 63, 64, 65, 4095, 4097, 300000,
+                               (1u << 24) + 5};
+    for (uint32_t delay : delays) {
+        reset();
+        uint32_t start = timer_ms();
+        post_delayed(&count, (void *)0, delay);
+        tick(delay ? delay - 1 : 0);
+        EXPECT_EQ(fired[0], 0) << "delay: " << delay;
+        tick(1);
+        EXPECT_EQ(fired[0], 1) << "delay: " << delay;
+        EXPECT_EQ(fired_at[0] - start, delay ? delay : 1) << "delay: " << delay;
+        tick(100);
+        EXPECT_EQ(fired[0], 1) << "delay: " << delay;
+    }
+}
+
+TEST(Board, TimerPeriodic) {
+    reset();
+
+    uint32_t start = timer_ms();
+    post_periodic(&count, (void *)0, 10, 5);
+    tick(5);
+    EXPECT_EQ(fired[0], 1);
+    tick(100);
+    EXPECT_EQ(fired[0], 11);
+    EXPECT_EQ(fired_at[0] - start, 105u);
+
+    remove_runnable(&count);
+    tick(100);
+    EXPECT_EQ(fired[0], 11);
+}
+
+TEST(Board, TimerRepost) {
+    reset();
+
+    // Posting the same callback again moves it rather than adding another.
+    post_delayed(&count, (void *)0, 10);
+    post_delayed(&count, (void *)1, 200);
+    tick(199);
+    EXPECT_EQ(fired[0], 0);
+    EXPECT_EQ(fired[1], 0);
+    tick(1);
+    EXPECT_EQ(fired[1], 1);
+
+    post_periodic(&remove_self, (void *)2, 1, 1);
+    tick(10);
+    EXPECT_EQ(fired[2], 1);
+}
+
+namespace {
+
+template <int N>
+void count_n(void *context) {
+    count((void *)(intptr_t)N);
+}
+
+} // namespace
+
+TEST(Board, TimerMany) {
+    reset();
+
+    // More runnables than the old queue held, all expiring at once.
+    Runnable callbacks[] = {&count_n<0>, &count_n<1>, &count_n<2>, &count_n<3>,
+                            &count_n<4>, &count_n<5>, &count_n<6>, &count_n<7>};
+    static_assert(sizeof(callbacks) / sizeof(callbacks[0]) == MAX_RUNNABLES,
+                  "one callback per node");
+
+    for (Runnable callback : callbacks)
+        post_delayed(callback, NULL, 1000);
+
+    remove_runnable(&count_n<3>);
+    tick(1000);
+
+    for (int i = 0; i < MAX_RUNNABLES; i++)
+        EXPECT_EQ(fired[i], i == 3 ? 0 : 1) << "runnable: " << i;
+}
@@ -0,0 +1,77 @@
+extern "C" {
+#include "keepkey/firmware/binance.h"
+#include "keepkey/firmware/tendermint.h"
+#include "trezor/crypto/ecdsa.h"
+#include "trezor/crypto/secp256k1.h"
+#include "trezor/crypto/sha2.h"
+
+#include "messages-binance.pb.h"
+}
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <string>
+
+TEST(Binance, BinanceSignTxTransfer)
+{
+    HDNode node = {
+        0,
+        0,
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        { 0x04, 0xde, 0xc0, 0xcc, 0x01, 0x3c, 0xd8, 0xab, 0x70, 0x87, 0xca, 0x14, 0x96, 0x0b, 0x76, 0x8c, 0x3d, 0x83, 0x45, 0x24, 0x48, 0xaa, 0x00, 0x64, 0xda, 0xe6, 0xfb, 0x04, 0xb5, 0xd9, 0x34, 0x76 },
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        &secp256k1_info
+    };
+    hdnode_fill_public_key(&node);
+
+    char address[46];
+    ASSERT_TRUE(tendermint_getAddress(&node, "bnb", address));
+
+    BinanceSignTx msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.has_account_number = true;
+    msg.account_number = 34;
+    msg.has_chain_id = true;
+    strcpy(msg.chain_id, "Binance-Chain-Nile");
+    msg.has_memo = true;
+    strcpy(msg.memo, "a \"memo\" long enough to cross a sha256 block \\ boundary");
+    msg.has_sequence = true;
+    msg.sequence = 31;
+    msg.has_source = true;
+    msg.source = 1;
+    msg.has_msg_count = true;
+    msg.msg_count = 1;
+    ASSERT_TRUE(binance_signTxInit(&node, &msg));
+
+    BinanceTransferMsg transfer;
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.inputs_count = 1;
+    transfer.inputs[0].has_address = true;
+    strcpy(transfer.inputs[0].address, address);
+    transfer.inputs[0].coins_count = 1;
+    transfer.inputs[0].coins[0].has_amount = true;
+    transfer.inputs[0].coins[0].amount = 1000000000;
+    transfer.inputs[0].coins[0].has_denom = true;
+    strcpy(transfer.inputs[0].coins[0].denom, "BNB");
+    transfer.outputs_count = 1;
+    memcpy(&transfer.outputs[0], &transfer.inputs[0], sizeof(transfer.outputs[0]));
+    ASSERT_TRUE(binance_signTxUpdateTransfer(&transfer));
+
+    uint8_t public_key[33];
+    uint8_t signature[64];
+    ASSERT_TRUE(binance_signTxFinalize(public_key, signature));
+
+    const std::string io = "{\"address\":\"" + std::string(address) +
+                           "\",\"coins\":[{\"amount\":1000000000,\"denom\":\"BNB\"}]}";
+    const std::string doc =
+        "{\"account_number\":\"34\",\"chain_id\":\"Binance-Chain-Nile\","
+        "\"data\":null,"
+        "\"memo\":\"a \\\"memo\\\" long enough to cross a sha256 block \\\\ boundary\","
+        "\"msgs\":[{\"inputs\":[" + io + "],\"outputs\":[" + io + "]}],"
+        "\"sequence\":\"31\",\"source\":\"1\"}";
+
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    sha256_Raw((const uint8_t *)doc.data(), doc.size(), digest);
+    EXPECT_EQ(ecdsa_verify_digest(&secp256k1, public_key, signature, digest), 0) << doc;
+}
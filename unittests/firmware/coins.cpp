@@ -4,10 +4,15 @@ extern "C" {
 }
 
 #include "gtest/gtest.h"
+#include "synthetic_tokens.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <sstream>
 #include <string>
 #include <cstring>
+#include <strings.h>
+#include <vector>
 
 static const int MaxLength = 256;
 
@@ -210,3 +215,128 @@ TEST(Coins, TokenByChainAddress) {
     ASSERT_NE(zrx, nullptr);
     EXPECT_EQ(zrx->ticker, std::string(" ZRX"));
 }
+
+TEST(Coins, IndexedLookupsMatchLinearScan) {
+    // Reference implementations: the original first-match linear scans.
+    auto scanName = [](const char *name) -> const CoinType * {
+        for (int i = 0; i < COINS_COUNT; i++)
+            if (strncasecmp(name, coins[i].coin_name, sizeof(coins[i].coin_name)) == 0)
+                return &coins[i];
+        return nullptr;
+    };
+    auto scanShortcut = [](const char *shortcut) -> const CoinType * {
+        for (int i = 0; i < COINS_COUNT; i++)
+            if (strncasecmp(shortcut, coins[i].coin_shortcut, sizeof(coins[i].coin_shortcut)) == 0)
+                return &coins[i];
+        return nullptr;
+    };
+    auto scanAddressType = [](uint32_t address_type) -> const CoinType * {
+        for (int i = 0; i < COINS_COUNT; i++)
+            if (address_type == coins[i].address_type)
+                return &coins[i];
+        return nullptr;
+    };
+    auto scanSlip44 = [](uint32_t bip44_account_path) -> const CoinType * {
+        for (int i = 0; i < COINS_COUNT; i++)
+            if (bip44_account_path == coins[i].bip44_account_path)
+                return &coins[i];
+        return nullptr;
+    };
+
+    for (int i = 0; i < COINS_COUNT; ++i) {
+        const auto &coin = coins[i];
+        EXPECT_EQ(coinByName(coin.coin_name), scanName(coin.coin_name))
+            << coin.coin_name;
+        EXPECT_EQ(coinByShortcut(coin.coin_shortcut), scanShortcut(coin.coin_shortcut))
+            << coin.coin_shortcut;
+        EXPECT_EQ(coinByAddressType(coin.address_type), scanAddressType(coin.address_type))
+            << coin.coin_name;
+        EXPECT_EQ(coinBySlip44(coin.bip44_account_path), scanSlip44(coin.bip44_account_path))
+            << coin.coin_name;
+    }
+
+    EXPECT_EQ(coinByName("bItCoIn"), scanName("Bitcoin"));
+    EXPECT_EQ(coinByShortcut("btc"), scanShortcut("BTC"));
+    EXPECT_EQ(coinByName("NotACoin"), nullptr);
+    EXPECT_EQ(coinByShortcut("ZZZZZZ"), nullptr);
+    EXPECT_EQ(coinByAddressType(0xDEADBEEF), nullptr);
+    EXPECT_EQ(coinBySlip44(0x8FFFFFFF), nullptr);
+    EXPECT_EQ(coinByName(nullptr), nullptr);
+    EXPECT_EQ(coinByShortcut(nullptr), nullptr);
+}
+
+TEST(Coins, TokenIndexMatchesLinearScan) {
+    for (int i = 0; i < TOKENS_COUNT; ++i) {
+        const TokenType *expected = nullptr;
+        for (int j = 0; j < TOKENS_COUNT; ++j) {
+            if (tokens[i].chain_id == tokens[j].chain_id &&
+                memcmp(tokens[i].address, tokens[j].address, 20) == 0) {
+                expected = &tokens[j];
+                break;
+            }
+        }
+        EXPECT_EQ(tokenByChainAddress(tokens[i].chain_id,
+                                      (const uint8_t *)tokens[i].address),
+                  expected)
+            << tokens[i].ticker;
+
+        const TokenType *first = nullptr;
+        int matches = 0;
+        for (int j = 0; j < TOKENS_COUNT; ++j) {
+            if (tokens[i].chain_id == tokens[j].chain_id &&
+                strcmp(tokens[i].ticker + 1, tokens[j].ticker + 1) == 0) {
+                if (!first)
+                    first = &tokens[j];
+                matches++;
+            }
+        }
+
+        // tokenByTicker prefers the legacy table, so only check that the
+        // ticker lookup agrees on uniqueness when the legacy table is silent.
+        const CoinType *legacy = nullptr;
+        for (int j = 0; j < COINS_COUNT; ++j) {
+            if (coins[j].has_contract_address &&
+                strcmp(tokens[i].ticker + 1, coins[j].coin_shortcut) == 0) {
+                legacy = &coins[j];
+                break;
+            }
+        }
+        if (legacy)
+            continue;
+
+        const TokenType *token;
+        EXPECT_EQ(tokenByTicker(tokens[i].chain_id, tokens[i].ticker + 1, &token),
+                  matches == 1)
+            << tokens[i].ticker;
+        EXPECT_EQ(token, first) << tokens[i].ticker;
+    }
+
+    const uint8_t missing[20] = { 0xff, 0xff, 0xff };
+    EXPECT_EQ(tokenByChainAddress(1, missing), UnknownToken);
+    EXPECT_EQ(tokenByChainAddress(1, nullptr), nullptr);
+}
+
+TEST(Coins, TokenSearchSynthetic) {
+    static const int SyntheticCount = 10000;
+    SyntheticTokens tokens(SyntheticCount);
+
+    // The indexed searches must find the same token as a linear scan.
+    for (int n = 0; n < SyntheticCount; ++n) {
+        const TokenType &want = tokens.table[n];
+        const TokenType *linear = tokens.linearByChainAddress(want);
+        ASSERT_EQ(linear, &want) << n;
+
+        EXPECT_EQ(tokenSearchByChainAddress(tokens.table.data(),
+                                            tokens.by_address.data(),
+                                            SyntheticCount, want.chain_id,
+                                            (const uint8_t *)want.address),
+                  linear) << n;
+
+        const TokenType *token = nullptr;
+        EXPECT_EQ(tokenSearchByTicker(tokens.table.data(),
+                                      tokens.by_ticker.data(), SyntheticCount,
+                                      want.chain_id, want.ticker + 1, &token),
+                  1) << n;
+        EXPECT_EQ(token, linear) << n;
+    }
+}
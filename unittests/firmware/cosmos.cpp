@@ -2,11 +2,14 @@ extern "C" {
 #include "keepkey/firmware/coins.h"
 #include "keepkey/firmware/cosmos.h"
 #include "keepkey/firmware/tendermint.h"
+#include "trezor/crypto/ecdsa.h"
 #include "trezor/crypto/secp256k1.h"
+#include "trezor/crypto/sha2.h"
 }
 
 #include "gtest/gtest.h"
 #include <cstring>
+#include <string>
 
 TEST(Cosmos, CosmosGetAddress)
 {
@@ -56,3 +59,56 @@ TEST(Cosmos, CosmosSignTx)
 
     EXPECT_TRUE(memcmp(signature, (uint8_t *)"\x41\x99\x66\x30\x08\xef\xea\x75\x93\x56\x35\xe6\x1a\x11\xdf\xa3\x3c\xeb\xeb\x91\xc1\xca\xed\xc6\x0e\x5e\xef\x3c\xa2\xc0\x1f\x83\x48\x08\x36\xe6\x21\x89\x51\x14\x36\x64\x7f\xac\x5a\xbd\xc2\x9f\x54\xae\x3d\x7e\x47\x56\x43\xca\x33\xc7\xad\x2c\x8a\x53\x2b\x39", 64) == 0);
 }
+
+TEST(Cosmos, CosmosSignTxEscapedMemoTwoMsgs)
+{
+    HDNode node = {
+        0,
+        0,
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        { 0x04, 0xde, 0xc0, 0xcc, 0x01, 0x3c, 0xd8, 0xab, 0x70, 0x87, 0xca, 0x14, 0x96, 0x0b, 0x76, 0x8c, 0x3d, 0x83, 0x45, 0x24, 0x48, 0xaa, 0x00, 0x64, 0xda, 0xe6, 0xfb, 0x04, 0xb5, 0xd9, 0x34, 0x76 },
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        &secp256k1_info
+    };
+    hdnode_fill_public_key(&node);
+
+    char from[46];
+    ASSERT_TRUE(tendermint_getAddress(&node, "cosmos", from));
+    const std::string to = "cosmos18vhdczjut44gpsy804crfhnd5nq003nz0nf20v";
+
+    const CosmosSignTx msg = {
+      5, {0x80000000|44, 0x80000000|118, 0x80000000, 0, 0}, // address_n
+      true, 7,                // account_number
+      true, "cosmoshub-2",    // chain_id
+      true, 5000,             // fee_amount
+      true, 200000,           // gas
+      true, "say \"hi\" \\o/", // memo
+      true, 3,                // sequence
+      true, 2                 // msg_count
+    };
+    ASSERT_TRUE(cosmos_signTxInit(&node, &msg));
+    ASSERT_TRUE(cosmos_signTxUpdateMsgSend(100000, to.c_str()));
+    ASSERT_TRUE(cosmos_signTxUpdateMsgSend(250, to.c_str()));
+
+    uint8_t public_key[33];
+    uint8_t signature[64];
+    ASSERT_TRUE(cosmos_signTxFinalize(public_key, signature));
+
+    auto send = [&](const char *amount) {
+        return "{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{"
+               "\"amount\":[{\"amount\":\"" + std::string(amount) + "\",\"denom\":\"uatom\"}],"
+               "\"from_address\":\"" + std::string(from) + "\","
+               "\"to_address\":\"" + to + "\"}}";
+    };
+    const std::string doc =
+        "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-2\","
+        "\"fee\":{\"amount\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},"
+        "\"memo\":\"say \\\"hi\\\" \\\\o/\","
+        "\"msgs\":[" + send("100000") + "," + send("250") + "],"
+        "\"sequence\":\"3\"}";
+
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    sha256_Raw((const uint8_t *)doc.data(), doc.size(), digest);
+    EXPECT_EQ(ecdsa_verify_digest(&secp256k1, public_key, signature, digest), 0) << doc;
+}
@@ -0,0 +1,90 @@
+extern "C" {
+#include "keepkey/firmware/node_cache.h"
+#include "trezor/crypto/bip32.h"
+#include "trezor/crypto/curves.h"
+}
+
+#include "gtest/gtest.h"
+#include <cstring>
+
+static void rootNode(HDNode *root, const char *curve) {
+    uint8_t seed[64];
+    for (size_t i = 0; i < sizeof(seed); ++i)
+        seed[i] = (uint8_t)i;
+    ASSERT_EQ(hdnode_from_seed(seed, sizeof(seed), curve, root), 1);
+}
+
+static void expectSameAsUncached(const HDNode *root, const uint32_t *address_n,
+                                 size_t count) {
+    HDNode expected;
+    memcpy(&expected, root, sizeof(expected));
+    uint32_t expected_fingerprint = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + 1 == count)
+            expected_fingerprint = hdnode_fingerprint(&expected);
+        ASSERT_EQ(hdnode_private_ckd(&expected, address_n[i]), 1);
+    }
+
+    HDNode actual;
+    memcpy(&actual, root, sizeof(actual));
+    uint32_t fingerprint = 0;
+    ASSERT_EQ(node_cache_derive(&actual, address_n, count, &fingerprint), 1);
+
+    EXPECT_EQ(actual.depth, expected.depth);
+    EXPECT_EQ(actual.child_num, expected.child_num);
+    EXPECT_EQ(memcmp(actual.chain_code, expected.chain_code, 32), 0);
+    EXPECT_EQ(memcmp(actual.private_key, expected.private_key, 32), 0);
+    EXPECT_EQ(fingerprint, expected_fingerprint);
+}
+
+TEST(NodeCache, MatchesUncachedDerivation) {
+    node_cache_clear();
+
+    HDNode root;
+    rootNode(&root, SECP256K1_NAME);
+
+    // Sequential address scan, then the change chain, then another account.
+    for (uint32_t change = 0; change < 2; ++change) {
+        for (uint32_t idx = 0; idx < 5; ++idx) {
+            uint32_t address_n[] = { 0x80000000 | 44, 0x80000000 | 0,
+                                     0x80000000 | 0, change, idx };
+            expectSameAsUncached(&root, address_n, 5);
+        }
+    }
+
+    uint32_t account[] = { 0x80000000 | 44, 0x80000000 | 0, 0x80000000 | 1 };
+    expectSameAsUncached(&root, account, 3);
+
+    uint32_t short_path[] = { 0x80000000 | 44 };
+    expectSameAsUncached(&root, short_path, 1);
+
+    node_cache_clear();
+}
+
+TEST(NodeCache, KeyedOnRootAndCurve) {
+    node_cache_clear();
+
+    uint32_t address_n[] = { 0x80000000 | 44, 0x80000000 | 165,
+                             0x80000000 | 0, 0x80000000 | 0,
+                             0x80000000 | 1 };
+
+    HDNode secp;
+    rootNode(&secp, SECP256K1_NAME);
+    expectSameAsUncached(&secp, address_n, 5);
+
+    // Same path, different curve.
+    HDNode ed;
+    rootNode(&ed, ED25519_NAME);
+    expectSameAsUncached(&ed, address_n, 5);
+
+    // Same path and curve, different root (e.g. a new passphrase).
+    HDNode other;
+    rootNode(&other, SECP256K1_NAME);
+    other.private_key[0] ^= 1;
+    expectSameAsUncached(&other, address_n, 5);
+
+    node_cache_clear();
+    expectSameAsUncached(&secp, address_n, 5);
+
+    node_cache_clear();
+}
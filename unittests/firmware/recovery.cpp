@@ -43,3 +43,33 @@ TEST(Recovery, WordlistLengths) {
         }
     }
 }
+
+TEST(Recovery, AutoCompleteEveryPrefix) {
+    // Compare the bucketed lookup against a plain scan of the wordlist.
+    for (int i = 0; wordlist[i]; i++) {
+        size_t len = strlen(wordlist[i]);
+        for (size_t prefix_len = 1; prefix_len <= len; prefix_len++) {
+            const char *expected = nullptr;
+            int matches = 0;
+            for (int j = 0; wordlist[j]; j++) {
+                if (strncmp(wordlist[j], wordlist[i], prefix_len) != 0)
+                    continue;
+                if (strlen(wordlist[j]) == prefix_len) {
+                    expected = wordlist[j];
+                    matches = 1;
+                    break;
+                }
+                expected = wordlist[j];
+                matches++;
+            }
+
+            char partial_word[12];
+            memset(partial_word, 0, sizeof(partial_word));
+            memcpy(partial_word, wordlist[i], prefix_len);
+            ASSERT_EQ(attempt_auto_complete(partial_word), matches == 1)
+                << wordlist[i] << " / " << prefix_len;
+            if (matches == 1)
+                ASSERT_STREQ(partial_word, expected);
+        }
+    }
+}
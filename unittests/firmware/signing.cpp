@@ -0,0 +1,619 @@
+extern "C" {
+#include "keepkey/firmware/coins.h"
+#include "keepkey/firmware/signing.h"
+#include "keepkey/firmware/transaction.h"
+#include "trezor/crypto/bip32.h"
+#include "trezor/crypto/curves.h"
+#include "trezor/crypto/ecdsa.h"
+#include "trezor/crypto/ripemd160.h"
+#include "trezor/crypto/sha2.h"
+}
+
+#include "gtest/gtest.h"
+#include "host.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+/// Less than the difference between any two outputs of a previous
+/// transaction, so that an input credited with the wrong output's amount
+/// leaves the spend short of funds.
+const uint64_t Fee = 500;
+
+/// How an input is spent: P2PKH, a legacy 2-of-3 P2SH multisig, or P2WPKH.
+enum Kind { P2PKH, P2SHMultisig, P2WPKH };
+
+/// Which output of which previous transaction an input spends, and how.
+struct Spend {
+    size_t prev;
+    uint32_t prev_index;
+    Kind kind;
+};
+
+/// A spend of outputs of one-input previous transactions, paying a single
+/// foreign address. Every key comes from fixed seeds, so signatures are
+/// deterministic.
+class TestTx {
+public:
+    TestTx(const char *coin_name, const std::vector<Spend> &spends);
+
+    size_t inputCount() const { return spends.size(); }
+    size_t outputCount() const { return 1; }
+
+    void input(size_t i, TxInputType *in) const;
+    void output(size_t i, TxOutputType *out) const;
+    void binOutput(size_t i, TxOutputBinType *out) const;
+
+    int prevFor(const TxRequestDetailsType &details) const;
+    void prevMeta(size_t p, TransactionType *tx) const;
+    void prevInput(size_t p, TxInputType *in) const;
+    const TxOutputBinType &prevOutput(size_t p, size_t o) const { return prevs[p].outputs[o]; }
+    const Bytes &prevHash(size_t p) const { return prevs[p].hash; }
+
+    /// The signature of input k. For legacy inputs this is over the sighash
+    /// computed the way inputs were serialized before the phase 1 input
+    /// table: every input in full, only input k carrying its scriptCode.
+    /// Segwit inputs sign their BIP 143 digest.
+    Bytes referenceSignature(size_t k) const;
+
+    const CoinType *coin;
+    const curve_info *curve;
+    HDNode root;
+
+private:
+    struct Prev {
+        std::vector<TxOutputBinType> outputs;
+        Bytes hash;
+    };
+
+    HDNode derive(size_t i) const;
+    void addressN(size_t i, TxInputType *in) const;
+    void multisig(size_t i, MultisigRedeemScriptType *ms) const;
+    Bytes scriptCode(size_t k) const;
+    void legacyDigest(size_t k, uint8_t *digest) const;
+    void bip143Digest(size_t k, uint8_t *digest) const;
+    uint64_t amount(size_t p, size_t o) const { return 100000 + 1000 * o + 10 * p; }
+
+    std::vector<Spend> spends;
+    std::vector<Prev> prevs;
+    HDNode cosigners[2];
+    uint64_t total_in;
+    char destination[64];
+    Bytes destination_script;
+};
+
+TestTx::TestTx(const char *coin_name, const std::vector<Spend> &spends)
+    : coin(coinByName(coin_name)), curve(get_curve_by_name(coin->curve_name)),
+      spends(spends), total_in(0) {
+    uint8_t seed[64];
+    memset(seed, 0x5a, sizeof(seed));
+    hdnode_from_seed(seed, sizeof(seed), coin->curve_name, &root);
+    for (size_t j = 0; j < 2; j++) {
+        memset(seed, 0x11 * (j + 1), sizeof(seed));
+        hdnode_from_seed(seed, sizeof(seed), coin->curve_name, &cosigners[j]);
+    }
+
+    HDNode foreign;
+    memset(seed, 0xa5, sizeof(seed));
+    hdnode_from_seed(seed, sizeof(seed), coin->curve_name, &foreign);
+    hdnode_fill_public_key(&foreign);
+    ecdsa_get_address(foreign.public_key, coin->address_type, curve->hasher_pubkey,
+                      curve->hasher_base58, destination, sizeof(destination));
+    destination_script.resize(32);
+    uint8_t hash[20];
+    ecdsa_get_pubkeyhash(foreign.public_key, curve->hasher_pubkey, hash);
+    destination_script.resize(compile_script_sig(coin->address_type, hash,
+                                                 destination_script.data()));
+
+    size_t prev_count = 0;
+    for (const Spend &spend : spends)
+        prev_count = std::max(prev_count, spend.prev + 1);
+    prevs.resize(prev_count);
+
+    // Each output of a previous transaction pays the input spending it.
+    for (size_t p = 0; p < prevs.size(); p++) {
+        uint32_t outputs = 1;
+        for (const Spend &spend : spends)
+            if (spend.prev == p)
+                outputs = std::max(outputs, spend.prev_index + 1);
+        prevs[p].outputs.resize(outputs);
+        for (uint32_t o = 0; o < outputs; o++) {
+            TxOutputBinType &out = prevs[p].outputs[o];
+            memset(&out, 0, sizeof(out));
+            out.amount = amount(p, o);
+            out.script_pubkey.size = destination_script.size();
+            memcpy(out.script_pubkey.bytes, destination_script.data(),
+                   destination_script.size());
+        }
+    }
+    for (size_t i = 0; i < spends.size(); i++) {
+        HDNode node = derive(i);
+        uint8_t hash[20];
+        TxOutputBinType &out = prevs[spends[i].prev].outputs[spends[i].prev_index];
+        switch (spends[i].kind) {
+        case P2PKH:
+            ecdsa_get_pubkeyhash(node.public_key, curve->hasher_pubkey, hash);
+            out.script_pubkey.size = compile_script_sig(coin->address_type, hash,
+                                                        out.script_pubkey.bytes);
+            break;
+        case P2SHMultisig: {
+            // OP_HASH160 <hash160(redeem script)> OP_EQUAL
+            Bytes redeem = scriptCode(i);
+            uint8_t digest[32];
+            sha256_Raw(redeem.data(), redeem.size(), digest);
+            out.script_pubkey.size = 23;
+            out.script_pubkey.bytes[0] = 0xa9;
+            out.script_pubkey.bytes[1] = 0x14;
+            ripemd160(digest, 32, out.script_pubkey.bytes + 2);
+            out.script_pubkey.bytes[22] = 0x87;
+            break;
+        }
+        case P2WPKH:
+            // OP_0 <hash160(pubkey)>
+            ecdsa_get_pubkeyhash(node.public_key, curve->hasher_pubkey, hash);
+            out.script_pubkey.size = 22;
+            out.script_pubkey.bytes[0] = 0x00;
+            out.script_pubkey.bytes[1] = 0x14;
+            memcpy(out.script_pubkey.bytes + 2, hash, 20);
+            break;
+        }
+        total_in += out.amount;
+    }
+
+    for (size_t p = 0; p < prevs.size(); p++) {
+        TxStruct t;
+        tx_init(&t, 1, prevs[p].outputs.size(), 1, 0, 0, 0, curve->hasher_sign,
+                false, 0);
+        if (coin->decred) {
+            t.version |= (1 << 16); // DECRED_SERIALIZE_NO_WITNESS
+            t.is_decred = true;
+        }
+        TxInputType in;
+        prevInput(p, &in);
+        tx_serialize_input_hash(&t, &in);
+        for (const TxOutputBinType &out : prevs[p].outputs)
+            tx_serialize_output_hash(&t, &out);
+        prevs[p].hash.resize(32);
+        tx_hash_final(&t, prevs[p].hash.data(), true);
+    }
+}
+
+void TestTx::addressN(size_t i, TxInputType *in) const {
+    static const uint32_t purpose[] = { 44, 48, 84 };
+    in->address_n_count = 5;
+    in->address_n[0] = 0x80000000 | purpose[spends[i].kind];
+    in->address_n[1] = coin->bip44_account_path;
+    in->address_n[2] = 0x80000000;
+    in->address_n[3] = 0;
+    in->address_n[4] = i;
+}
+
+HDNode TestTx::derive(size_t i) const {
+    TxInputType in;
+    addressN(i, &in);
+    HDNode node = root;
+    for (size_t n = 0; n < in.address_n_count; n++)
+        hdnode_private_ckd(&node, in.address_n[n]);
+    hdnode_fill_public_key(&node);
+    return node;
+}
+
+void TestTx::multisig(size_t i, MultisigRedeemScriptType *ms) const {
+    TxInputType in;
+    addressN(i, &in);
+
+    memset(ms, 0, sizeof(*ms));
+    ms->has_m = true;
+    ms->m = 2;
+    ms->pubkeys_count = 3;
+    ms->signatures_count = 3;
+    for (size_t j = 0; j < 3; j++) {
+        // The account xpub of each cosigner, and the rest of the path.
+        HDNode account = j == 0 ? root : cosigners[j - 1];
+        for (size_t n = 0; n < 3; n++)
+            hdnode_private_ckd(&account, in.address_n[n]);
+        hdnode_fill_public_key(&account);
+
+        HDNodePathType &path = ms->pubkeys[j];
+        path.node.depth = account.depth;
+        path.node.child_num = account.child_num;
+        path.node.chain_code.size = 32;
+        memcpy(path.node.chain_code.bytes, account.chain_code, 32);
+        path.node.has_public_key = true;
+        path.node.public_key.size = 33;
+        memcpy(path.node.public_key.bytes, account.public_key, 33);
+        path.address_n_count = 2;
+        path.address_n[0] = in.address_n[3];
+        path.address_n[1] = in.address_n[4];
+    }
+}
+
+void TestTx::input(size_t i, TxInputType *in) const {
+    memset(in, 0, sizeof(*in));
+    addressN(i, in);
+    in->prev_hash.size = 32;
+    memcpy(in->prev_hash.bytes, prevs[spends[i].prev].hash.data(), 32);
+    in->prev_index = spends[i].prev_index;
+    in->has_sequence = true;
+    in->sequence = 0xffffffff - i;
+    in->has_script_type = true;
+    switch (spends[i].kind) {
+    case P2PKH:
+        in->script_type = InputScriptType_SPENDADDRESS;
+        break;
+    case P2SHMultisig:
+        in->script_type = InputScriptType_SPENDMULTISIG;
+        in->has_multisig = true;
+        multisig(i, &in->multisig);
+        break;
+    case P2WPKH:
+        in->script_type = InputScriptType_SPENDWITNESS;
+        in->has_amount = true;
+        in->amount = prevs[spends[i].prev].outputs[spends[i].prev_index].amount;
+        break;
+    }
+}
+
+void TestTx::output(size_t i, TxOutputType *out) const {
+    memset(out, 0, sizeof(*out));
+    out->has_address = true;
+    strncpy(out->address, destination, sizeof(out->address) - 1);
+    out->amount = total_in - Fee;
+    out->script_type = OutputScriptType_PAYTOADDRESS;
+}
+
+void TestTx::binOutput(size_t i, TxOutputBinType *out) const {
+    memset(out, 0, sizeof(*out));
+    out->amount = total_in - Fee;
+    out->script_pubkey.size = destination_script.size();
+    memcpy(out->script_pubkey.bytes, destination_script.data(),
+           destination_script.size());
+}
+
+int TestTx::prevFor(const TxRequestDetailsType &details) const {
+    for (size_t p = 0; p < prevs.size(); p++)
+        if (memcmp(details.tx_hash.bytes, prevs[p].hash.data(), 32) == 0)
+            return (int)p;
+    return -1;
+}
+
+void TestTx::prevMeta(size_t p, TransactionType *tx) const {
+    tx->has_version = true;
+    tx->version = 1;
+    tx->has_lock_time = true;
+    tx->lock_time = 0;
+    tx->expiry = 0;
+    tx->has_inputs_cnt = true;
+    tx->inputs_cnt = 1;
+    tx->has_outputs_cnt = true;
+    tx->outputs_cnt = prevs[p].outputs.size();
+}
+
+void TestTx::prevInput(size_t p, TxInputType *in) const {
+    memset(in, 0, sizeof(*in));
+    in->prev_hash.size = 32;
+    memset(in->prev_hash.bytes, 0xc0, 32);
+    in->prev_hash.bytes[0] = p;
+    in->prev_index = 1;
+    in->has_script_sig = !coin->decred;
+    in->script_sig.size = coin->decred ? 0 : 107;
+    memset(in->script_sig.bytes, 0x47, in->script_sig.size);
+    in->has_sequence = true;
+    in->sequence = 0xffffffff;
+}
+
+Bytes TestTx::scriptCode(size_t k) const {
+    Bytes code(520);
+    if (spends[k].kind == P2SHMultisig) {
+        MultisigRedeemScriptType ms;
+        multisig(k, &ms);
+        code.resize(compile_script_multisig(coin, &ms, code.data()));
+    } else {
+        HDNode node = derive(k);
+        uint8_t hash[20];
+        ecdsa_get_pubkeyhash(node.public_key, curve->hasher_pubkey, hash);
+        code.resize(compile_script_sig(coin->address_type, hash, code.data()));
+    }
+    return code;
+}
+
+void TestTx::legacyDigest(size_t k, uint8_t *digest) const {
+    TxStruct t;
+    tx_init(&t, inputCount(), outputCount(), 1, 0, 0, 0, curve->hasher_sign,
+            false, 0);
+    for (size_t i = 0; i < inputCount(); i++) {
+        TxInputType in;
+        input(i, &in);
+        if (i == k) {
+            Bytes code = scriptCode(k);
+            in.script_sig.size = code.size();
+            memcpy(in.script_sig.bytes, code.data(), code.size());
+        }
+        EXPECT_TRUE(tx_serialize_input_hash(&t, &in));
+    }
+    for (size_t o = 0; o < outputCount(); o++) {
+        TxOutputBinType out;
+        binOutput(o, &out);
+        EXPECT_TRUE(tx_serialize_output_hash(&t, &out));
+    }
+    uint32_t hash_type = 1; // SIGHASH_ALL
+    hasher_Update(&t.hasher, (const uint8_t *)&hash_type, 4);
+    tx_hash_final(&t, digest, false);
+}
+
+void TestTx::bip143Digest(size_t k, uint8_t *digest) const {
+    Hasher prevouts, sequences, outputs;
+    hasher_Init(&prevouts, curve->hasher_sign);
+    hasher_Init(&sequences, curve->hasher_sign);
+    hasher_Init(&outputs, curve->hasher_sign);
+    for (size_t i = 0; i < inputCount(); i++) {
+        TxInputType in;
+        input(i, &in);
+        tx_prevout_hash(&prevouts, &in);
+        tx_sequence_hash(&sequences, &in);
+    }
+    for (size_t o = 0; o < outputCount(); o++) {
+        TxOutputBinType out;
+        binOutput(o, &out);
+        tx_output_hash(&outputs, &out, false);
+    }
+    uint8_t hash_prevouts[32], hash_sequence[32], hash_outputs[32];
+    hasher_Final(&prevouts, hash_prevouts);
+    hasher_Final(&sequences, hash_sequence);
+    hasher_Final(&outputs, hash_outputs);
+
+    TxInputType in;
+    input(k, &in);
+    Bytes code = scriptCode(k);
+    uint32_t version = 1, lock_time = 0, hash_type = 1;
+
+    Hasher preimage;
+    hasher_Init(&preimage, curve->hasher_sign);
+    hasher_Update(&preimage, (const uint8_t *)&version, 4);
+    hasher_Update(&preimage, hash_prevouts, 32);
+    hasher_Update(&preimage, hash_sequence, 32);
+    tx_prevout_hash(&preimage, &in);
+    tx_script_hash(&preimage, code.size(), code.data());
+    hasher_Update(&preimage, (const uint8_t *)&in.amount, 8);
+    tx_sequence_hash(&preimage, &in);
+    hasher_Update(&preimage, hash_outputs, 32);
+    hasher_Update(&preimage, (const uint8_t *)&lock_time, 4);
+    hasher_Update(&preimage, (const uint8_t *)&hash_type, 4);
+    hasher_Final(&preimage, digest);
+}
+
+Bytes TestTx::referenceSignature(size_t k) const {
+    uint8_t digest[32];
+    if (spends[k].kind == P2WPKH)
+        bip143Digest(k, digest);
+    else
+        legacyDigest(k, digest);
+
+    HDNode node = derive(k);
+    uint8_t sig[64];
+    EXPECT_EQ(ecdsa_sign_digest(curve->params, node.private_key, digest, sig,
+                                nullptr, nullptr), 0);
+    Bytes der(72);
+    der.resize(ecdsa_sig_to_der(sig, der.data()));
+    return der;
+}
+
+/// What the host saw while signing.
+struct Session {
+    std::map<uint32_t, Bytes> signatures;
+    Bytes serialized;
+    std::map<Bytes, int> prev_metas;
+    std::string error;
+};
+
+typedef std::function<bool(const TxRequest &)> StopFn;
+
+/// Answers TxRequests for tx until signing finishes, fails, or stop returns
+/// true for the next request.
+bool runHost(const TestTx &tx, Session &session, StopFn stop = nullptr) {
+    static TransactionType ack;
+
+    for (;;) {
+        if (host::last_msg_id == MessageType_MessageType_Failure) {
+            session.error = host::failure.message;
+            return false;
+        }
+
+        const TxRequest &req = host::tx_request;
+        if (req.has_serialized) {
+            if (req.serialized.has_signature_index && req.serialized.has_signature)
+                session.signatures[req.serialized.signature_index] =
+                    Bytes(req.serialized.signature.bytes,
+                          req.serialized.signature.bytes + req.serialized.signature.size);
+            if (req.serialized.has_serialized_tx)
+                session.serialized.insert(
+                    session.serialized.end(), req.serialized.serialized_tx.bytes,
+                    req.serialized.serialized_tx.bytes + req.serialized.serialized_tx.size);
+        }
+
+        if (req.request_type == RequestType_TXFINISHED)
+            return true;
+        if (stop && stop(req))
+            return true;
+
+        memset(&ack, 0, sizeof(ack));
+        int prev = -1;
+        if (req.details.has_tx_hash) {
+            prev = tx.prevFor(req.details);
+            if (prev < 0) {
+                session.error = "unknown previous transaction requested";
+                return false;
+            }
+        }
+
+        size_t idx = req.details.request_index;
+        switch (req.request_type) {
+        case RequestType_TXMETA:
+            session.prev_metas[tx.prevHash(prev)]++;
+            tx.prevMeta(prev, &ack);
+            break;
+        case RequestType_TXINPUT:
+            ack.inputs_count = 1;
+            if (prev >= 0)
+                tx.prevInput(prev, &ack.inputs[0]);
+            else
+                tx.input(idx, &ack.inputs[0]);
+            break;
+        case RequestType_TXOUTPUT:
+            if (prev >= 0) {
+                ack.bin_outputs_count = 1;
+                ack.bin_outputs[0] = tx.prevOutput(prev, idx);
+            } else {
+                ack.outputs_count = 1;
+                tx.output(idx, &ack.outputs[0]);
+            }
+            break;
+        default:
+            session.error = "unexpected request type";
+            return false;
+        }
+
+        uint64_t sent = host::msgs_sent;
+        signing_txack(&ack);
+        if (host::msgs_sent == sent) {
+            session.error = "no reply to TxAck";
+            return false;
+        }
+    }
+}
+
+void start(const TestTx &tx) {
+    SignTx msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.inputs_count = tx.inputCount();
+    msg.outputs_count = tx.outputCount();
+    msg.has_version = true;
+    msg.version = 1;
+    msg.has_lock_time = true;
+    msg.lock_time = 0;
+
+    host::reset();
+    signing_init(&msg, tx.coin, &tx.root);
+}
+
+bool sign(const TestTx &tx, Session &session, StopFn stop = nullptr) {
+    start(tx);
+    return runHost(tx, session, stop);
+}
+
+/// Stops once phase 1 asks for the outputs being spent to.
+bool outputsRequested(const TxRequest &req) {
+    return req.request_type == RequestType_TXOUTPUT && !req.details.has_tx_hash;
+}
+
+/// Signs tx and checks every input's signature against the reference, and
+/// that it made it into the serialized transaction.
+void expectReferenceSignatures(const TestTx &tx) {
+    Session session;
+    ASSERT_TRUE(sign(tx, session)) << session.error;
+
+    ASSERT_EQ(session.signatures.size(), tx.inputCount());
+    for (size_t i = 0; i < tx.inputCount(); i++) {
+        Bytes expected = tx.referenceSignature(i);
+        EXPECT_EQ(session.signatures[i], expected) << i;
+        EXPECT_NE(std::search(session.serialized.begin(), session.serialized.end(),
+                              expected.begin(), expected.end()),
+                  session.serialized.end()) << i;
+    }
+}
+
+} // namespace
+
+TEST(Signing, PrevTxCacheSignsLikeStreaming) {
+    // The first two inputs spend the same previous transaction, the second
+    // one an output with a larger amount, so that crediting it with the
+    // first output's amount would fail the fee check.
+    TestTx tx("Bitcoin", { { 0, 0, P2PKH }, { 0, 1, P2PKH }, { 1, 0, P2PKH } });
+
+    Session session;
+    ASSERT_TRUE(sign(tx, session)) << session.error;
+    signing_abort();
+
+    // The shared previous transaction was streamed once.
+    EXPECT_EQ(session.prev_metas[tx.prevHash(0)], 1);
+    EXPECT_EQ(session.prev_metas[tx.prevHash(1)], 1);
+
+    // Signatures are deterministic, so the cached path must produce exactly
+    // the signatures of the fully streamed sighashes.
+    ASSERT_EQ(session.signatures.size(), tx.inputCount());
+    for (size_t i = 0; i < tx.inputCount(); i++)
+        EXPECT_EQ(session.signatures[i], tx.referenceSignature(i)) << i;
+}
+
+TEST(Signing, PrevTxCacheWipedBySigningInit) {
+    TestTx tx("Bitcoin", { { 0, 0, P2PKH }, { 0, 1, P2PKH } });
+
+    // Stop part way through phase 1, with the previous transaction cached.
+    Session first;
+    ASSERT_TRUE(sign(tx, first, outputsRequested)) << first.error;
+    EXPECT_TRUE(signing_prevtx_cached(tx.prevHash(0).data()));
+
+    // Starting over without an abort must not trust it.
+    start(tx);
+    EXPECT_FALSE(signing_prevtx_cached(tx.prevHash(0).data()));
+
+    Session second;
+    ASSERT_TRUE(runHost(tx, second)) << second.error;
+    EXPECT_EQ(second.prev_metas[tx.prevHash(0)], 1);
+    signing_abort();
+}
+
+TEST(Signing, PrevTxCacheWipedBySigningAbort) {
+    TestTx tx("Bitcoin", { { 0, 0, P2PKH }, { 0, 1, P2PKH } });
+
+    Session session;
+    ASSERT_TRUE(sign(tx, session, outputsRequested)) << session.error;
+    EXPECT_TRUE(signing_prevtx_cached(tx.prevHash(0).data()));
+
+    signing_abort();
+    EXPECT_FALSE(signing_prevtx_cached(tx.prevHash(0).data()));
+
+    // A finished signing session ends with an abort as well.
+    Session finished;
+    ASSERT_TRUE(sign(tx, finished)) << finished.error;
+    EXPECT_FALSE(signing_prevtx_cached(tx.prevHash(0).data()));
+}
+
+TEST(Signing, PrevTxCacheNotUsedForDecred) {
+    TestTx tx("Decred", { { 0, 0, P2PKH }, { 0, 1, P2PKH } });
+
+    // Every Decred input streams its previous transaction, even when an
+    // earlier input already did.
+    Session session;
+    ASSERT_TRUE(sign(tx, session, outputsRequested)) << session.error;
+    EXPECT_EQ(session.prev_metas[tx.prevHash(0)], 2);
+    signing_abort();
+}
+
+TEST(Signing, InputTableSpendAddress) {
+    expectReferenceSignatures(TestTx("Bitcoin", {
+        { 0, 0, P2PKH }, { 1, 0, P2PKH }, { 2, 0, P2PKH } }));
+}
+
+TEST(Signing, InputTableSpendAddressWithSegwit) {
+    expectReferenceSignatures(TestTx("Bitcoin", {
+        { 0, 0, P2PKH }, { 1, 0, P2WPKH }, { 2, 0, P2PKH } }));
+}
+
+TEST(Signing, InputTableSpendMultisig) {
+    expectReferenceSignatures(TestTx("Bitcoin", {
+        { 0, 0, P2SHMultisig }, { 1, 0, P2SHMultisig }, { 2, 0, P2SHMultisig } }));
+}
+
+TEST(Signing, InputTableSpendMultisigWithSegwit) {
+    expectReferenceSignatures(TestTx("Bitcoin", {
+        { 0, 0, P2SHMultisig }, { 1, 0, P2WPKH }, { 2, 0, P2SHMultisig } }));
+}
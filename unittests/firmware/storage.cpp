@@ -2,7 +2,12 @@ extern "C" {
 #include "keepkey/firmware/storage.h"
 #include "keepkey/firmware/policy.h"
 #include "keepkey/board/keepkey_board.h"
+#include "keepkey/board/keepkey_flash.h"
+#include "keepkey/board/memory.h"
+#include "trezor/crypto/bip39.h"
+#include "trezor/crypto/curves.h"
 #include "trezor/crypto/memzero.h"
+#include "trezor/crypto/pbkdf2.h"
 #include "trezor/crypto/aes/aes.h"
 #include "types.pb.h"
 #include "storage.h"
@@ -11,8 +16,10 @@ extern "C" {
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <algorithm>
 #include <cstring>
 #include <string>
+#include <vector>
 
 using ::testing::ElementsAreArray;
 
@@ -620,6 +627,24 @@ TEST(Storage, IsPinCorrect) {
     EXPECT_TRUE(memcmp(key_out, storage_key, 64) == 0);
 }
 
+TEST(Storage, DeriveWrappingKey) {
+    uint8_t random_salt[RANDOM_SALT_LEN];
+    memset(random_salt, 0x5a, sizeof(random_salt));
+
+    uint8_t salt[HW_ENTROPY_LEN + RANDOM_SALT_LEN];
+    flash_readHWEntropy(salt, HW_ENTROPY_LEN);
+    memcpy(salt + HW_ENTROPY_LEN, random_salt, RANDOM_SALT_LEN);
+
+    // The two interleaved chains are blocks 1 and 2 of a 64 byte PBKDF2.
+    uint8_t expected[64];
+    pbkdf2_hmac_sha256((const uint8_t *)"1234", 4, salt, sizeof(salt),
+                       PIN_ITER_COUNT, expected, sizeof(expected));
+
+    uint8_t wrapping_key[64];
+    storage_deriveWrappingKey("1234", wrapping_key, true, random_salt, "");
+    EXPECT_EQ(memcmp(wrapping_key, expected, sizeof(expected)), 0);
+}
+
 TEST(Storage, Vuln1996) {
     ConfigFlash config;
     SessionState session;
@@ -716,3 +741,87 @@ TEST(Storage, Reset) {
 
     ASSERT_TRUE(memcmp(session.storageKey, new_storage_key, 64) == 0);
 }
+
+TEST(Storage, MnemonicToSeed) {
+    const char *mnemonic =
+        "abandon abandon abandon abandon abandon abandon "
+        "abandon abandon abandon abandon abandon about";
+
+    for (const char *passphrase : { "", "TREZOR" }) {
+        uint8_t expected[64];
+        mnemonic_to_seed(mnemonic, passphrase, expected, nullptr);
+
+        uint8_t seed[64];
+        storage_mnemonicToSeed(mnemonic, passphrase, seed, "");
+        EXPECT_TRUE(memcmp(seed, expected, sizeof(seed)) == 0) << passphrase;
+    }
+
+    // Round counts that are not a multiple of the chunk size.
+    uint8_t expected[64], key[64];
+    pbkdf2_hmac_sha512((const uint8_t *)"pass", 4, (const uint8_t *)"TREZORHD", 8,
+                       SEED_PROGRESS_CHUNK + 3, expected, sizeof(expected));
+    storage_pbkdf2_sha512((const uint8_t *)"pass", 4, (const uint8_t *)"TREZORHD", 8,
+                          SEED_PROGRESS_CHUNK + 3, key, "");
+    EXPECT_TRUE(memcmp(key, expected, sizeof(key)) == 0);
+}
+
+TEST(Storage, RootNodeCache) {
+    ConfigFlash config;
+    SessionState session;
+    memset(&session, 0, sizeof(session));
+    storage_reset_impl(&session, &config);
+
+    uint8_t seed[64];
+    memset(seed, 0x2a, sizeof(seed));
+
+    HDNode secp, ed;
+    ASSERT_EQ(hdnode_from_seed(seed, sizeof(seed), SECP256K1_NAME, &secp), 1);
+    ASSERT_EQ(hdnode_from_seed(seed, sizeof(seed), ED25519_NAME, &ed), 1);
+
+    session_cacheRootNode(&session, SECP256K1_NAME, false, &secp);
+    session_cacheRootNode(&session, ED25519_NAME, false, &ed);
+
+    HDNode node;
+    ASSERT_TRUE(session_getCachedRootNode(&session, SECP256K1_NAME, false, &node));
+    EXPECT_TRUE(memcmp(node.private_key, secp.private_key, 32) == 0);
+    ASSERT_TRUE(session_getCachedRootNode(&session, ED25519_NAME, false, &node));
+    EXPECT_TRUE(memcmp(node.private_key, ed.private_key, 32) == 0);
+
+    // Nodes derived without the passphrase don't stand in for ones with it.
+    EXPECT_FALSE(session_getCachedRootNode(&session, SECP256K1_NAME, true, &node));
+    EXPECT_FALSE(session_getCachedRootNode(&session, NIST256P1_NAME, false, &node));
+
+    session_clear_impl(&session, &config.storage, true);
+    EXPECT_FALSE(session_getCachedRootNode(&session, SECP256K1_NAME, false, &node));
+    EXPECT_FALSE(session_getCachedRootNode(&session, ED25519_NAME, false, &node));
+}
+
+TEST(Storage, CommitSkipsUnchanged) {
+    // Run storage against blank flash of our own.
+    std::vector<uint8_t> flash(FLASH_TOTAL_SIZE, 0xff);
+    uint8_t *saved_flash_base = emulator_flash_base;
+    emulator_flash_base = flash.data();
+
+    storage_init();
+    storage_setLabel("unchanged");
+    storage_commit();
+
+    const std::vector<uint8_t> before = flash;
+    const uint32_t written = storage_getCommitsWritten();
+    const uint32_t skipped = storage_getCommitsSkipped();
+
+    // Nothing changed, so flash is left alone.
+    storage_commit();
+    EXPECT_EQ(storage_getCommitsWritten(), written);
+    EXPECT_EQ(storage_getCommitsSkipped(), skipped + 1);
+    EXPECT_TRUE(flash == before);
+
+    // A changed field still goes out to flash.
+    storage_setLabel("changed");
+    storage_commit();
+    EXPECT_EQ(storage_getCommitsWritten(), written + 1);
+    EXPECT_EQ(storage_getCommitsSkipped(), skipped + 1);
+    EXPECT_FALSE(flash == before);
+
+    emulator_flash_base = saved_flash_base;
+}
@@ -0,0 +1,81 @@
+#ifndef KEEPKEY_UNITTESTS_SYNTHETIC_TOKENS_H
+#define KEEPKEY_UNITTESTS_SYNTHETIC_TOKENS_H
+
+extern "C" {
+#include "keepkey/firmware/ethereum_tokens.h"
+}
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// A token table of pseudo-random addresses and tickers, together with
+/// the chain/address and chain/ticker index orders that the generated
+/// tables carry. Large enough that a linear scan shows its cost.
+///
+/// Shared by the Coins unittests and the token lookup benchmarks.
+struct SyntheticTokens {
+    explicit SyntheticTokens(int count) {
+        addresses.reserve(count);
+        tickers.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            std::string address(20, '\0');
+            uint32_t x = (uint32_t)i * 2654435761u;
+            for (int b = 0; b < 20; ++b) {
+                x = x * 1103515245u + 12345u;
+                address[b] = (char)(x >> 24);
+            }
+            addresses.push_back(address);
+
+            char ticker[16];
+            snprintf(ticker, sizeof(ticker), " T%05d", i);
+            tickers.push_back(ticker);
+        }
+
+        table.reserve(count);
+        for (int i = 0; i < count; ++i)
+            table.push_back(TokenType{ addresses[i].data(), tickers[i].c_str(),
+                                       (uint8_t)(1 + i % 4), 18 });
+
+        by_address.resize(count);
+        by_ticker.resize(count);
+        for (int i = 0; i < count; ++i)
+            by_address[i] = by_ticker[i] = (uint16_t)i;
+        std::stable_sort(by_address.begin(), by_address.end(),
+                         [&](uint16_t a, uint16_t b) {
+            if (table[a].chain_id != table[b].chain_id)
+                return table[a].chain_id < table[b].chain_id;
+            return memcmp(table[a].address, table[b].address, 20) < 0;
+        });
+        std::stable_sort(by_ticker.begin(), by_ticker.end(),
+                         [&](uint16_t a, uint16_t b) {
+            if (table[a].chain_id != table[b].chain_id)
+                return table[a].chain_id < table[b].chain_id;
+            return strcmp(table[a].ticker + 1, table[b].ticker + 1) < 0;
+        });
+    }
+
+    /// The entry looked up on iteration n, spread across the table.
+    const TokenType &pick(uint64_t n) const {
+        return table[(n * 7919) % table.size()];
+    }
+
+    /// The scan tokenByChainAddress did before the table was indexed.
+    const TokenType *linearByChainAddress(const TokenType &want) const {
+        for (const TokenType &token : table) {
+            if (want.chain_id == token.chain_id &&
+                memcmp(want.address, token.address, 20) == 0)
+                return &token;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> addresses, tickers;
+    std::vector<TokenType> table;
+    std::vector<uint16_t> by_address, by_ticker;
+};
+
+#endif
@@ -0,0 +1,79 @@
+extern "C" {
+#include "keepkey/firmware/tendermint.h"
+#include "trezor/crypto/sha2.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+std::string escape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void expectHash(TendermintJson *json, const std::string &doc) {
+    uint8_t expected[SHA256_DIGEST_LENGTH];
+    sha256_Raw((const uint8_t *)doc.data(), doc.size(), expected);
+
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    tendermint_jsonFinal(json, hash);
+    EXPECT_TRUE(memcmp(hash, expected, sizeof(hash)) == 0) << doc;
+}
+
+} // namespace
+
+TEST(Tendermint, JsonEmpty) {
+    TendermintJson json;
+    tendermint_jsonInit(&json);
+    expectHash(&json, "");
+}
+
+TEST(Tendermint, JsonBlockBoundaries) {
+    // Lengths on both sides of the 64 byte block, and several blocks.
+    for (size_t len : { 1, 63, 64, 65, 127, 128, 129, 300 }) {
+        std::string s;
+        for (size_t i = 0; i < len; i++)
+            s += (char)('a' + i % 26);
+
+        TendermintJson json;
+        tendermint_jsonInit(&json);
+        tendermint_jsonRaw(&json, s.data(), 7 < len ? 7 : len);
+        if (len > 7)
+            tendermint_jsonRaw(&json, s.data() + 7, len - 7);
+        expectHash(&json, s);
+    }
+}
+
+TEST(Tendermint, JsonEscaped) {
+    // Escapes that straddle a block boundary must not be split or doubled.
+    std::string memo(62, 'm');
+    memo += "\"quoted\\path\"";
+    memo += std::string(70, '"');
+
+    TendermintJson json;
+    tendermint_jsonInit(&json);
+    tendermint_jsonRaw(&json, "{\"memo\":\"", 9);
+    tendermint_jsonEscaped(&json, memo.data(), memo.size());
+    tendermint_jsonRaw(&json, "\"}", 2);
+    expectHash(&json, "{\"memo\":\"" + escape(memo) + "\"}");
+}
+
+TEST(Tendermint, JsonPrintf) {
+    TendermintJson json;
+    tendermint_jsonInit(&json);
+    ASSERT_TRUE(tendermint_jsonPrintf(&json, "{\"sequence\":\"%d\"}", 42));
+    expectHash(&json, "{\"sequence\":\"42\"}");
+
+    // Output longer than 64 characters is rejected.
+    tendermint_jsonInit(&json);
+    EXPECT_FALSE(tendermint_jsonPrintf(&json, "%s", std::string(65, 'x').c_str()));
+}
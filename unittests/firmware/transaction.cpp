@@ -0,0 +1,60 @@
+extern "C" {
+#include "keepkey/firmware/coins.h"
+#include "keepkey/firmware/transaction.h"
+#include "trezor/crypto/curves.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+TEST(Transaction, WeightP2PKH) {
+    const CoinType *coin = coinByName("Bitcoin");
+    const curve_info *curve = get_curve_by_name(coin->curve_name);
+
+    // 1 input, 2 outputs: the textbook 226 byte transaction.
+    uint32_t weight = tx_base_weight(coin, 1, 2)
+        + tx_input_weight_for(coin, InputScriptType_SPENDADDRESS, 0, 0)
+        + tx_output_weight_for(coin, curve, OutputScriptType_PAYTOADDRESS, false, false, 0,
+                               "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2")
+        + tx_output_weight_for(coin, curve, OutputScriptType_PAYTOADDRESS, true, false, 0, "");
+    EXPECT_EQ(weight, 4u * 226);
+}
+
+TEST(Transaction, WeightP2WPKH) {
+    const CoinType *coin = coinByName("Bitcoin");
+    const curve_info *curve = get_curve_by_name(coin->curve_name);
+
+    uint32_t weight = tx_base_weight(coin, 1, 1)
+        + tx_segwit_overhead_weight(1)
+        + tx_input_weight_for(coin, InputScriptType_SPENDWITNESS, 0, 0)
+        + tx_output_weight_for(coin, curve, OutputScriptType_PAYTOWITNESS, true, false, 0, "");
+    EXPECT_EQ(weight, 438u);
+}
+
+TEST(Transaction, WeightMatchesInputs) {
+    const CoinType *coin = coinByName("Bitcoin");
+
+    static TxInputType in;
+    memset(&in, 0, sizeof(in));
+    in.script_type = InputScriptType_SPENDMULTISIG;
+    in.has_multisig = true;
+    in.multisig.m = 2;
+    in.multisig.pubkeys_count = 3;
+    EXPECT_EQ(tx_input_weight(coin, &in),
+              tx_input_weight_for(coin, InputScriptType_SPENDMULTISIG, 2, 3));
+    EXPECT_EQ(tx_decred_witness_weight(&in), tx_decred_witness_weight_for(2, 3));
+
+    in.script_type = InputScriptType_SPENDP2SHWITNESS;
+    in.has_multisig = false;
+    EXPECT_EQ(tx_input_weight(coin, &in),
+              tx_input_weight_for(coin, InputScriptType_SPENDP2SHWITNESS, 0, 0));
+}
+
+TEST(Transaction, FeeThreshold) {
+    const CoinType *coin = coinByName("Bitcoin");
+    uint64_t max_fee = tx_fee_threshold(coin, 4 * 226);
+    EXPECT_EQ(max_fee, (uint64_t)226 * coin->maxfee_kb / 1000);
+    EXPECT_FALSE(tx_fee_over_threshold(coin, max_fee, 4 * 226));
+    EXPECT_TRUE(tx_fee_over_threshold(coin, max_fee + 1, 4 * 226));
+}
@@ -1,12 +1,33 @@
 extern "C" {
 #include "u2f.h"
 #include "u2f_knownapps.h"
+#include "keepkey/firmware/u2f.h"
+#include "keepkey/firmware/u2f/u2f.h"
+#include "trezor/crypto/curves.h"
+#include "trezor/crypto/hmac.h"
 }
 
 #include "gtest/gtest.h"
 
+#include <cstring>
 #include <string>
 
+namespace {
+
+HDNode u2fRoot() {
+    uint8_t seed[64];
+    memset(seed, 0x55, sizeof(seed));
+
+    HDNode root;
+    hdnode_from_seed(seed, sizeof(seed), NIST256P1_NAME, &root);
+    hdnode_private_ckd(&root, U2F_KEY_PATH);
+    return root;
+}
+
+const uint8_t AppId[32] = "https://keepkey.example/u2f....";
+
+} // namespace
+
 TEST(U2F, WordsFromData) {
     const uint8_t buff1[32] = "123456789012345678901";
     ASSERT_EQ(std::string(words_from_data(buff1, 6)), "couple muscle snack heavy");
@@ -26,3 +47,239 @@ TEST(U2F, ShapeShift) {
     ASSERT_EQ(U2F_SHAPESHIFT_COM_DEV->appname, std::string("ShapeShift (dev)"));
     ASSERT_EQ(U2F_SHAPESHIFT_IO_DEV->appname,  std::string("ShapeShift (dev)"));
 }
+
+TEST(U2F, LegacyKeyHandleValidates) {
+    const HDNode root = u2fRoot();
+
+    // Built the way handles were issued before versioning: eight random
+    // hardened indices, then an HMAC keyed by the derived private key.
+    uint32_t path[KEY_PATH_ENTRIES];
+    HDNode expected = root;
+    for (size_t i = 0; i < KEY_PATH_ENTRIES; i++) {
+        path[i] = 0x80000000 | (0x01020304u * (i + 1));
+        ASSERT_EQ(hdnode_private_ckd(&expected, path[i]), 1);
+    }
+
+    uint8_t key_handle[KEY_HANDLE_LEN];
+    memcpy(key_handle, path, KEY_PATH_LEN);
+    uint8_t keybase[U2F_APPID_SIZE + KEY_PATH_LEN];
+    memcpy(keybase, AppId, U2F_APPID_SIZE);
+    memcpy(keybase + U2F_APPID_SIZE, key_handle, KEY_PATH_LEN);
+    hmac_sha256(expected.private_key, 32, keybase, sizeof(keybase),
+                key_handle + KEY_PATH_LEN);
+
+    HDNode node;
+    ASSERT_TRUE(u2f_validateKeyHandle_impl(&root, AppId, key_handle, &node));
+    EXPECT_TRUE(memcmp(node.private_key, expected.private_key, 32) == 0);
+}
+
+TEST(U2F, KeyHandleRoundTrip) {
+    const HDNode root = u2fRoot();
+
+    for (uint32_t version : { KEY_HANDLE_LEGACY, KEY_HANDLE_V1 }) {
+        uint8_t key_handle[KEY_HANDLE_LEN];
+        HDNode generated, validated;
+        ASSERT_TRUE(u2f_generateKeyHandle_impl(&root, version, AppId,
+                                               key_handle, &generated));
+        ASSERT_TRUE(u2f_validateKeyHandle_impl(&root, AppId, key_handle,
+                                               &validated)) << version;
+        EXPECT_TRUE(memcmp(generated.private_key, validated.private_key, 32) == 0);
+
+        // Another app can't use the handle.
+        uint8_t other_app[32];
+        memcpy(other_app, AppId, sizeof(other_app));
+        other_app[0] ^= 1;
+        EXPECT_FALSE(u2f_validateKeyHandle_impl(&root, other_app, key_handle,
+                                                &validated));
+
+        // Nor can a handle with a modified path or padding.
+        for (size_t i : { 0, 5, 20, 31 }) {
+            key_handle[i] ^= 0x10;
+            EXPECT_FALSE(u2f_validateKeyHandle_impl(&root, AppId, key_handle,
+                                                    &validated)) << i;
+            key_handle[i] ^= 0x10;
+        }
+    }
+}
+
+TEST(U2F, KeyHandleV1IsShort) {
+    const HDNode root = u2fRoot();
+
+    uint8_t key_handle[KEY_HANDLE_LEN];
+    HDNode node;
+    ASSERT_TRUE(u2f_generateKeyHandle_impl(&root, KEY_HANDLE_V1, AppId,
+                                           key_handle, &node));
+    EXPECT_EQ(node.depth, root.depth + KEY_PATH_V1_ENTRIES);
+
+    uint32_t version;
+    memcpy(&version, key_handle, sizeof(version));
+    EXPECT_EQ(version, (uint32_t)KEY_HANDLE_V1);
+
+    // Unknown versions are rejected.
+    HDNode unused;
+    EXPECT_FALSE(u2f_generateKeyHandle_impl(&root, 2, AppId, key_handle, &unused));
+    version = 2;
+    memcpy(key_handle, &version, sizeof(version));
+    EXPECT_FALSE(u2f_validateKeyHandle_impl(&root, AppId, key_handle, &unused));
+}
+
+namespace {
+
+U2FHID_FRAME initFrame(uint32_t cid, uint8_t cmd, uint16_t len, uint8_t fill) {
+    U2FHID_FRAME f;
+    memset(&f, 0, sizeof(f));
+    f.cid = cid;
+    f.init.cmd = cmd;
+    f.init.bcnth = len >> 8;
+    f.init.bcntl = len & 0xff;
+    memset(f.init.data, fill, sizeof(f.init.data));
+    return f;
+}
+
+U2FHID_FRAME contFrame(uint32_t cid, uint8_t seq, uint8_t fill) {
+    U2FHID_FRAME f;
+    memset(&f, 0, sizeof(f));
+    f.cid = cid;
+    f.cont.seq = seq;
+    memset(f.cont.data, fill, sizeof(f.cont.data));
+    return f;
+}
+
+} // namespace
+
+TEST(U2F, ChannelsInterleaved) {
+    u2f_channels_reset();
+
+    // Two 100 byte pings, their frames interleaved.
+    U2FHID_FRAME a0 = initFrame(0x1111, U2FHID_PING, 100, 'a');
+    U2FHID_FRAME b0 = initFrame(0x2222, U2FHID_PING, 100, 'b');
+    U2FHID_FRAME b1 = contFrame(0x2222, 0, 'B');
+    U2FHID_FRAME a1 = contFrame(0x1111, 0, 'A');
+
+    EXPECT_EQ(u2f_channels_frame(&a0), ERR_NONE);
+    EXPECT_EQ(u2f_channels_frame(&b0), ERR_NONE);
+    EXPECT_EQ(u2f_channels_next(), nullptr);
+    EXPECT_TRUE(u2f_channels_pending());
+
+    EXPECT_EQ(u2f_channels_frame(&b1), ERR_NONE);
+    EXPECT_EQ(u2f_channels_frame(&a1), ERR_NONE);
+    EXPECT_FALSE(u2f_channels_pending());
+
+    // Handed out in the order they completed.
+    U2F_Channel *ch = u2f_channels_next();
+    ASSERT_NE(ch, nullptr);
+    EXPECT_EQ(ch->cid, 0x2222u);
+    EXPECT_EQ(ch->cmd, U2FHID_PING);
+    ASSERT_EQ(ch->len, 100u);
+    EXPECT_EQ(std::string((char *)ch->buf, 100),
+              std::string(57, 'b') + std::string(43, 'B'));
+    u2f_channels_release(ch);
+
+    ch = u2f_channels_next();
+    ASSERT_NE(ch, nullptr);
+    EXPECT_EQ(ch->cid, 0x1111u);
+    EXPECT_EQ(std::string((char *)ch->buf, 100),
+              std::string(57, 'a') + std::string(43, 'A'));
+    u2f_channels_release(ch);
+
+    EXPECT_EQ(u2f_channels_next(), nullptr);
+}
+
+TEST(U2F, ChannelsErrors) {
+    u2f_channels_reset();
+
+    U2FHID_FRAME broadcast = initFrame(CID_BROADCAST, U2FHID_MSG, 10, 0);
+    EXPECT_EQ(u2f_channels_frame(&broadcast), ERR_INVALID_CID);
+
+    U2FHID_FRAME huge = initFrame(0x1111, U2FHID_MSG, U2F_CHANNEL_BUFFER_LEN + 1, 0);
+    EXPECT_EQ(u2f_channels_frame(&huge), ERR_INVALID_LEN);
+
+    U2FHID_FRAME stray = contFrame(0x3333, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&stray), ERR_CHANNEL_BUSY);
+
+    // A sequence error drops the message.
+    U2FHID_FRAME init = initFrame(0x1111, U2FHID_MSG, 200, 0);
+    U2FHID_FRAME skipped = contFrame(0x1111, 1, 0);
+    EXPECT_EQ(u2f_channels_frame(&init), ERR_NONE);
+    EXPECT_EQ(u2f_channels_frame(&skipped), ERR_INVALID_SEQ);
+    EXPECT_FALSE(u2f_channels_pending());
+
+    // As does an INIT on the channel.
+    EXPECT_EQ(u2f_channels_frame(&init), ERR_NONE);
+    u2f_channels_abort(0x1111);
+    EXPECT_FALSE(u2f_channels_pending());
+}
+
+TEST(U2F, ChannelsEvictLeastRecentlyUsed) {
+    u2f_channels_reset();
+
+    for (uint32_t i = 1; i <= U2F_CHANNEL_COUNT; i++) {
+        U2FHID_FRAME f = initFrame(i, U2FHID_MSG, 200, 0);
+        EXPECT_EQ(u2f_channels_frame(&f), ERR_NONE);
+    }
+
+    // Channel 1 makes progress, so channel 2 is now the quietest.
+    U2FHID_FRAME c1 = contFrame(1, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&c1), ERR_NONE);
+
+    U2FHID_FRAME late = initFrame(100, U2FHID_MSG, 200, 0);
+    EXPECT_EQ(u2f_channels_frame(&late), ERR_NONE);
+
+    U2FHID_FRAME c2 = contFrame(2, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&c2), ERR_CHANNEL_BUSY);
+    U2FHID_FRAME c3 = contFrame(3, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&c3), ERR_NONE);
+}
+
+TEST(U2F, ChannelsKeepCompleteMessages) {
+    u2f_channels_reset();
+
+    // Channel 1 completes first, so it is the least recently used.
+    U2FHID_FRAME done = initFrame(1, U2FHID_WINK, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&done), ERR_NONE);
+    for (uint32_t i = 2; i <= U2F_CHANNEL_COUNT; i++) {
+        U2FHID_FRAME f = initFrame(i, U2FHID_MSG, 200, 0);
+        EXPECT_EQ(u2f_channels_frame(&f), ERR_NONE);
+    }
+
+    // A new channel evicts the oldest partial message instead.
+    U2FHID_FRAME late = initFrame(100, U2FHID_MSG, 200, 0);
+    EXPECT_EQ(u2f_channels_frame(&late), ERR_NONE);
+    U2FHID_FRAME c2 = contFrame(2, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&c2), ERR_CHANNEL_BUSY);
+
+    U2F_Channel *ch = u2f_channels_next();
+    ASSERT_NE(ch, nullptr);
+    EXPECT_EQ(ch->cid, 1u);
+    ch->busy = true;
+
+    // With every slot busy or complete, there is nothing to evict.
+    for (uint32_t i = 3; i <= U2F_CHANNEL_COUNT; i++) {
+        U2FHID_FRAME f = initFrame(i, U2FHID_WINK, 0, 0);
+        EXPECT_EQ(u2f_channels_frame(&f), ERR_NONE);
+    }
+    U2FHID_FRAME f = initFrame(100, U2FHID_WINK, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&f), ERR_NONE);
+    U2FHID_FRAME full = initFrame(200, U2FHID_WINK, 0, 0);
+    EXPECT_EQ(u2f_channels_frame(&full), ERR_CHANNEL_BUSY);
+}
+
+TEST(U2F, ChannelsTimeout) {
+    u2f_channels_reset();
+
+    U2FHID_FRAME done = initFrame(0x1111, U2FHID_WINK, 0, 0);
+    U2FHID_FRAME partial = initFrame(0x2222, U2FHID_MSG, 200, 0);
+    EXPECT_EQ(u2f_channels_frame(&done), ERR_NONE);
+    EXPECT_EQ(u2f_channels_frame(&partial), ERR_NONE);
+
+    uint32_t expired = 0;
+    for (uint64_t i = 0; !expired && i < 10000000; i++)
+        expired = u2f_channels_tick();
+
+    // Only the partial message times out; the complete one stays queued.
+    EXPECT_EQ(expired, 0x2222u);
+    EXPECT_FALSE(u2f_channels_pending());
+    U2F_Channel *ch = u2f_channels_next();
+    ASSERT_NE(ch, nullptr);
+    EXPECT_EQ(ch->cid, 0x1111u);
+}
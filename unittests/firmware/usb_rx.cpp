@@ -6,6 +6,11 @@ extern "C" {
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
 extern "C" {
 void usb_rx_helper(const void *buf, size_t length, MessageMapType type);
 void set_msg_failure_handler(msg_failure_t failure_func);
@@ -29,34 +34,56 @@ TEST(USBRX, Overflow) {
 
     char msg[64];
     TrezorFrame *frame = (TrezorFrame *)msg;
-    TrezorFrameFragment *frame_fragment = (TrezorFrameFragment *)msg;
 
     frame->usb_header.hid_type = '?';
     frame->header.pre1 = '#';
     frame->header.pre2 = '#';
     frame->header.id = __builtin_bswap16(MessageType_MessageType_Initialize);
     frame->header.len = __builtin_bswap32(0xffffffff);
+
+    // Messages are decoded as they stream in rather than reassembled, so one
+    // that claims to be larger than a frame is rejected up front:
     usb_rx_helper(&msg, sizeof(msg), NORMAL_MSG);
+    ASSERT_EQ(failure_count, 1);
+    ASSERT_EQ(message, "Malformed message");
 
+    // And check that the state got cleared out afterward:
     frame->header.pre1 = '0';
     frame->header.pre2 = '0';
+    usb_rx_helper(&msg, sizeof(msg), NORMAL_MSG);
+    ASSERT_EQ(failure_count, 2);
+    ASSERT_EQ(message, "Malformed packet");
+}
 
-    // Send packets up until the point just before where the buffer internal to
-    // usb_rx_helper would overflow. All of these should succeeed.
-    for (unsigned i = 0; i < 1039; i++) {
-        usb_rx_helper(&msg, sizeof(msg), NORMAL_MSG);
-        ASSERT_EQ(failure_count, 0);
-    }
+TEST(USBRX, ParseFailure) {
+    fsm_init();
+    setup();
+
+    char msg[64];
+    memset(msg, 0, sizeof(msg));
+    TrezorFrame *frame = (TrezorFrame *)msg;
+
+    frame->usb_header.hid_type = '?';
+    frame->header.pre1 = '#';
+    frame->header.pre2 = '#';
+    frame->header.id = __builtin_bswap16(MessageType_MessageType_Initialize);
+    frame->header.len = __builtin_bswap32(3);
+
+    // A field header with a reserved wire type.
+    msg[9] = 0x0f;
+    msg[10] = 0x01;
+    msg[11] = 0x02;
 
-    // Then on the last one, check that we detect the overflow before it happens:
     usb_rx_helper(&msg, sizeof(msg), NORMAL_MSG);
     ASSERT_EQ(failure_count, 1);
-    ASSERT_EQ(message, "Malformed message");
+    ASSERT_EQ(message, "Could not parse protocol buffer message");
 
-    // And check that the state got cleared out afterward:
+    // The rest of the message was consumed, so the next report is taken as
+    // the start of a new one:
+    frame->header.id = 0xffff;
     usb_rx_helper(&msg, sizeof(msg), NORMAL_MSG);
     ASSERT_EQ(failure_count, 2);
-    ASSERT_EQ(message, "Malformed packet");
+    ASSERT_EQ(message, "Unknown message");
 }
 
 TEST(USBRX, ErrorHandling) {
@@ -94,3 +121,194 @@ TEST(USBRX, ErrorHandling) {
     ASSERT_EQ(failure_count, 4);
     ASSERT_EQ(message, "Unknown message");
 }
+
+namespace {
+
+typedef std::vector<uint8_t> Report;
+
+/// Splits a message into the 64-byte reports a host would send.
+std::vector<Report> reportsFor(uint16_t msg_id, const std::vector<uint8_t> &payload) {
+    std::vector<uint8_t> msg = {
+        '#', '#', (uint8_t)(msg_id >> 8), (uint8_t)msg_id,
+        (uint8_t)(payload.size() >> 24), (uint8_t)(payload.size() >> 16),
+        (uint8_t)(payload.size() >> 8), (uint8_t)payload.size() };
+    msg.insert(msg.end(), payload.begin(), payload.end());
+
+    std::vector<Report> reports;
+    for (size_t i = 0; i < msg.size(); i += 63) {
+        Report report(64, 0);
+        report[0] = '?';
+        std::copy(msg.begin() + i, msg.begin() + std::min(msg.size(), i + 63),
+                  report.begin() + 1);
+        reports.push_back(report);
+    }
+    return reports;
+}
+
+/// A Ping whose message field is text.
+std::vector<uint8_t> pingPayload(const std::string &text) {
+    std::vector<uint8_t> payload = { 0x0a };
+    for (size_t n = text.size(); ; n >>= 7) {
+        payload.push_back((uint8_t)(n & 0x7f) | (n >= 0x80 ? 0x80 : 0));
+        if (n < 0x80)
+            break;
+    }
+    payload.insert(payload.end(), text.begin(), text.end());
+    return payload;
+}
+
+/// Reports the host sends while a message is streamed in, one per poll.
+std::deque<std::pair<MessageMapType, Report> > pending;
+uint32_t now;
+int polls;
+int pings;
+std::string ping_message;
+
+void streamPoll() {
+    polls++;
+    now += 100;
+    if (pending.empty())
+        return;
+    std::pair<MessageMapType, Report> next = pending.front();
+    pending.pop_front();
+#if DEBUG_LINK
+    if (next.first == DEBUG_MSG) {
+        handle_debug_usb_rx(next.second.data(), next.second.size());
+        return;
+    }
+#endif
+    handle_usb_rx(next.second.data(), next.second.size());
+}
+
+uint32_t streamClock() {
+    return now;
+}
+
+void onPing(Ping *msg) {
+    pings++;
+    ping_message = msg->has_message ? msg->message : "";
+}
+
+/// Routes Ping to onPing, and the rest of the reports through streamPoll().
+struct StreamFixture {
+    std::vector<MessagesMap_t> map;
+
+    StreamFixture() : map(MessageType_MessageType_Ping + 1) {
+        map[MessageType_MessageType_Ping] = MessagesMap_t{
+            Ping_fields, (msg_handler_t)onPing, PARSABLE, NORMAL_MSG, IN_MSG,
+            MessageType_MessageType_Ping };
+        // Nothing else is mapped.
+        map[0].msg_id = (MessageType)0xffff;
+        msg_map_init(map.data(), map.size());
+        setup();
+        set_msg_stream_poll_handler(streamPoll, streamClock);
+
+        pending.clear();
+        now = 0;
+        polls = 0;
+        pings = 0;
+        ping_message.clear();
+    }
+
+    ~StreamFixture() {
+        set_msg_stream_poll_handler(nullptr, nullptr);
+        fsm_init();
+    }
+
+    void send(const std::vector<Report> &reports) {
+        for (size_t i = 1; i < reports.size(); ++i)
+            pending.push_back(std::make_pair(NORMAL_MSG, reports[i]));
+        usb_rx_helper(reports[0].data(), reports[0].size(), NORMAL_MSG);
+    }
+};
+
+} // namespace
+
+TEST(USBRX, StreamAcrossReports) {
+    StreamFixture fixture;
+
+    const std::string text(180, 'k');
+    std::vector<Report> reports =
+        reportsFor(MessageType_MessageType_Ping, pingPayload(text));
+    ASSERT_EQ(reports.size(), 4u);
+
+    fixture.send(reports);
+    EXPECT_EQ(failure_count, 0);
+    EXPECT_EQ(pings, 1);
+    EXPECT_EQ(ping_message, text);
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(polls, 3);
+}
+
+TEST(USBRX, StreamTimesOut) {
+    StreamFixture fixture;
+
+    std::vector<Report> reports = reportsFor(MessageType_MessageType_Ping,
+                                             pingPayload(std::string(180, 'k')));
+    reports.pop_back();
+
+    // The host stops after three of the four reports. The stream waits out
+    // MSG_STREAM_TIMEOUT_MS rather than polling forever.
+    fixture.send(reports);
+    EXPECT_EQ(pings, 0);
+    ASSERT_EQ(failure_count, 1);
+    EXPECT_EQ(message, "Timed out waiting for message");
+    EXPECT_TRUE(pending.empty());
+    EXPECT_GE(now, 5000u);
+    EXPECT_LE(now, 5000u + 3 * 100u + 100u);
+
+    // The next message starts afresh.
+    fixture.send(reportsFor(MessageType_MessageType_Ping, pingPayload("hi")));
+    EXPECT_EQ(failure_count, 1);
+    EXPECT_EQ(pings, 1);
+    EXPECT_EQ(ping_message, "hi");
+}
+
+TEST(USBRX, StreamSkipsRestOfMalformedMessage) {
+    StreamFixture fixture;
+
+    // A field header with a reserved wire type, followed by two more
+    // reports of padding.
+    std::vector<uint8_t> payload(150, 0);
+    payload[0] = 0x0f;
+    std::vector<Report> reports =
+        reportsFor(MessageType_MessageType_Ping, payload);
+    ASSERT_EQ(reports.size(), 3u);
+
+    fixture.send(reports);
+    ASSERT_EQ(failure_count, 1);
+    EXPECT_EQ(message, "Could not parse protocol buffer message");
+    EXPECT_EQ(pings, 0);
+
+    // The remaining reports were read and dropped, not left to be taken as
+    // the start of the next message.
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(polls, 2);
+}
+
+#if DEBUG_LINK
+TEST(USBRX, StreamRejectsInterleavedDebugReport) {
+    StreamFixture fixture;
+
+    const std::string text(180, 'k');
+    std::vector<Report> reports =
+        reportsFor(MessageType_MessageType_Ping, pingPayload(text));
+
+    // A debug link report arrives between the second and third reports.
+    for (size_t i = 1; i < reports.size(); ++i) {
+        pending.push_back(std::make_pair(NORMAL_MSG, reports[i]));
+        if (i == 1)
+            pending.push_back(std::make_pair(
+                DEBUG_MSG,
+                reportsFor(MessageType_MessageType_DebugLinkGetState, {})[0]));
+    }
+    usb_rx_helper(reports[0].data(), reports[0].size(), NORMAL_MSG);
+
+    // It is refused, and the message it interrupted still decodes.
+    ASSERT_EQ(failure_count, 1);
+    EXPECT_EQ(message, "Another message is being received");
+    EXPECT_EQ(pings, 1);
+    EXPECT_EQ(ping_message, text);
+    EXPECT_TRUE(pending.empty());
+}
+#endif
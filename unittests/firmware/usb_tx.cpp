@@ -0,0 +1,166 @@
+extern "C" {
+#include "keepkey/board/messages.h"
+#include "keepkey/board/usb.h"
+#include "keepkey/firmware/fsm.h"
+#include "keepkey/transport/trezor_transport.h"
+#include "pb_encode.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::vector<std::vector<uint8_t> > Reports;
+
+static Reports sent;
+
+static void capture(int iface, const uint8_t *report, size_t len) {
+    ASSERT_EQ(iface, 0);
+    sent.push_back(std::vector<uint8_t>(report, report + len));
+}
+
+/// The encoder msg_write used before it wrote straight into reports: encode
+/// the whole frame into a zeroed buffer, then send it in 63 byte slices.
+static Reports old_msg_write(MessageType msg_id, const void *msg) {
+    const pb_field_t *fields = message_fields(NORMAL_MSG, msg_id, OUT_MSG);
+
+    std::unique_ptr<TrezorFrameBuffer> framebuf(new TrezorFrameBuffer);
+    memset(framebuf.get(), 0, sizeof(*framebuf));
+    framebuf->frame.usb_header.hid_type = '?';
+    framebuf->frame.header.pre1 = '#';
+    framebuf->frame.header.pre2 = '#';
+    framebuf->frame.header.id = __builtin_bswap16(msg_id);
+
+    pb_ostream_t os = pb_ostream_from_buffer(framebuf->buffer, sizeof(framebuf->buffer));
+    EXPECT_TRUE(pb_encode(&os, fields, msg));
+
+    framebuf->frame.header.len = __builtin_bswap32(os.bytes_written);
+
+    Reports reports;
+    for (uint32_t pos = 1; pos < sizeof(framebuf->frame) + os.bytes_written; pos += 64 - 1) {
+        std::vector<uint8_t> report(64, 0);
+        report[0] = '?';
+        memcpy(&report[1], ((const uint8_t *)framebuf.get()) + pos, 64 - 1);
+        reports.push_back(report);
+    }
+
+    return reports;
+}
+
+static void check_success(const std::string &text, size_t expected_reports) {
+    Success msg;
+    memset(&msg, 0, sizeof(msg));
+    if (!text.empty()) {
+        msg.has_message = true;
+        strncpy(msg.message, text.c_str(), sizeof(msg.message) - 1);
+    }
+
+    sent.clear();
+    ASSERT_TRUE(msg_write_impl(&capture, 0, NORMAL_MSG,
+                               MessageType_MessageType_Success, &msg));
+    EXPECT_EQ(sent.size(), expected_reports) << text.size();
+    EXPECT_EQ(sent, old_msg_write(MessageType_MessageType_Success, &msg))
+        << text.size();
+}
+
+TEST(USBTX, Empty) {
+    fsm_init();
+
+    // Just the frame header, padded out to one report.
+    check_success("", 1);
+}
+
+TEST(USBTX, ExactlyOneReport) {
+    fsm_init();
+
+    // 9 bytes of header, then a 2 byte field header and 53 bytes of text
+    // fill the first report exactly.
+    check_success(std::string(53, 'a'), 1);
+
+    // One more byte spills into a second report.
+    check_success(std::string(54, 'a'), 2);
+}
+
+TEST(USBTX, MultipleReports) {
+    fsm_init();
+
+    for (size_t len = 55; len < 256; len += 7) {
+        // Field tag, varint length, then the text.
+        size_t payload = 1 + (len > 127 ? 2 : 1) + len;
+
+        // 8 bytes of frame header and the payload, 63 bytes per report.
+        check_success(std::string(len, 'a' + len % 26), (8 + payload + 62) / 63);
+    }
+}
+
+TEST(USBTX, UnknownMessage) {
+    fsm_init();
+
+    Success msg;
+    memset(&msg, 0, sizeof(msg));
+
+    sent.clear();
+    EXPECT_FALSE(msg_write_impl(&capture, 0, NORMAL_MSG, (MessageType)0xffff, &msg));
+    EXPECT_TRUE(sent.empty());
+}
+
+static Features *mutated;
+
+/// Lengthens the label once the first report has gone out, so that the
+/// encoder runs past the size the frame header announced.
+static void capture_and_mutate(int iface, const uint8_t *report, size_t len) {
+    capture(iface, report, len);
+    if (mutated) {
+        memset(mutated->label, 'x', sizeof(mutated->label) - 1);
+        mutated = nullptr;
+    }
+}
+
+TEST(USBTX, EncodeFailureMidStream) {
+    fsm_init();
+
+    Features features;
+    memset(&features, 0, sizeof(features));
+    features.has_vendor = true;
+    memset(features.vendor, 'v', sizeof(features.vendor) - 1);
+    features.has_device_id = true;
+    memset(features.device_id, 'd', sizeof(features.device_id) - 1);
+    features.has_label = true;
+    features.label[0] = 'a';
+
+    // The vendor and device id alone spill past the first report, which is
+    // sent before the label is encoded.
+    ASSERT_GT(2 + strlen(features.vendor) + 2 + strlen(features.device_id),
+              64u - 9u);
+
+    size_t len;
+    ASSERT_TRUE(pb_get_encoded_size(&len, Features_fields, &features));
+
+    sent.clear();
+    mutated = &features;
+    EXPECT_FALSE(msg_write_impl(&capture_and_mutate, 0, NORMAL_MSG,
+                                MessageType_MessageType_Features, &features));
+    EXPECT_EQ(mutated, nullptr);
+
+    // The Features frame is padded out to the length its header announced,
+    // so the host reads exactly that many reports before the next frame.
+    size_t frame_reports = (8 + len + 62) / 63;
+    ASSERT_EQ(sent.size(), frame_reports + 1);
+    EXPECT_EQ(sent[0][3], MessageType_MessageType_Features >> 8);
+    EXPECT_EQ(sent[0][4], MessageType_MessageType_Features & 0xff);
+    EXPECT_EQ(sent[0][8], len);
+
+    // Then a Failure follows on the same interface.
+    Failure failure;
+    memset(&failure, 0, sizeof(failure));
+    failure.has_code = true;
+    failure.code = FailureType_Failure_FirmwareError;
+    failure.has_message = true;
+    strcpy(failure.message, "Could not encode message");
+    Reports expected = old_msg_write(MessageType_MessageType_Failure, &failure);
+    ASSERT_EQ(expected.size(), 1u);
+    EXPECT_EQ(sent.back(), expected[0]);
+}